@@ -0,0 +1,354 @@
+/****************************************************************************************
+**
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of nemo-keepalive package.
+**
+** You may use this file under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+****************************************************************************************/
+
+/* D-Bus traffic counter for keepalive benchmarks
+ *
+ * Becomes a bus monitor and accumulates message counts and sizes.
+ * Phase marker signals sent by workload drivers split statistics in
+ * setup and steady state parts, steady state figures are also
+ * scaled to per simulated hour values.
+ */
+
+#include "dbus-traffic.h"
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <glib.h>
+#include <glib-unix.h>
+#include <dbus/dbus.h>
+#include "../dbus-gmain/dbus-gmain.h"
+
+#define failure(FMT, ARGS...) do {\
+    fprintf(stderr, "%s: "FMT"\n", __FUNCTION__, ## ARGS);\
+    exit(EXIT_FAILURE);\
+} while(0)
+
+/* ========================================================================= *
+ * Types
+ * ========================================================================= */
+
+typedef struct
+{
+    /** Number of messages, all types */
+    guint64 tc_messages;
+
+    /** Number of marshaled bytes, all types */
+    guint64 tc_bytes;
+
+    /** Number of method calls */
+    guint64 tc_calls;
+
+    /** Number of method calls that expect a reply */
+    guint64 tc_round_trips;
+
+    /** Number of method returns */
+    guint64 tc_returns;
+
+    /** Number of error replies */
+    guint64 tc_errors;
+
+    /** Number of signals */
+    guint64 tc_signals;
+} traffic_count_t;
+
+/* ========================================================================= *
+ * Prototypes
+ * ========================================================================= */
+
+static void              traffic_count_add    (traffic_count_t *self, DBusMessage *msg);
+static void              traffic_count_print  (const traffic_count_t *self, FILE *out, double scale);
+static bool              traffic_is_marker    (DBusMessage *msg, const char **phase);
+static DBusHandlerResult traffic_filter_cb    (DBusConnection *con, DBusMessage *msg, void *aptr);
+static void              traffic_become_monitor(DBusConnection *con);
+static void              traffic_report       (void);
+static gboolean          traffic_quit_cb      (gpointer aptr);
+
+int main(int argc, char **argv);
+
+/* ========================================================================= *
+ * State
+ * ========================================================================= */
+
+static traffic_count_t  traffic_setup;
+static traffic_count_t  traffic_steady;
+static traffic_count_t *traffic_current = &traffic_setup;
+
+/** Unique name of this connection, messages to/from it are ignored */
+static gchar *traffic_own_name = 0;
+
+/** Label to include in the report */
+static gchar *traffic_label = 0;
+
+/** Simulated duration of steady state phase [s] */
+static gdouble traffic_simulated_seconds = 0;
+
+/** Output file, or NULL for stdout */
+static gchar *traffic_output = 0;
+
+static GMainLoop *traffic_mainloop = 0;
+
+/* ========================================================================= *
+ * COUNTING
+ * ========================================================================= */
+
+static void
+traffic_count_add(traffic_count_t *self, DBusMessage *msg)
+{
+    char *data = 0;
+    int   size = 0;
+
+    if( dbus_message_marshal(msg, &data, &size) ) {
+        self->tc_bytes += size;
+        dbus_free(data);
+    }
+
+    self->tc_messages += 1;
+
+    switch( dbus_message_get_type(msg) ) {
+    case DBUS_MESSAGE_TYPE_METHOD_CALL:
+        self->tc_calls += 1;
+        if( !dbus_message_get_no_reply(msg) )
+            self->tc_round_trips += 1;
+        break;
+    case DBUS_MESSAGE_TYPE_METHOD_RETURN:
+        self->tc_returns += 1;
+        break;
+    case DBUS_MESSAGE_TYPE_ERROR:
+        self->tc_errors += 1;
+        break;
+    case DBUS_MESSAGE_TYPE_SIGNAL:
+        self->tc_signals += 1;
+        break;
+    default:
+        break;
+    }
+}
+
+static void
+traffic_count_print(const traffic_count_t *self, FILE *out, double scale)
+{
+    fprintf(out,
+            "{\"messages\":%.1f,\"bytes\":%.1f,\"calls\":%.1f,"
+            "\"round_trips\":%.1f,\"returns\":%.1f,\"errors\":%.1f,"
+            "\"signals\":%.1f}",
+            self->tc_messages * scale, self->tc_bytes * scale,
+            self->tc_calls * scale, self->tc_round_trips * scale,
+            self->tc_returns * scale, self->tc_errors * scale,
+            self->tc_signals * scale);
+}
+
+/* ========================================================================= *
+ * MONITORING
+ * ========================================================================= */
+
+static bool
+traffic_is_marker(DBusMessage *msg, const char **phase)
+{
+    if( !dbus_message_is_signal(msg, TRAFFIC_MARKER_IF, TRAFFIC_MARKER_SIG) )
+        return false;
+
+    if( !dbus_message_get_args(msg, 0,
+                               DBUS_TYPE_STRING, phase,
+                               DBUS_TYPE_INVALID) )
+        *phase = "";
+
+    return true;
+}
+
+static DBusHandlerResult
+traffic_filter_cb(DBusConnection *con, DBusMessage *msg, void *aptr)
+{
+    (void)con, (void)aptr;
+
+    const char *phase = 0;
+
+    /* Skip traffic related to monitoring itself */
+    if( !g_strcmp0(dbus_message_get_sender(msg), traffic_own_name) ||
+        !g_strcmp0(dbus_message_get_destination(msg), traffic_own_name) )
+        goto cleanup;
+
+    if( dbus_message_is_signal(msg, DBUS_INTERFACE_LOCAL, "Disconnected") ) {
+        g_main_loop_quit(traffic_mainloop);
+        goto cleanup;
+    }
+
+    if( traffic_is_marker(msg, &phase) ) {
+        if( !strcmp(phase, TRAFFIC_PHASE_STEADY) )
+            traffic_current = &traffic_steady;
+        else if( !strcmp(phase, TRAFFIC_PHASE_DONE) )
+            g_main_loop_quit(traffic_mainloop);
+        goto cleanup;
+    }
+
+    traffic_count_add(traffic_current, msg);
+
+cleanup:
+    return DBUS_HANDLER_RESULT_HANDLED;
+}
+
+static void
+traffic_become_monitor(DBusConnection *con)
+{
+    DBusError     err   = DBUS_ERROR_INIT;
+    DBusMessage  *req   = 0;
+    DBusMessage  *rsp   = 0;
+    const char  **rules = 0;
+    dbus_uint32_t flags = 0;
+
+    req = dbus_message_new_method_call(DBUS_SERVICE_DBUS, DBUS_PATH_DBUS,
+                                       DBUS_INTERFACE_MONITORING,
+                                       "BecomeMonitor");
+    if( !req )
+        failure("could not create BecomeMonitor request");
+
+    dbus_message_append_args(req,
+                             DBUS_TYPE_ARRAY, DBUS_TYPE_STRING, &rules, 0,
+                             DBUS_TYPE_UINT32, &flags,
+                             DBUS_TYPE_INVALID);
+
+    if( !(rsp = dbus_connection_send_with_reply_and_block(con, req, -1, &err)) )
+        failure("BecomeMonitor: %s: %s", err.name, err.message);
+
+    dbus_message_unref(rsp);
+    dbus_message_unref(req);
+    dbus_error_free(&err);
+}
+
+/* ========================================================================= *
+ * REPORTING
+ * ========================================================================= */
+
+static void
+traffic_report(void)
+{
+    FILE *out = stdout;
+
+    if( traffic_output && !(out = fopen(traffic_output, "a")) )
+        failure("%s: %m", traffic_output);
+
+    double hours = traffic_simulated_seconds / 3600.0;
+
+    fprintf(out, "{\"label\":\"%s\",\"simulated_seconds\":%.0f,\"setup\":",
+            traffic_label ?: "", traffic_simulated_seconds);
+    traffic_count_print(&traffic_setup, out, 1.0);
+    fprintf(out, ",\"steady\":");
+    traffic_count_print(&traffic_steady, out, 1.0);
+    if( hours > 0 ) {
+        fprintf(out, ",\"per_hour\":");
+        traffic_count_print(&traffic_steady, out, 1.0 / hours);
+    }
+    fprintf(out, "}\n");
+
+    if( out != stdout )
+        fclose(out);
+    else
+        fflush(out);
+}
+
+/* ========================================================================= *
+ * MAIN
+ * ========================================================================= */
+
+static gboolean
+traffic_quit_cb(gpointer aptr)
+{
+    (void)aptr;
+    g_main_loop_quit(traffic_mainloop);
+    return G_SOURCE_CONTINUE;
+}
+
+int
+main(int argc, char **argv)
+{
+    DBusError       err  = DBUS_ERROR_INIT;
+    DBusConnection *con  = 0;
+    GError         *gerr = 0;
+
+    GOptionEntry entries[] = {
+        { "label", 'l', 0, G_OPTION_ARG_STRING, &traffic_label,
+          "Label to include in the report", "TEXT" },
+        { "simulated-seconds", 's', 0, G_OPTION_ARG_DOUBLE,
+          &traffic_simulated_seconds,
+          "Simulated length of steady state phase", "SECONDS" },
+        { "output", 'o', 0, G_OPTION_ARG_STRING, &traffic_output,
+          "Append report to file instead of stdout", "FILE" },
+        { NULL }
+    };
+
+    GOptionContext *ctx = g_option_context_new("- count D-Bus traffic");
+    g_option_context_add_main_entries(ctx, entries, 0);
+    if( !g_option_context_parse(ctx, &argc, &argv, &gerr) )
+        failure("option parsing failed: %s", gerr->message);
+    g_option_context_free(ctx);
+
+    /* Use private connection, the bus must not be used for anything
+     * else after it has been turned into a monitor */
+    const char *address = getenv("DBUS_SYSTEM_BUS_ADDRESS");
+    if( !address )
+        failure("DBUS_SYSTEM_BUS_ADDRESS is not set");
+
+    if( !(con = dbus_connection_open_private(address, &err)) )
+        failure("%s: %s", err.name, err.message);
+
+    if( !dbus_bus_register(con, &err) )
+        failure("%s: %s", err.name, err.message);
+
+    traffic_own_name = g_strdup(dbus_bus_get_unique_name(con));
+
+    traffic_become_monitor(con);
+
+    dbus_connection_set_exit_on_disconnect(con, FALSE);
+    dbus_gmain_set_up_connection(con, 0);
+    if( !dbus_connection_add_filter(con, traffic_filter_cb, 0, 0) )
+        failure("could not add message filter");
+
+    /* Tell the runner script that monitoring is active */
+    printf("ready\n");
+    fflush(stdout);
+
+    traffic_mainloop = g_main_loop_new(0, FALSE);
+    g_unix_signal_add(SIGINT,  traffic_quit_cb, 0);
+    g_unix_signal_add(SIGTERM, traffic_quit_cb, 0);
+
+    g_main_loop_run(traffic_mainloop);
+
+    traffic_report();
+
+    g_main_loop_unref(traffic_mainloop), traffic_mainloop = 0;
+    dbus_connection_remove_filter(con, traffic_filter_cb, 0);
+    dbus_connection_close(con);
+    dbus_connection_unref(con);
+    dbus_error_free(&err);
+
+    g_free(traffic_own_name);
+    g_free(traffic_label);
+    g_free(traffic_output);
+
+    return EXIT_SUCCESS;
+}
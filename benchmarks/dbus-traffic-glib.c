@@ -0,0 +1,245 @@
+/****************************************************************************************
+**
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of nemo-keepalive package.
+**
+** You may use this file under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+****************************************************************************************/
+
+/* D-Bus traffic workload driver for libkeepalive-glib
+ *
+ * Creates N background activities in the same wakeup slot and
+ * simulates M wakeups. On each wakeup every activity stays in
+ * running state for the linger time before going back to waiting.
+ *
+ * IPHB wakeups are generated via iphb-stub.c, so one round equals
+ * one wakeup slot of simulated time. Linger time is scaled down
+ * by TRAFFIC_TIME_SCALE to match the shortened keepalive period
+ * reported by the mock MCE.
+ */
+
+#include "dbus-traffic.h"
+#include "iphb-stub.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <dbus/dbus.h>
+#include "../dbus-gmain/dbus-gmain.h"
+#include "keepalive-backgroundactivity.h"
+
+#define failure(FMT, ARGS...) do {\
+    fprintf(stderr, "%s: "FMT"\n", __FUNCTION__, ## ARGS);\
+    exit(EXIT_FAILURE);\
+} while(0)
+
+/* Time allowed for setup / final IPC to settle [ms] */
+#define WORKLOAD_SETTLE_MS 500
+
+/* Pause between wakeup rounds [ms] */
+#define WORKLOAD_ROUND_GAP_MS 50
+
+/* ========================================================================= *
+ * Prototypes
+ * ========================================================================= */
+
+static void     workload_send_marker(const char *phase);
+static gboolean workload_linger_cb  (gpointer aptr);
+static void     workload_done_one   (background_activity_t *activity);
+static void     workload_running_cb (background_activity_t *activity, void *aptr);
+static gboolean workload_round_cb   (gpointer aptr);
+static gboolean workload_steady_cb  (gpointer aptr);
+static gboolean workload_finish_cb  (gpointer aptr);
+
+int main(int argc, char **argv);
+
+/* ========================================================================= *
+ * State
+ * ========================================================================= */
+
+static gint workload_activities = 10;
+static gint workload_wakeups    = 12;
+static gint workload_linger     = 10;
+static gint workload_slot       = BACKGROUND_ACTIVITY_FREQUENCY_FIVE_MINUTES;
+
+static background_activity_t **workload_activity = 0;
+
+/** Number of completed wakeup rounds */
+static gint workload_round = 0;
+
+/** Number of activities still running in current round */
+static gint workload_pending = 0;
+
+static DBusConnection *workload_bus = 0;
+static GMainLoop      *workload_mainloop = 0;
+
+/* ========================================================================= *
+ * WORKLOAD
+ * ========================================================================= */
+
+static void
+workload_send_marker(const char *phase)
+{
+    DBusMessage *sig = dbus_message_new_signal(TRAFFIC_MARKER_PATH,
+                                               TRAFFIC_MARKER_IF,
+                                               TRAFFIC_MARKER_SIG);
+    if( !sig )
+        failure("could not create marker signal");
+
+    dbus_message_append_args(sig,
+                             DBUS_TYPE_STRING, &phase,
+                             DBUS_TYPE_INVALID);
+    dbus_connection_send(workload_bus, sig, 0);
+    dbus_connection_flush(workload_bus);
+    dbus_message_unref(sig);
+}
+
+static gboolean
+workload_linger_cb(gpointer aptr)
+{
+    workload_done_one(aptr);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+workload_done_one(background_activity_t *activity)
+{
+    background_activity_wait(activity);
+
+    if( --workload_pending == 0 )
+        g_timeout_add(WORKLOAD_ROUND_GAP_MS, workload_round_cb, 0);
+}
+
+static void
+workload_running_cb(background_activity_t *activity, void *aptr)
+{
+    (void)aptr;
+
+    guint linger_ms = workload_linger * 1000 / TRAFFIC_TIME_SCALE;
+
+    if( linger_ms > 0 )
+        g_timeout_add(linger_ms, workload_linger_cb, activity);
+    else
+        workload_done_one(activity);
+}
+
+static gboolean
+workload_round_cb(gpointer aptr)
+{
+    (void)aptr;
+
+    if( workload_round >= workload_wakeups ) {
+        g_timeout_add(WORKLOAD_SETTLE_MS, workload_finish_cb, 0);
+    }
+    else {
+        workload_round += 1;
+        workload_pending = workload_activities;
+        iphb_stub_wakeup_all();
+    }
+
+    return G_SOURCE_REMOVE;
+}
+
+static gboolean
+workload_steady_cb(gpointer aptr)
+{
+    (void)aptr;
+
+    workload_send_marker(TRAFFIC_PHASE_STEADY);
+    workload_round_cb(0);
+    return G_SOURCE_REMOVE;
+}
+
+static gboolean
+workload_finish_cb(gpointer aptr)
+{
+    (void)aptr;
+
+    workload_send_marker(TRAFFIC_PHASE_DONE);
+    g_main_loop_quit(workload_mainloop);
+    return G_SOURCE_REMOVE;
+}
+
+/* ========================================================================= *
+ * MAIN
+ * ========================================================================= */
+
+int
+main(int argc, char **argv)
+{
+    DBusError  err  = DBUS_ERROR_INIT;
+    GError    *gerr = 0;
+
+    GOptionEntry entries[] = {
+        { "activities", 'n', 0, G_OPTION_ARG_INT, &workload_activities,
+          "Number of background activities (default: 10)", "COUNT" },
+        { "wakeups", 'm', 0, G_OPTION_ARG_INT, &workload_wakeups,
+          "Number of wakeups to simulate (default: 12)", "COUNT" },
+        { "linger", 'l', 0, G_OPTION_ARG_INT, &workload_linger,
+          "Simulated time spent in running state (default: 10)", "SECONDS" },
+        { "slot", 'f', 0, G_OPTION_ARG_INT, &workload_slot,
+          "Wakeup slot (default: 300)", "SECONDS" },
+        { NULL }
+    };
+
+    GOptionContext *ctx = g_option_context_new("- glib D-Bus traffic workload");
+    g_option_context_add_main_entries(ctx, entries, 0);
+    if( !g_option_context_parse(ctx, &argc, &argv, &gerr) )
+        failure("option parsing failed: %s", gerr->message);
+    g_option_context_free(ctx);
+
+    if( workload_activities < 1 || workload_wakeups < 0 ||
+        workload_linger < 0 || workload_slot < 1 )
+        failure("invalid workload parameters");
+
+    /* Wakeups are generated explicitly */
+    iphb_stub_set_immediate(false);
+
+    if( !(workload_bus = dbus_bus_get(DBUS_BUS_SYSTEM, &err)) )
+        failure("%s: %s", err.name, err.message);
+    dbus_gmain_set_up_connection(workload_bus, 0);
+
+    workload_activity = g_malloc0(workload_activities * sizeof *workload_activity);
+    for( gint i = 0; i < workload_activities; ++i ) {
+        background_activity_t *activity = background_activity_new();
+        background_activity_set_wakeup_slot(activity, workload_slot);
+        background_activity_set_running_callback(activity, workload_running_cb);
+        background_activity_wait(activity);
+        workload_activity[i] = activity;
+    }
+
+    workload_mainloop = g_main_loop_new(0, FALSE);
+    g_timeout_add(WORKLOAD_SETTLE_MS, workload_steady_cb, 0);
+    g_main_loop_run(workload_mainloop);
+    g_main_loop_unref(workload_mainloop), workload_mainloop = 0;
+
+    for( gint i = 0; i < workload_activities; ++i ) {
+        background_activity_set_running_callback(workload_activity[i], 0);
+        background_activity_unref(workload_activity[i]);
+    }
+    g_free(workload_activity);
+
+    dbus_connection_unref(workload_bus), workload_bus = 0;
+    dbus_error_free(&err);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,197 @@
+/****************************************************************************************
+**
+** Copyright (C) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of nemo-keepalive package.
+**
+** You may use this file under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+****************************************************************************************/
+
+/* D-Bus traffic workload driver for libkeepalive (Qt)
+ *
+ * Qt counterpart of dbus-traffic-glib.c: N BackgroundActivity
+ * objects, M simulated wakeups and configurable linger time.
+ */
+
+#include "dbus-traffic.h"
+#include "iphb-stub.h"
+
+#include <backgroundactivity.h>
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QTimer>
+#include <QList>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Time allowed for setup / final IPC to settle [ms] */
+#define WORKLOAD_SETTLE_MS 500
+
+/* Pause between wakeup rounds [ms] */
+#define WORKLOAD_ROUND_GAP_MS 50
+
+class TrafficWorkload : public QObject
+{
+    Q_OBJECT
+
+public:
+    TrafficWorkload(int activities, int wakeups, int linger, int slot,
+                    QObject *parent = 0);
+    virtual ~TrafficWorkload();
+
+    void start();
+
+private Q_SLOTS:
+    void activityRunning();
+    void enterSteadyState();
+    void nextRound();
+    void finish();
+
+private:
+    void doneOne(BackgroundActivity *activity);
+    void sendMarker(const QString &phase);
+
+    QList<BackgroundActivity *> m_activities;
+    int m_wakeups;
+    int m_lingerMs;
+    int m_round;
+    int m_pending;
+};
+
+TrafficWorkload::TrafficWorkload(int activities, int wakeups, int linger,
+                                 int slot, QObject *parent)
+    : QObject(parent)
+    , m_wakeups(wakeups)
+    , m_lingerMs(linger * 1000 / TRAFFIC_TIME_SCALE)
+    , m_round(0)
+    , m_pending(0)
+{
+    for( int i = 0; i < activities; ++i ) {
+        BackgroundActivity *activity = new BackgroundActivity(this);
+        activity->setWakeupFrequency(BackgroundActivity::Frequency(slot));
+        connect(activity, SIGNAL(running()), this, SLOT(activityRunning()));
+        m_activities.append(activity);
+    }
+}
+
+TrafficWorkload::~TrafficWorkload()
+{
+    qDeleteAll(m_activities);
+}
+
+void TrafficWorkload::start()
+{
+    Q_FOREACH( BackgroundActivity *activity, m_activities )
+        activity->wait();
+    QTimer::singleShot(WORKLOAD_SETTLE_MS, this, SLOT(enterSteadyState()));
+}
+
+void TrafficWorkload::activityRunning()
+{
+    BackgroundActivity *activity = qobject_cast<BackgroundActivity *>(sender());
+    if( !activity )
+        return;
+
+    if( m_lingerMs > 0 )
+        QTimer::singleShot(m_lingerMs, this, [this, activity]() { doneOne(activity); });
+    else
+        doneOne(activity);
+}
+
+void TrafficWorkload::doneOne(BackgroundActivity *activity)
+{
+    activity->wait();
+
+    if( --m_pending == 0 )
+        QTimer::singleShot(WORKLOAD_ROUND_GAP_MS, this, SLOT(nextRound()));
+}
+
+void TrafficWorkload::enterSteadyState()
+{
+    sendMarker(TRAFFIC_PHASE_STEADY);
+    nextRound();
+}
+
+void TrafficWorkload::nextRound()
+{
+    if( m_round >= m_wakeups ) {
+        QTimer::singleShot(WORKLOAD_SETTLE_MS, this, SLOT(finish()));
+    }
+    else {
+        m_round += 1;
+        m_pending = m_activities.count();
+        iphb_stub_wakeup_all();
+    }
+}
+
+void TrafficWorkload::finish()
+{
+    sendMarker(TRAFFIC_PHASE_DONE);
+    QCoreApplication::quit();
+}
+
+void TrafficWorkload::sendMarker(const QString &phase)
+{
+    QDBusMessage sig = QDBusMessage::createSignal(TRAFFIC_MARKER_PATH,
+                                                  TRAFFIC_MARKER_IF,
+                                                  TRAFFIC_MARKER_SIG);
+    sig << phase;
+    QDBusConnection::systemBus().send(sig);
+}
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Qt D-Bus traffic workload");
+    parser.addHelpOption();
+    parser.addOptions({
+        { { "n", "activities" }, "Number of background activities (default: 10)", "COUNT", "10" },
+        { { "m", "wakeups" }, "Number of wakeups to simulate (default: 12)", "COUNT", "12" },
+        { { "l", "linger" }, "Simulated time spent in running state (default: 10)", "SECONDS", "10" },
+        { { "f", "slot" }, "Wakeup slot (default: 300)", "SECONDS", "300" },
+    });
+    parser.process(app);
+
+    int activities = parser.value("activities").toInt();
+    int wakeups    = parser.value("wakeups").toInt();
+    int linger     = parser.value("linger").toInt();
+    int slot       = parser.value("slot").toInt();
+
+    if( activities < 1 || wakeups < 0 || linger < 0 || slot < 1 ) {
+        fprintf(stderr, "invalid workload parameters\n");
+        return EXIT_FAILURE;
+    }
+
+    /* Wakeups are generated explicitly */
+    iphb_stub_set_immediate(false);
+
+    TrafficWorkload workload(activities, wakeups, linger, slot);
+    workload.start();
+
+    return app.exec();
+}
+
+#include "dbus-traffic-qt.moc"
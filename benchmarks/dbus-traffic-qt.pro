@@ -0,0 +1,22 @@
+# -*- mode: sh -*-
+
+TEMPLATE     = app
+TARGET       = dbus-traffic-qt
+
+QT          += dbus
+QT          -= gui
+CONFIG      += qt debug link_pkgconfig c++11 no_keywords
+CONFIG      -= app_bundle
+PKGCONFIG   += libiphb
+
+INCLUDEPATH += $$PWD/../lib $$PWD/../tests/iphbstub
+LIBS        += -L$$PWD/../lib -lkeepalive
+QMAKE_LFLAGS += -Wl,-rpath-link,$$PWD/../lib-glib
+
+# Export iphb_xxx() stubs so that they override libiphb
+QMAKE_LFLAGS += -rdynamic
+
+SOURCES     += dbus-traffic-qt.cpp
+SOURCES     += ../tests/iphbstub/iphb-stub.c
+HEADERS     += dbus-traffic.h
+HEADERS     += ../tests/iphbstub/iphb-stub.h
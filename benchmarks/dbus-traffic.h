@@ -0,0 +1,54 @@
+/****************************************************************************************
+**
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of nemo-keepalive package.
+**
+** You may use this file under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+****************************************************************************************/
+
+#ifndef KEEPALIVE_BENCHMARKS_DBUS_TRAFFIC_H_
+# define KEEPALIVE_BENCHMARKS_DBUS_TRAFFIC_H_
+
+/* Constants shared by D-Bus traffic benchmark programs
+ *
+ * Workload drivers broadcast phase marker signals that the traffic
+ * counter uses to separate one-time setup traffic from steady state
+ * traffic. The markers themselves are not included in statistics.
+ */
+
+# define TRAFFIC_MARKER_PATH    "/org/nemomobile/keepalive/benchmark"
+# define TRAFFIC_MARKER_IF      "org.nemomobile.keepalive.benchmark"
+# define TRAFFIC_MARKER_SIG     "phase"
+
+/** Phase marker: setup done, start counting steady state traffic */
+# define TRAFFIC_PHASE_STEADY   "steady"
+
+/** Phase marker: workload finished, report and exit */
+# define TRAFFIC_PHASE_DONE     "done"
+
+/** MCE cpu keepalive period assumed when scaling simulated time
+ *
+ * The mock MCE reports a one second period, which makes one second
+ * of wall clock time equal to this many seconds of simulated time.
+ */
+# define TRAFFIC_TIME_SCALE     60
+
+#endif /* KEEPALIVE_BENCHMARKS_DBUS_TRAFFIC_H_ */
@@ -0,0 +1,151 @@
+#!/bin/sh
+
+# Measure D-Bus traffic caused by keepalive libraries
+#
+# Each workload is run against a private dbus-daemon with mock MCE
+# service from ../tests/mockmce. Results are written to dbus-traffic.results and compared
+# against dbus-traffic.baseline if it exists.
+#
+# Usage: dbus-traffic.sh [--update-baseline]
+
+set -e
+
+HERE=$(cd "$(dirname "$0")" && pwd)
+MOCKMCE=$HERE/../tests/mockmce/mockmce-daemon
+BASELINE=$HERE/dbus-traffic.baseline
+RESULTS=${RESULTS:-$HERE/dbus-traffic.results}
+
+# Workloads: activities wakeups linger slot
+WORKLOADS="
+1  12 0   300
+10 12 0   300
+10 12 10  300
+10 12 120 300
+50 12 10  300
+10 48 10  30
+"
+
+WORKDIR=$(mktemp -d)
+BUS_PID=
+MCE_PID=
+COUNTER_PID=
+
+cleanup()
+{
+  for pid in $COUNTER_PID $MCE_PID $BUS_PID; do
+    kill $pid 2>/dev/null || true
+  done
+  wait 2>/dev/null || true
+  BUS_PID= MCE_PID= COUNTER_PID=
+}
+
+trap 'cleanup; rm -rf "$WORKDIR"' EXIT
+
+wait_until()
+{
+  # wait_until <condition command...>
+  for i in $(seq 100); do
+    if "$@" >/dev/null 2>&1; then return 0; fi
+    sleep 0.05
+  done
+  echo >&2 "timeout: $*"
+  exit 1
+}
+
+mce_is_running()
+{
+  dbus-send --system --print-reply --dest=org.freedesktop.DBus \
+    /org/freedesktop/DBus org.freedesktop.DBus.NameHasOwner \
+    string:com.nokia.mce | grep -q true
+}
+
+start_bus()
+{
+  cat > "$WORKDIR/bus.conf" <<EOC
+<!DOCTYPE busconfig PUBLIC "-//freedesktop//DTD D-Bus Bus Configuration 1.0//EN"
+ "http://www.freedesktop.org/standards/dbus/1.0/busconfig.dtd">
+<busconfig>
+  <type>system</type>
+  <listen>unix:path=$WORKDIR/bus</listen>
+  <auth>EXTERNAL</auth>
+  <policy context="default">
+    <allow send_destination="*" eavesdrop="true"/>
+    <allow eavesdrop="true"/>
+    <allow own="*"/>
+  </policy>
+</busconfig>
+EOC
+  rm -f "$WORKDIR/bus"
+  dbus-daemon --nofork --config-file="$WORKDIR/bus.conf" &
+  BUS_PID=$!
+  wait_until test -S "$WORKDIR/bus"
+  export DBUS_SYSTEM_BUS_ADDRESS="unix:path=$WORKDIR/bus"
+}
+
+run_workload()
+{
+  # run_workload <lib> <driver> <activities> <wakeups> <linger> <slot>
+  lib=$1 driver=$2 n=$3 m=$4 linger=$5 slot=$6
+  label="$lib/n=$n/m=$m/linger=$linger/slot=$slot"
+  echo >&2 "running: $label"
+
+  start_bus
+  "$MOCKMCE" --period=1 --grace=500 --label="$label" --summary="$RESULTS" &
+  MCE_PID=$!
+  wait_until mce_is_running
+
+  : > "$WORKDIR/counter.out"
+  "$HERE/dbus-traffic-counter" --label="$label" \
+    --simulated-seconds=$((m * slot)) --output="$RESULTS" \
+    > "$WORKDIR/counter.out" &
+  COUNTER_PID=$!
+  wait_until grep -q ready "$WORKDIR/counter.out"
+
+  timeout 600 "$driver" -n $n -m $m -l $linger -f $slot
+  wait $COUNTER_PID
+  COUNTER_PID=
+
+  # Let mock MCE write its summary
+  kill $MCE_PID
+  wait $MCE_PID || true
+  MCE_PID=
+  cleanup
+}
+
+summarize()
+{
+  # label messages/h bytes/h round_trips/h
+  sed -n 's/.*"label":"\([^"]*\)".*"per_hour":{"messages":\([0-9.]*\),"bytes":\([0-9.]*\),"calls":[0-9.]*,"round_trips":\([0-9.]*\).*/\1 \2 \3 \4/p' "$1"
+}
+
+: > "$RESULTS"
+
+while read n m linger slot; do
+  test -n "$n" || continue
+  run_workload glib "$HERE/dbus-traffic-glib" $n $m $linger $slot
+  if test -x "$HERE/dbus-traffic-qt"; then
+    run_workload qt "$HERE/dbus-traffic-qt" $n $m $linger $slot
+  fi
+done <<EOW
+$WORKLOADS
+EOW
+
+# Keepalive gaps mean the workload was not measured as intended
+sed -n 's/.*"label":"\([^"]*\)".*"cpu_keepalive_gaps":\([1-9][0-9]*\).*/warning: \1: \2 cpu keepalive gaps/p' "$RESULTS" >&2
+
+if test "$1" = "--update-baseline"; then
+  cp "$RESULTS" "$BASELINE"
+  echo >&2 "baseline updated: $BASELINE"
+elif test -f "$BASELINE"; then
+  summarize "$BASELINE" > "$WORKDIR/baseline.txt"
+  summarize "$RESULTS"  > "$WORKDIR/results.txt"
+  printf "%-40s %22s %22s %22s\n" workload msgs/h bytes/h round-trips/h
+  awk 'NR == FNR { base[$1] = $0; next }
+       {
+         split(base[$1], b, " ")
+         printf "%-40s %10s -> %-9s %10s -> %-9s %10s -> %-9s\n",
+                $1, b[2], $2, b[3], $3, b[4], $4
+       }' "$WORKDIR/baseline.txt" "$WORKDIR/results.txt"
+else
+  summarize "$RESULTS"
+fi
@@ -0,0 +1,479 @@
+/****************************************************************************************
+**
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of nemo-keepalive package.
+**
+** You may use this file under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+****************************************************************************************/
+
+#include "iphb-stub.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <glib.h>
+#include "keepalive-backgroundactivity.h"
+#include "keepalive-cpukeepalive.h"
+#include "keepalive-displaykeepalive.h"
+#include "keepalive-heartbeat.h"
+#include "keepalive-timeout.h"
+
+#define failure(FMT, ARGS...) do {\
+    fprintf(stderr, "%s: "FMT"\n", __FUNCTION__, ## ARGS);\
+    exit(EXIT_FAILURE);\
+} while(0)
+
+/* Bus address that can't be connected to -> MCE is seen as absent */
+#define BENCH_SYSTEM_BUS_ADDRESS "unix:path=/nonexistent/keepalive-bench"
+
+/* Upper bound for waiting a single wakeup in latency benchmark */
+#define BENCH_WAKEUP_TIMEOUT_NS (5 * 1000000000LL)
+
+/* ========================================================================= *
+ * Prototypes
+ * ========================================================================= */
+
+/* ------------------------------------------------------------------------- *
+ * UTILITY
+ * ------------------------------------------------------------------------- */
+
+static gint64 bench_now_ns      (void);
+static void   bench_drain       (void);
+static void   bench_report      (const char *bench, const char *variant, int threads, long ops, gint64 total_ns);
+static int    bench_compare_ns  (const void *a, const void *b);
+
+/* ------------------------------------------------------------------------- *
+ * LIFECYCLE
+ * ------------------------------------------------------------------------- */
+
+static void   bench_lifecycle   (long iterations);
+
+/* ------------------------------------------------------------------------- *
+ * TRANSITIONS
+ * ------------------------------------------------------------------------- */
+
+static void   bench_running_cb  (background_activity_t *activity, void *aptr);
+static void   bench_wakeup      (long iterations);
+static void   bench_run_stop    (long iterations);
+
+/* ------------------------------------------------------------------------- *
+ * CONTENTION
+ * ------------------------------------------------------------------------- */
+
+typedef struct
+{
+    /** Benchmark worker function */
+    void                 (*bc_func)(void *object, long iterations);
+
+    /** Object to operate on */
+    void                  *bc_object;
+
+    /** Number of operations to make */
+    long                   bc_iterations;
+
+    /** Barrier for starting all threads at once */
+    pthread_barrier_t     *bc_barrier;
+} bench_contention_t;
+
+static void  *bench_contention_thread(void *aptr);
+static void   bench_contention_range (void *object, long iterations);
+static void   bench_contention_cpu   (void *object, long iterations);
+static void   bench_contention       (long iterations, int threads);
+
+/* ------------------------------------------------------------------------- *
+ * TIMEOUT_CHURN
+ * ------------------------------------------------------------------------- */
+
+static gboolean bench_timeout_cb     (gpointer aptr);
+static void     bench_timeout_churn  (long iterations);
+
+/* ------------------------------------------------------------------------- *
+ * MAIN
+ * ------------------------------------------------------------------------- */
+
+int main(int argc, char **argv);
+
+/* ========================================================================= *
+ * UTILITY
+ * ========================================================================= */
+
+static gint64
+bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/** Dispatch pending idle callbacks, deferred frees etc */
+static void
+bench_drain(void)
+{
+    while( g_main_context_iteration(0, FALSE) )
+        ;
+}
+
+static void
+bench_report(const char *bench, const char *variant, int threads,
+             long ops, gint64 total_ns)
+{
+    printf("{\"bench\":\"%s\",\"variant\":\"%s\",\"threads\":%d,"
+           "\"ops\":%ld,\"total_ns\":%lld,\"ns_per_op\":%.1f}\n",
+           bench, variant, threads, ops, (long long)total_ns,
+           ops > 0 ? (double)total_ns / ops : 0.0);
+    fflush(stdout);
+}
+
+static int
+bench_compare_ns(const void *a, const void *b)
+{
+    gint64 x = *(const gint64 *)a;
+    gint64 y = *(const gint64 *)b;
+    return (x > y) - (x < y);
+}
+
+/* ========================================================================= *
+ * LIFECYCLE
+ * ========================================================================= */
+
+static void
+bench_lifecycle(long iterations)
+{
+    gint64 t;
+
+    t = bench_now_ns();
+    for( long i = 0; i < iterations; ++i )
+        background_activity_unref(background_activity_new());
+    bench_drain();
+    bench_report("lifecycle", "background_activity", 1, iterations,
+                 bench_now_ns() - t);
+
+    t = bench_now_ns();
+    for( long i = 0; i < iterations; ++i )
+        cpukeepalive_unref(cpukeepalive_new());
+    bench_drain();
+    bench_report("lifecycle", "cpukeepalive", 1, iterations,
+                 bench_now_ns() - t);
+
+    t = bench_now_ns();
+    for( long i = 0; i < iterations; ++i )
+        displaykeepalive_unref(displaykeepalive_new());
+    bench_drain();
+    bench_report("lifecycle", "displaykeepalive", 1, iterations,
+                 bench_now_ns() - t);
+
+    t = bench_now_ns();
+    for( long i = 0; i < iterations; ++i )
+        heartbeat_unref(heartbeat_new());
+    bench_drain();
+    bench_report("lifecycle", "heartbeat", 1, iterations,
+                 bench_now_ns() - t);
+}
+
+/* ========================================================================= *
+ * TRANSITIONS
+ * ========================================================================= */
+
+static void
+bench_running_cb(background_activity_t *activity, void *aptr)
+{
+    bool *woken = aptr;
+    *woken = true;
+    background_activity_stop(activity);
+}
+
+/** Latency from background_activity_wait() to running callback
+ *
+ * The IPHB stand-in delivers wakeups immediately, so this
+ * measures the library and main loop overhead only.
+ */
+static void
+bench_wakeup(long iterations)
+{
+    background_activity_t *activity = background_activity_new();
+    gint64                *samples  = g_malloc0(iterations * sizeof *samples);
+    bool                   woken    = false;
+    gint64                 total    = 0;
+
+    background_activity_set_wakeup_slot(activity,
+                                        BACKGROUND_ACTIVITY_FREQUENCY_THIRTY_SECONDS);
+    background_activity_set_user_data(activity, &woken, 0);
+    background_activity_set_running_callback(activity, bench_running_cb);
+
+    for( long i = 0; i < iterations; ++i ) {
+        woken = false;
+        gint64 t = bench_now_ns();
+        background_activity_wait(activity);
+        while( !woken ) {
+            g_main_context_iteration(0, TRUE);
+            if( bench_now_ns() - t > BENCH_WAKEUP_TIMEOUT_NS )
+                failure("wakeup not delivered");
+        }
+        samples[i] = bench_now_ns() - t;
+        total += samples[i];
+    }
+
+    qsort(samples, iterations, sizeof *samples, bench_compare_ns);
+    bench_report("wakeup_latency", "mean", 1, iterations, total);
+    bench_report("wakeup_latency", "p50", 1, 1, samples[iterations / 2]);
+    bench_report("wakeup_latency", "p99", 1, 1, samples[iterations * 99 / 100]);
+    bench_report("wakeup_latency", "max", 1, 1, samples[iterations - 1]);
+
+    background_activity_set_running_callback(activity, 0);
+    background_activity_unref(activity);
+    bench_drain();
+    g_free(samples);
+}
+
+/** Throughput of running <-> stopped transitions
+ *
+ * Each run() starts cpu keepalive, so this also covers
+ * keepalive session setup and teardown.
+ */
+static void
+bench_run_stop(long iterations)
+{
+    background_activity_t *activity = background_activity_new();
+
+    gint64 t = bench_now_ns();
+    for( long i = 0; i < iterations; ++i ) {
+        background_activity_run(activity);
+        background_activity_stop(activity);
+    }
+    bench_drain();
+    bench_report("run_stop", "background_activity", 1, iterations,
+                 bench_now_ns() - t);
+
+    background_activity_unref(activity);
+    bench_drain();
+}
+
+/* ========================================================================= *
+ * CONTENTION
+ * ========================================================================= */
+
+static void *
+bench_contention_thread(void *aptr)
+{
+    bench_contention_t *self = aptr;
+
+    pthread_barrier_wait(self->bc_barrier);
+    self->bc_func(self->bc_object, self->bc_iterations);
+    return 0;
+}
+
+static void
+bench_contention_range(void *object, long iterations)
+{
+    background_activity_t *activity = object;
+    int lo = 0, hi = 0;
+
+    for( long i = 0; i < iterations; ++i ) {
+        background_activity_set_wakeup_range(activity, 60, 120);
+        background_activity_get_wakeup_range(activity, &lo, &hi);
+    }
+}
+
+static void
+bench_contention_cpu(void *object, long iterations)
+{
+    cpukeepalive_t *keepalive = object;
+
+    for( long i = 0; i < iterations; ++i ) {
+        cpukeepalive_start(keepalive);
+        cpukeepalive_stop(keepalive);
+    }
+}
+
+/** Hammer objects from several threads
+ *
+ * In the "shared" variant all threads use the same object, in the
+ * "separate" variant each thread has an object of its own.
+ */
+static void
+bench_contention(long iterations, int threads)
+{
+    static const struct {
+        const char *name;
+        void      (*func)(void *, long);
+        bool        cpu;
+    } cases[] = {
+        { "wakeup_range", bench_contention_range, false },
+        { "cpukeepalive", bench_contention_cpu,   true  },
+    };
+
+    pthread_t          *tid    = g_malloc0(threads * sizeof *tid);
+    bench_contention_t *worker = g_malloc0(threads * sizeof *worker);
+    void              **object = g_malloc0(threads * sizeof *object);
+    pthread_barrier_t   barrier;
+
+    for( size_t c = 0; c < G_N_ELEMENTS(cases); ++c ) {
+        for( int shared = 1; shared >= 0; --shared ) {
+            for( int i = 0; i < threads; ++i ) {
+                if( shared && i > 0 )
+                    object[i] = object[0];
+                else if( cases[c].cpu )
+                    object[i] = cpukeepalive_new();
+                else
+                    object[i] = background_activity_new();
+            }
+
+            pthread_barrier_init(&barrier, 0, threads + 1);
+            for( int i = 0; i < threads; ++i ) {
+                worker[i].bc_func       = cases[c].func;
+                worker[i].bc_object     = object[i];
+                worker[i].bc_iterations = iterations;
+                worker[i].bc_barrier    = &barrier;
+                if( pthread_create(&tid[i], 0, bench_contention_thread,
+                                   &worker[i]) != 0 )
+                    failure("could not create thread");
+            }
+
+            gint64 t = bench_now_ns();
+            pthread_barrier_wait(&barrier);
+            for( int i = 0; i < threads; ++i )
+                pthread_join(tid[i], 0);
+            t = bench_now_ns() - t;
+            pthread_barrier_destroy(&barrier);
+
+            char variant[64];
+            snprintf(variant, sizeof variant, "%s/%s", cases[c].name,
+                     shared ? "shared" : "separate");
+            bench_report("contention", variant, threads,
+                         iterations * threads, t);
+
+            for( int i = 0; i < threads; ++i ) {
+                if( shared && i > 0 )
+                    break;
+                if( cases[c].cpu )
+                    cpukeepalive_unref(object[i]);
+                else
+                    background_activity_unref(object[i]);
+            }
+            bench_drain();
+        }
+    }
+
+    g_free(object);
+    g_free(worker);
+    g_free(tid);
+}
+
+/* ========================================================================= *
+ * TIMEOUT_CHURN
+ * ========================================================================= */
+
+static gboolean
+bench_timeout_cb(gpointer aptr)
+{
+    (void)aptr;
+    return G_SOURCE_REMOVE;
+}
+
+/** Cost of adding and cancelling keepalive timers
+ *
+ * Short timers are expected to take the plain glib timer path,
+ * long ones go through background activity objects.
+ */
+static void
+bench_timeout_churn(long iterations)
+{
+    static const struct {
+        const char *name;
+        guint       interval;
+    } cases[] = {
+        { "short", 100   },
+        { "long",  60000 },
+    };
+
+    for( size_t c = 0; c < G_N_ELEMENTS(cases); ++c ) {
+        gint64 t = bench_now_ns();
+        for( long i = 0; i < iterations; ++i ) {
+            guint id = keepalive_timeout_add(cases[c].interval,
+                                             bench_timeout_cb, 0);
+            g_source_remove(id);
+        }
+        bench_drain();
+        bench_report("timeout_churn", cases[c].name, 1, iterations,
+                     bench_now_ns() - t);
+    }
+}
+
+/* ========================================================================= *
+ * MAIN
+ * ========================================================================= */
+
+int
+main(int argc, char **argv)
+{
+    gint      iterations = 10000;
+    gint      threads    = 4;
+    gchar    *only       = 0;
+    GError   *err        = 0;
+
+    GOptionEntry entries[] = {
+        { "iterations", 'n', 0, G_OPTION_ARG_INT, &iterations,
+          "Number of operations per benchmark", "COUNT" },
+        { "threads", 't', 0, G_OPTION_ARG_INT, &threads,
+          "Number of threads in contention benchmarks", "COUNT" },
+        { "only", 'o', 0, G_OPTION_ARG_STRING, &only,
+          "Run only named benchmark: lifecycle, wakeup_latency, "
+          "run_stop, contention or timeout_churn", "NAME" },
+        { NULL }
+    };
+
+    GOptionContext *ctx = g_option_context_new("- libkeepalive-glib microbenchmarks");
+    g_option_context_add_main_entries(ctx, entries, 0);
+    if( !g_option_context_parse(ctx, &argc, &argv, &err) )
+        failure("option parsing failed: %s", err->message);
+    g_option_context_free(ctx);
+
+    if( iterations < 1 || threads < 1 )
+        failure("iteration and thread counts must be positive");
+
+    /* Use in-process stand-ins instead of MCE and DSME */
+    setenv("DBUS_SYSTEM_BUS_ADDRESS", BENCH_SYSTEM_BUS_ADDRESS, 1);
+    iphb_stub_set_immediate(true);
+
+#define RUN(NAME, CALL) do {\
+    if( !only || !strcmp(only, NAME) )\
+        CALL;\
+} while(0)
+
+    RUN("lifecycle",      bench_lifecycle(iterations));
+    RUN("wakeup_latency", bench_wakeup(iterations));
+    RUN("run_stop",       bench_run_stop(iterations));
+    RUN("contention",     bench_contention(iterations, threads));
+    RUN("timeout_churn",  bench_timeout_churn(iterations));
+
+#undef RUN
+
+    iphb_stub_stats_t stats;
+    iphb_stub_get_stats(&stats);
+    fprintf(stderr, "iphb: opens=%u closes=%u waits=%u wakeups=%u\n",
+            stats.iss_opens, stats.iss_closes, stats.iss_waits,
+            stats.iss_wakeups);
+
+    g_free(only);
+    return EXIT_SUCCESS;
+}
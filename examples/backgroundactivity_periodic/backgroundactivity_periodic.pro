@@ -8,6 +8,7 @@ CONFIG      += qt debug link_pkgconfig
 PKGCONFIG   +=
 
 LIBS        += -L../../lib -lkeepalive
+QMAKE_LFLAGS += -Wl,-rpath-link,$$PWD/../../lib-glib
 
 SOURCES     += backgroundactivity_periodic.cpp
 
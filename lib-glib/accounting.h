@@ -0,0 +1,84 @@
+/****************************************************************************************
+**
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of nemo-keepalive package.
+**
+** You may use this file under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+****************************************************************************************/
+
+#ifndef KEEPALIVE_GLIB_ACCOUNTING_INTERNAL_H_
+# define KEEPALIVE_GLIB_ACCOUNTING_INTERNAL_H_
+
+# include "keepalive-accounting.h"
+# include "keepalive-heartbeat.h"
+
+# include <stdbool.h>
+
+# ifdef __cplusplus
+extern "C" {
+# elif 0
+} /* fool JED indentation ... */
+# endif
+
+/* Internal to libkeepalive-glib - documented at source code
+ *
+ * These functions are not exported and the header must not
+ * be included in the devel package
+ */
+
+/** Accounting record embedded in keepalive objects */
+typedef struct accounting_t accounting_t;
+
+struct accounting_t
+{
+    /** Accounting data visible via API */
+    keepalive_accounting_t  acc_data;
+
+    /** Start time of ongoing running period [ms], or -1 */
+    int64_t                 acc_run_started;
+
+    /** Flag for: record is in process wide registry */
+    bool                    acc_registered;
+
+    /** Registry list linkage */
+    accounting_t           *acc_prev;
+    accounting_t           *acc_next;
+};
+
+void accounting_ctor     (accounting_t *self, const char *kind, const char *id);
+void accounting_dtor     (accounting_t *self);
+void accounting_wakeup   (accounting_t *self);
+void accounting_run_begin(accounting_t *self);
+void accounting_run_end  (accounting_t *self);
+void accounting_ipc      (accounting_t *self);
+void accounting_get      (accounting_t *self, keepalive_accounting_t *data);
+
+/** Make heartbeat object count IPHB IPC to accounting record
+ *
+ * The record must stay valid until detached by passing NULL.
+ */
+void heartbeat_set_accounting(heartbeat_t *self, accounting_t *acc);
+
+# ifdef __cplusplus
+};
+# endif
+
+#endif // KEEPALIVE_GLIB_ACCOUNTING_INTERNAL_H_
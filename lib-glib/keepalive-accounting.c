@@ -0,0 +1,371 @@
+/****************************************************************************************
+**
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of nemo-keepalive package.
+**
+** You may use this file under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+****************************************************************************************/
+
+#include "accounting.h"
+
+#include "logging.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+/* ========================================================================= *
+ * Prototypes
+ * ========================================================================= */
+
+/* ------------------------------------------------------------------------- *
+ * UTILITY
+ * ------------------------------------------------------------------------- */
+
+static int64_t accounting_now      (void);
+static void    accounting_set_text (char *buff, size_t size, const char *text);
+
+/* ------------------------------------------------------------------------- *
+ * REGISTRY
+ * ------------------------------------------------------------------------- */
+
+static void accounting_registry_lock  (void);
+static void accounting_registry_unlock(void);
+
+/* ------------------------------------------------------------------------- *
+ * ACCOUNTING
+ * ------------------------------------------------------------------------- */
+
+static void accounting_run_end_locked(accounting_t *self, int64_t now);
+static void accounting_get_locked    (const accounting_t *self, int64_t now, keepalive_accounting_t *data);
+static void accounting_add_totals    (keepalive_accounting_t *totals, const keepalive_accounting_t *data);
+
+void accounting_ctor     (accounting_t *self, const char *kind, const char *id);
+void accounting_dtor     (accounting_t *self);
+void accounting_wakeup   (accounting_t *self);
+void accounting_run_begin(accounting_t *self);
+void accounting_run_end  (accounting_t *self);
+void accounting_ipc      (accounting_t *self);
+void accounting_get      (accounting_t *self, keepalive_accounting_t *data);
+
+/* ------------------------------------------------------------------------- *
+ * EXTERNAL_API
+ * ------------------------------------------------------------------------- */
+
+keepalive_accounting_t *keepalive_accounting_snapshot  (size_t *count);
+void                    keepalive_accounting_get_totals(keepalive_accounting_t *totals);
+
+/* ========================================================================= *
+ * UTILITY
+ * ========================================================================= */
+
+/** Get CLOCK_BOOTTIME timestamp
+ *
+ * @return milliseconds since boot, including time spent in suspend
+ */
+static int64_t
+accounting_now(void)
+{
+    struct timespec ts = { 0, 0 };
+    clock_gettime(CLOCK_BOOTTIME, &ts);
+    return ts.tv_sec * (int64_t)1000 + ts.tv_nsec / 1000000;
+}
+
+/** Copy string to fixed size buffer, truncating if needed
+ */
+static void
+accounting_set_text(char *buff, size_t size, const char *text)
+{
+    snprintf(buff, size, "%s", text ?: "");
+}
+
+/* ========================================================================= *
+ * REGISTRY
+ * ========================================================================= */
+
+/** Mutex for protecting registry and all accounting records */
+static pthread_mutex_t accounting_registry_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/** List of live accounting records */
+static accounting_t *accounting_registry_head = 0;
+
+/** Number of live accounting records */
+static size_t accounting_registry_count = 0;
+
+/** Accumulated data from already deleted objects */
+static keepalive_accounting_t accounting_registry_dead;
+
+static void
+accounting_registry_lock(void)
+{
+    if( pthread_mutex_lock(&accounting_registry_mutex) != 0 )
+        log_abort("accounting mutex lock failed");
+}
+
+static void
+accounting_registry_unlock(void)
+{
+    if( pthread_mutex_unlock(&accounting_registry_mutex) != 0 )
+        log_abort("accounting mutex unlock failed");
+}
+
+/* ========================================================================= *
+ * ACCOUNTING
+ * ========================================================================= */
+
+/** Terminate ongoing running period
+ *
+ * @param self  accounting record
+ * @param now   current time
+ */
+static void
+accounting_run_end_locked(accounting_t *self, int64_t now)
+{
+    if( self->acc_run_started < 0 )
+        goto cleanup;
+
+    int64_t duration = now - self->acc_run_started;
+    self->acc_run_started = -1;
+
+    self->acc_data.kac_running_ms += duration;
+    if( self->acc_data.kac_longest_run_ms < duration )
+        self->acc_data.kac_longest_run_ms = duration;
+
+cleanup:
+    return;
+}
+
+/** Get accounting data, including ongoing running period
+ *
+ * @param self  accounting record
+ * @param now   current time
+ * @param data  [output] accounting data
+ */
+static void
+accounting_get_locked(const accounting_t *self, int64_t now,
+                      keepalive_accounting_t *data)
+{
+    *data = self->acc_data;
+    data->kac_running = self->acc_run_started >= 0;
+
+    if( self->acc_run_started >= 0 ) {
+        int64_t duration = now - self->acc_run_started;
+        data->kac_running_ms += duration;
+        if( data->kac_longest_run_ms < duration )
+            data->kac_longest_run_ms = duration;
+    }
+}
+
+/** Add accounting data to process wide totals
+ *
+ * @param totals  totals to update
+ * @param data    accounting data to add
+ */
+static void
+accounting_add_totals(keepalive_accounting_t *totals,
+                      const keepalive_accounting_t *data)
+{
+    totals->kac_ipc_messages += data->kac_ipc_messages;
+    totals->kac_wakeups      += data->kac_wakeups;
+
+    /* Background activities block suspend via cpukeepalive
+     * sessions -> count suspend blocking only once */
+    if( !strcmp(data->kac_kind, "cpukeepalive") ) {
+        totals->kac_runs       += data->kac_runs;
+        totals->kac_running_ms += data->kac_running_ms;
+        if( totals->kac_longest_run_ms < data->kac_longest_run_ms )
+            totals->kac_longest_run_ms = data->kac_longest_run_ms;
+    }
+}
+
+/** Initialize accounting record and add it to registry
+ *
+ * @param self  accounting record
+ * @param kind  object kind string
+ * @param id    object id string
+ */
+void
+accounting_ctor(accounting_t *self, const char *kind, const char *id)
+{
+    memset(self, 0, sizeof *self);
+    accounting_set_text(self->acc_data.kac_kind,
+                        sizeof self->acc_data.kac_kind, kind);
+    accounting_set_text(self->acc_data.kac_id,
+                        sizeof self->acc_data.kac_id, id);
+    self->acc_run_started = -1;
+
+    accounting_registry_lock();
+    if( (self->acc_next = accounting_registry_head) )
+        self->acc_next->acc_prev = self;
+    accounting_registry_head = self;
+    accounting_registry_count += 1;
+    self->acc_registered = true;
+    accounting_registry_unlock();
+}
+
+/** Remove accounting record from registry
+ *
+ * Accounting data is added to process wide totals.
+ *
+ * @param self  accounting record
+ */
+void
+accounting_dtor(accounting_t *self)
+{
+    accounting_registry_lock();
+    if( self->acc_registered ) {
+        accounting_run_end_locked(self, accounting_now());
+        accounting_add_totals(&accounting_registry_dead, &self->acc_data);
+
+        if( self->acc_prev )
+            self->acc_prev->acc_next = self->acc_next;
+        else
+            accounting_registry_head = self->acc_next;
+        if( self->acc_next )
+            self->acc_next->acc_prev = self->acc_prev;
+
+        self->acc_prev = self->acc_next = 0;
+        self->acc_registered = false;
+        accounting_registry_count -= 1;
+    }
+    accounting_registry_unlock();
+}
+
+/** Count wakeup from IPHB
+ *
+ * @param self  accounting record
+ */
+void
+accounting_wakeup(accounting_t *self)
+{
+    accounting_registry_lock();
+    self->acc_data.kac_wakeups += 1;
+    accounting_registry_unlock();
+}
+
+/** Start running period
+ *
+ * @param self  accounting record
+ */
+void
+accounting_run_begin(accounting_t *self)
+{
+    accounting_registry_lock();
+    if( self->acc_run_started < 0 ) {
+        self->acc_run_started = accounting_now();
+        self->acc_data.kac_runs += 1;
+    }
+    accounting_registry_unlock();
+}
+
+/** Finish running period
+ *
+ * @param self  accounting record
+ */
+void
+accounting_run_end(accounting_t *self)
+{
+    accounting_registry_lock();
+    accounting_run_end_locked(self, accounting_now());
+    accounting_registry_unlock();
+}
+
+/** Count IPC message sent
+ *
+ * @param self  accounting record
+ */
+void
+accounting_ipc(accounting_t *self)
+{
+    accounting_registry_lock();
+    self->acc_data.kac_ipc_messages += 1;
+    accounting_registry_unlock();
+}
+
+/** Get accounting data
+ *
+ * @param self  accounting record
+ * @param data  [output] accounting data
+ */
+void
+accounting_get(accounting_t *self, keepalive_accounting_t *data)
+{
+    accounting_registry_lock();
+    accounting_get_locked(self, accounting_now(), data);
+    accounting_registry_unlock();
+}
+
+/* ========================================================================= *
+ * EXTERNAL_API  --  documented in: keepalive-accounting.h
+ * ========================================================================= */
+
+keepalive_accounting_t *
+keepalive_accounting_snapshot(size_t *count)
+{
+    keepalive_accounting_t *array = 0;
+    size_t                  used  = 0;
+
+    accounting_registry_lock();
+
+    if( accounting_registry_count == 0 )
+        goto cleanup;
+
+    array = calloc(accounting_registry_count, sizeof *array);
+    if( !array )
+        goto cleanup;
+
+    int64_t now = accounting_now();
+    for( accounting_t *iter = accounting_registry_head; iter; iter = iter->acc_next )
+        accounting_get_locked(iter, now, &array[used++]);
+
+cleanup:
+    accounting_registry_unlock();
+
+    *count = used;
+    return array;
+}
+
+void
+keepalive_accounting_get_totals(keepalive_accounting_t *totals)
+{
+    keepalive_accounting_t data;
+
+    accounting_registry_lock();
+
+    *totals = accounting_registry_dead;
+    accounting_set_text(totals->kac_kind, sizeof totals->kac_kind, "total");
+    accounting_set_text(totals->kac_id, sizeof totals->kac_id, "");
+    totals->kac_running = false;
+
+    int64_t now = accounting_now();
+    for( accounting_t *iter = accounting_registry_head; iter; iter = iter->acc_next ) {
+        accounting_get_locked(iter, now, &data);
+        accounting_add_totals(totals, &data);
+
+        /* Suspend is blocked if any keepalive session is ongoing */
+        if( data.kac_running && !strcmp(data.kac_kind, "cpukeepalive") )
+            totals->kac_running = true;
+    }
+
+    accounting_registry_unlock();
+}
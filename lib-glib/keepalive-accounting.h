@@ -0,0 +1,124 @@
+/****************************************************************************************
+**
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of nemo-keepalive package.
+**
+** You may use this file under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+****************************************************************************************/
+
+/** @file keepalive-accounting.h
+ *
+ * @brief Provides API for attributing suspend blocking to components.
+ */
+
+#ifndef KEEPALIVE_GLIB_ACCOUNTING_H_
+# define KEEPALIVE_GLIB_ACCOUNTING_H_
+
+# include <stddef.h>
+# include <stdint.h>
+# include <stdbool.h>
+
+# ifdef __cplusplus
+extern "C" {
+# elif 0
+} /* fool JED indentation ... */
+# endif
+
+# pragma GCC visibility push(default)
+
+/** Maximum length of object kind string, including terminator */
+# define KEEPALIVE_ACCOUNTING_KIND_MAX 16
+
+/** Maximum length of object id string, including terminator */
+# define KEEPALIVE_ACCOUNTING_ID_MAX   64
+
+/** Power accounting data for one keepalive object
+ *
+ * Objects are identified by kind and id string. Background activity
+ * objects and the CPU keepalive objects they use share the same id,
+ * so that accounting data for both can be attributed to the same
+ * component:
+ *
+ * - "bg-activity" entries count IPHB wakeups, running state periods
+ *   and IPHB requests, see background_activity_get_accounting()
+ *
+ * - "cpukeepalive" entries count CPU keepalive sessions with MCE and
+ *   related D-Bus messages, see cpukeepalive_get_accounting()
+ */
+typedef struct
+{
+    /** Object kind: "bg-activity" or "cpukeepalive" */
+    char     kac_kind[KEEPALIVE_ACCOUNTING_KIND_MAX];
+
+    /** Object id, e.g. as returned by background_activity_get_id() */
+    char     kac_id[KEEPALIVE_ACCOUNTING_ID_MAX];
+
+    /** Number of wakeups from IPHB */
+    unsigned kac_wakeups;
+
+    /** Number of running periods / keepalive sessions */
+    unsigned kac_runs;
+
+    /** Number of IPC messages sent to MCE / DSME */
+    unsigned kac_ipc_messages;
+
+    /** Cumulative running / suspend blocking time [ms]
+     *
+     * Includes the currently ongoing period, if any. */
+    int64_t  kac_running_ms;
+
+    /** Longest single running / suspend blocking period [ms] */
+    int64_t  kac_longest_run_ms;
+
+    /** Flag for: running period / keepalive session is ongoing */
+    bool     kac_running;
+} keepalive_accounting_t;
+
+/** Get accounting data for all live keepalive objects in the process
+ *
+ * The returned array must be released with free() by the caller.
+ *
+ * @param count  [output] number of entries in the returned array
+ *
+ * @return array of accounting entries, or NULL if there are none
+ */
+keepalive_accounting_t *keepalive_accounting_snapshot(size_t *count);
+
+/** Get process wide accounting totals
+ *
+ * Totals include also objects that have already been deleted.
+ *
+ * To avoid counting the same suspend blocking twice, running time
+ * and run counts are summed up from CPU keepalive sessions only,
+ * and wakeups from background activity objects only. IPC message
+ * counts are summed from all objects.
+ *
+ * @param totals  [output] accounting totals
+ */
+void keepalive_accounting_get_totals(keepalive_accounting_t *totals);
+
+# pragma GCC visibility pop
+
+# ifdef __cplusplus
+};
+# endif
+
+#endif /* KEEPALIVE_GLIB_ACCOUNTING_H_ */
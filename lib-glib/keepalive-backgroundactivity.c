@@ -31,12 +31,19 @@
 #include "keepalive-heartbeat.h"
 #include "keepalive-cpukeepalive.h"
 #include "keepalive-object.h"
+#include "accounting.h"
+#include "wakeupdelay.h"
 
 #include "logging.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include <sys/timerfd.h>
 
 #include <glib.h>
 
@@ -53,6 +60,14 @@
 /** Memory tag for marking dead background_activity_t objects */
 #define BACKGROUND_ACTIVITY_MAJICK_DEAD  0x00000000
 
+/** How far in the future clock change tracking timer is armed [s] */
+#define BACKGROUND_ACTIVITY_CLOCKWATCH_PERIOD (24 * 60 * 60)
+
+/* Older glibc headers might not have this */
+#ifndef TFD_TIMER_CANCEL_ON_SET
+# define TFD_TIMER_CANCEL_ON_SET (1 << 1)
+#endif
+
 /* ========================================================================= *
  * TYPES
  * ========================================================================= */
@@ -71,20 +86,6 @@ typedef enum
 
 } background_activity_state_t;
 
-/** Wakeup delay using either Global slot or range */
-typedef struct
-{
-    /** Global wakeup slot, or BACKGROUND_ACTIVITY_FREQUENCY_RANGE
-     *  in case ranged wakeup is to be used */
-    background_activity_frequency_t wd_slot;
-
-    /** Minimum ranged wait period length */
-    int                             wd_range_lo;
-
-    /** Maximum ranged wait period length */
-    int                             wd_range_hi;
-} wakeup_delay_t;
-
 /** State data for background activity object
  */
 struct background_activity_t
@@ -127,12 +128,39 @@ struct background_activity_t
     /** Notify transition to Stopped state */
     background_activity_event_fn    bga_stopped_cb;
 
+    /** Notify running state budget overrun */
+    background_activity_event_fn    bga_overrun_cb;
+
+    /** Maximum running state duration [s], or 0 for no limit */
+    int                             bga_run_budget;
+
+    /** What to do when running state budget is exceeded */
+    background_activity_overrun_t   bga_overrun_action;
+
+    /** Number of running state budget overruns */
+    unsigned                        bga_overrun_count;
+
+    /** Timer id for: running state budget */
+    guint                           bga_run_budget_id;
+
+    /** Number of times running state has been entered */
+    unsigned                        bga_run_generation;
+
     /** For IPHB wakeup IPC with DSME */
     heartbeat_t                    *bga_heartbeat;
 
     /** For CPU-keepalive IPC with MCE */
     cpukeepalive_t                 *bga_keepalive;
 
+    /** Timerfd for detecting system time changes while waiting */
+    int                             bga_clockwatch_fd;
+
+    /** I/O watch id for bga_clockwatch_fd */
+    guint                           bga_clockwatch_id;
+
+    /** Power accounting data */
+    accounting_t                    bga_accounting;
+
     // Update also: background_activity_ctor() & background_activity_dtor()
 };
 
@@ -146,14 +174,6 @@ struct background_activity_t
 
 static const char *background_activity_state_repr(background_activity_state_t state);
 
-/* ------------------------------------------------------------------------- *
- * WAKEUP_DELAY
- * ------------------------------------------------------------------------- */
-
-static void wakeup_delay_set_slot (wakeup_delay_t *self, background_activity_frequency_t slot);
-static void wakeup_delay_set_range(wakeup_delay_t *self, int range_lo, int range_hi);
-static bool wakeup_delay_eq_p     (const wakeup_delay_t *self, const wakeup_delay_t *that);
-
 /* ------------------------------------------------------------------------- *
  * OBJECT_LIFETIME
  * ------------------------------------------------------------------------- */
@@ -171,6 +191,13 @@ static bool                   background_activity_validate_and_lock    (backgrou
 static void                   background_activity_set_lock             (background_activity_t *self, bool *locked, bool lock);
 static bool                   background_activity_in_shutdown_locked   (background_activity_t *self);
 
+/* ------------------------------------------------------------------------- *
+ * OBJECT_IOWATCHES
+ * ------------------------------------------------------------------------- */
+
+static void background_activity_iowatch_start_locked(background_activity_t *self, guint *iowatch_id, int fd, GIOCondition cnd, GIOFunc io_cb);
+static void background_activity_iowatch_stop_locked (background_activity_t *self, guint *iowatch_id);
+
 /* ------------------------------------------------------------------------- *
  * OBJECT_TIMERS
  * ------------------------------------------------------------------------- */
@@ -191,12 +218,23 @@ static background_activity_state_t background_activity_get_state_locked(const ba
 static bool                        background_activity_in_state_locked (const background_activity_t *self, background_activity_state_t state);
 static bool                        background_activity_in_state        (background_activity_t *self, background_activity_state_t state);
 static void                        background_activity_set_state       (background_activity_t *self, background_activity_state_t state);
+static gboolean                    background_activity_run_budget_cb   (gpointer aptr);
 
 /* ------------------------------------------------------------------------- *
  * HEARTBEAT_WAKEUP
  * ------------------------------------------------------------------------- */
 
-static void background_activity_heartbeat_wakeup_cb(void *aptr);
+static void background_activity_heartbeat_program_locked(background_activity_t *self);
+static void background_activity_heartbeat_wakeup_cb     (void *aptr);
+
+/* ------------------------------------------------------------------------- *
+ * CLOCK_TRACKING
+ * ------------------------------------------------------------------------- */
+
+static bool     background_activity_clockwatch_arm          (int fd);
+static gboolean background_activity_clockwatch_cb           (GIOChannel *chn, GIOCondition cnd, gpointer aptr);
+static void     background_activity_clockwatch_start_locked (background_activity_t *self);
+static void     background_activity_clockwatch_stop_locked  (background_activity_t *self);
 
 /* ------------------------------------------------------------------------- *
  * EXTERNAL_API
@@ -209,10 +247,13 @@ background_activity_frequency_t  background_activity_get_wakeup_slot     (backgr
 void                             background_activity_set_wakeup_slot     (background_activity_t *self, background_activity_frequency_t slot);
 void                             background_activity_get_wakeup_range    (background_activity_t *self, int *range_lo, int *range_hi);
 void                             background_activity_set_wakeup_range    (background_activity_t *self, int range_lo, int range_hi);
+void                             background_activity_set_wakeup_deadline (background_activity_t *self, background_activity_clock_t clock, time_t lo_deadline, time_t hi_deadline);
+bool                             background_activity_get_wakeup_deadline (background_activity_t *self, background_activity_clock_t *clock, time_t *lo_deadline, time_t *hi_deadline);
 bool                             background_activity_is_waiting          (background_activity_t *self);
 bool                             background_activity_is_running          (background_activity_t *self);
 bool                             background_activity_is_stopped          (background_activity_t *self);
 void                             background_activity_wait                (background_activity_t *self);
+void                             background_activity_wait_until          (background_activity_t *self, background_activity_clock_t clock, time_t lo_deadline, time_t hi_deadline);
 void                             background_activity_run                 (background_activity_t *self);
 void                             background_activity_stop                (background_activity_t *self);
 const char                      *background_activity_get_id              (const background_activity_t *self);
@@ -222,6 +263,11 @@ void                             background_activity_set_user_data       (backgr
 void                             background_activity_set_running_callback(background_activity_t *self, background_activity_event_fn cb);
 void                             background_activity_set_waiting_callback(background_activity_t *self, background_activity_event_fn cb);
 void                             background_activity_set_stopped_callback(background_activity_t *self, background_activity_event_fn cb);
+void                             background_activity_set_run_budget      (background_activity_t *self, int seconds, background_activity_overrun_t action);
+int                              background_activity_get_run_budget      (background_activity_t *self);
+void                             background_activity_set_overrun_callback(background_activity_t *self, background_activity_event_fn cb);
+unsigned                         background_activity_get_overrun_count   (background_activity_t *self);
+bool                             background_activity_get_accounting      (background_activity_t *self, keepalive_accounting_t *acc);
 
 /* ========================================================================= *
  * BACKGROUND_ACTIVITY_STATE
@@ -240,82 +286,6 @@ background_activity_state_repr(background_activity_state_t state)
     return res;
 }
 
-/* ========================================================================= *
- * WAKEUP_DELAY
- * ========================================================================= */
-
-/** Default initial wakeup delay */
-static const wakeup_delay_t wakeup_delay_default =
-{
-    .wd_slot     = BACKGROUND_ACTIVITY_FREQUENCY_ONE_HOUR,
-    .wd_range_lo = BACKGROUND_ACTIVITY_FREQUENCY_ONE_HOUR,
-    .wd_range_hi = BACKGROUND_ACTIVITY_FREQUENCY_ONE_HOUR,
-};
-
-/** Set wakeup delay to use global wakeup slot
- *
- * @param self  wake up delay object
- * @param slot  global wakeup slot to use
- */
-static void
-wakeup_delay_set_slot(wakeup_delay_t *self,
-                      background_activity_frequency_t slot)
-{
-    // basically it is just a second count, but it must be
-
-    // a) not smaller than the smallest allowed global slot
-
-    if( slot < BACKGROUND_ACTIVITY_FREQUENCY_THIRTY_SECONDS )
-        slot = BACKGROUND_ACTIVITY_FREQUENCY_THIRTY_SECONDS;
-
-    // b) evenly divisible by the smallest allowed global slot
-
-    slot = slot - (slot % BACKGROUND_ACTIVITY_FREQUENCY_THIRTY_SECONDS);
-
-    self->wd_slot     = slot;
-    self->wd_range_lo = slot;
-    self->wd_range_hi = slot;
-}
-
-/** Set wakeup delay to use wakeup range
- *
- * @param self      wake up delay object
- * @param range_lo  minimum seconds to wait
- * @param range_hi  maximum seconds to wait
- */
-static void
-wakeup_delay_set_range(wakeup_delay_t *self,
-                       int range_lo, int range_hi)
-{
-    /* Currently there is no way to tell what kind of hw watchdog
-     * kicking period DSME is using - assume that it is 12 seconds */
-    const int heartbeat_period = 12;
-
-    /* Zero wait is not supported */
-    if( range_lo < 1 )
-        range_lo = 1;
-
-    /* Expand invalid range to heartbeat length */
-    if( range_hi <= range_lo )
-        range_hi = range_lo + heartbeat_period;
-
-    self->wd_slot     = BACKGROUND_ACTIVITY_FREQUENCY_RANGE;
-    self->wd_range_lo = range_lo;
-    self->wd_range_hi = range_hi;
-}
-
-/** Predicate for: two wake up delay objects are the same
- *
- * @param self      wake up delay object
- */
-static bool
-wakeup_delay_eq_p(const wakeup_delay_t *self, const wakeup_delay_t *that)
-{
-    return (self->wd_slot     == that->wd_slot     &&
-            self->wd_range_lo == that->wd_range_lo &&
-            self->wd_range_hi == that->wd_range_hi);
-}
-
 /* ========================================================================= *
  * OBJECT_LIFETIME
  * ========================================================================= */
@@ -389,6 +359,14 @@ background_activity_ctor(background_activity_t *self)
     self->bga_running_cb = 0;
     self->bga_waiting_cb = 0;
     self->bga_stopped_cb = 0;
+    self->bga_overrun_cb = 0;
+
+    /* Running state duration is not limited */
+    self->bga_run_budget     = 0;
+    self->bga_overrun_action = BACKGROUND_ACTIVITY_OVERRUN_STOP;
+    self->bga_overrun_count  = 0;
+    self->bga_run_budget_id  = 0;
+    self->bga_run_generation = 0;
 
     /* Heartbeat object for waking up */
     self->bga_heartbeat  = heartbeat_new();
@@ -399,6 +377,15 @@ background_activity_ctor(background_activity_t *self)
     /* Keepalive object for staying up */
     self->bga_keepalive  = cpukeepalive_new();
 
+    /* No system time change tracking */
+    self->bga_clockwatch_fd = -1;
+    self->bga_clockwatch_id = 0;
+
+    /* Accounted using the same id as the keepalive object */
+    accounting_ctor(&self->bga_accounting, "bg-activity",
+                    cpukeepalive_get_id(self->bga_keepalive));
+    heartbeat_set_accounting(self->bga_heartbeat, &self->bga_accounting);
+
     log_debug(PFIX"(%s): created", background_activity_get_id(self));
 }
 
@@ -415,6 +402,7 @@ background_activity_shutdown_locked_cb(gpointer aptr)
 
     /* Detach heartbeat object */
     heartbeat_set_notify(self->bga_heartbeat, 0, 0, 0);
+    heartbeat_set_accounting(self->bga_heartbeat, 0);
     heartbeat_unref(self->bga_heartbeat),
         self->bga_heartbeat = 0;
 
@@ -422,8 +410,14 @@ background_activity_shutdown_locked_cb(gpointer aptr)
     cpukeepalive_unref(self->bga_keepalive),
         self->bga_keepalive = 0;
 
+    /* Stop system time change tracking */
+    background_activity_clockwatch_stop_locked(self);
+
     /* Cancel state notify */
     background_activity_timer_stop_locked(self, &self->bga_report_state_id);
+
+    /* Cancel running state budget */
+    background_activity_timer_stop_locked(self, &self->bga_run_budget_id);
 }
 
 /** Callback for handling keepalive_object_t delete
@@ -455,6 +449,9 @@ background_activity_dtor(background_activity_t *self)
     self->bga_majick = BACKGROUND_ACTIVITY_MAJICK_DEAD;
     keepalive_object_dtor(&self->bga_object);
 
+    /* Fold accounting data into process totals */
+    accounting_dtor(&self->bga_accounting);
+
     /* Destroy notification */
     if( self->bga_user_free )
         self->bga_user_free(self->bga_user_data);
@@ -556,6 +553,28 @@ background_activity_in_shutdown_locked(background_activity_t *self)
     return keepalive_object_in_shutdown_locked(&self->bga_object);
 }
 
+/* ========================================================================= *
+ * OBJECT_IOWATCHES
+ * ========================================================================= */
+
+static void
+background_activity_iowatch_start_locked(background_activity_t *self,
+                                         guint *iowatch_id, int fd,
+                                         GIOCondition cnd, GIOFunc io_cb)
+{
+    log_function("%p", self);
+    keepalive_object_iowatch_start_locked(&self->bga_object, iowatch_id,
+                                          fd, cnd, io_cb);
+}
+
+static void
+background_activity_iowatch_stop_locked(background_activity_t *self,
+                                        guint *iowatch_id)
+{
+    log_function("%p", self);
+    keepalive_object_iowatch_stop_locked(&self->bga_object, iowatch_id);
+}
+
 /* ========================================================================= *
  * OBJECT_TIMERS
  * ========================================================================= */
@@ -712,12 +731,15 @@ background_activity_set_state_locked(background_activity_t *self,
     case BACKGROUND_ACTIVITY_STATE_WAITING:
         /* heartbeat timer can be cancelled before state transition */
         heartbeat_stop(self->bga_heartbeat);
+        background_activity_clockwatch_stop_locked(self);
         break;
 
     case BACKGROUND_ACTIVITY_STATE_RUNNING:
         /* keepalive timer is cancelled after state transition
          * is completed in background_activity_report_state_cb().
          */
+        background_activity_timer_stop_locked(self, &self->bga_run_budget_id);
+        accounting_run_end(&self->bga_accounting);
         break;
     }
 
@@ -727,17 +749,22 @@ background_activity_set_state_locked(background_activity_t *self,
         break;
 
     case BACKGROUND_ACTIVITY_STATE_WAITING:
-        heartbeat_set_delay(self->bga_heartbeat,
-                            self->bga_wakeup_curr.wd_range_lo,
-                            self->bga_wakeup_curr.wd_range_hi);
+        background_activity_heartbeat_program_locked(self);
 
-        self->bga_wakeup_last = self->bga_wakeup_curr;
-
-        heartbeat_start(self->bga_heartbeat);
+        if( self->bga_wakeup_curr.wd_absolute &&
+            self->bga_wakeup_curr.wd_clock == BACKGROUND_ACTIVITY_CLOCK_REALTIME )
+            background_activity_clockwatch_start_locked(self);
         break;
 
     case BACKGROUND_ACTIVITY_STATE_RUNNING:
+        self->bga_run_generation += 1;
+        accounting_run_begin(&self->bga_accounting);
         cpukeepalive_start(self->bga_keepalive);
+
+        if( self->bga_run_budget > 0 )
+            background_activity_timer_start_locked(self, &self->bga_run_budget_id,
+                                                   self->bga_run_budget * 1000,
+                                                   background_activity_run_budget_cb);
         break;
     }
 
@@ -783,10 +810,95 @@ background_activity_in_state_locked(const background_activity_t *self,
     return background_activity_get_state_locked(self) == state;
 }
 
+/** Handle running state budget overrun
+ *
+ * @param aptr background activity object as void pointer
+ *
+ * @return G_SOURCE_REMOVE
+ */
+static gboolean
+background_activity_run_budget_cb(gpointer aptr)
+{
+    background_activity_t *self = aptr;
+
+    log_function("%p", self);
+
+    bool locked = false;
+    background_activity_set_lock(self, &locked, true);
+
+    background_activity_event_fn  func    = 0;
+    void                         *data    = self->bga_user_data;
+    bool                          overrun = false;
+    unsigned                      run_gen = self->bga_run_generation;
+
+    /* Skip if timer ought to be inactive */
+    if( !self->bga_run_budget_id )
+        goto cleanup;
+
+    self->bga_run_budget_id = 0;
+
+    /* Skip if already shutting down */
+    if( background_activity_in_shutdown_locked(self) )
+        goto cleanup;
+
+    if( !background_activity_in_state_locked(self, BACKGROUND_ACTIVITY_STATE_RUNNING) )
+        goto cleanup;
+
+    overrun = true;
+    self->bga_overrun_count += 1;
+    func = self->bga_overrun_cb;
+
+    log_warning(PFIX"(%s): running state exceeded %d second budget; overrun #%u",
+                background_activity_get_id(self),
+                self->bga_run_budget, self->bga_overrun_count);
+
+cleanup:
+
+    /* To avoid deadlocks, notify in unlocked state */
+    if( func ) {
+        background_activity_set_lock(self, &locked, false);
+        func(self, data);
+        background_activity_set_lock(self, &locked, true);
+    }
+
+    /* Terminate running state unless callback already did it, or
+     * left it and then started a new running period */
+    if( overrun && run_gen == self->bga_run_generation &&
+        background_activity_in_state_locked(self, BACKGROUND_ACTIVITY_STATE_RUNNING) ) {
+        if( self->bga_overrun_action == BACKGROUND_ACTIVITY_OVERRUN_WAIT )
+            background_activity_set_state_locked(self, BACKGROUND_ACTIVITY_STATE_WAITING);
+        else
+            background_activity_set_state_locked(self, BACKGROUND_ACTIVITY_STATE_STOPPED);
+    }
+
+    background_activity_set_lock(self, &locked, false);
+    return G_SOURCE_REMOVE;
+}
+
 /* ========================================================================= *
  * HEARTBEAT_WAKEUP
  * ========================================================================= */
 
+/** Program IPHB wakeup according to requested wakeup slot/range
+ *
+ * @param self  background activity object pointer
+ */
+static void
+background_activity_heartbeat_program_locked(background_activity_t *self)
+{
+    /* Absolute deadlines are converted to relative
+     * range at the time the wait is programmed */
+    wakeup_delay_evaluate(&self->bga_wakeup_curr);
+
+    heartbeat_set_delay(self->bga_heartbeat,
+                        self->bga_wakeup_curr.wd_range_lo,
+                        self->bga_wakeup_curr.wd_range_hi);
+
+    self->bga_wakeup_last = self->bga_wakeup_curr;
+
+    heartbeat_start(self->bga_heartbeat);
+}
+
 /** Handle heartbeat wakeup
  *
  * @param aptr background activity object as void pointer
@@ -798,12 +910,181 @@ background_activity_heartbeat_wakeup_cb(void *aptr)
 
     if( background_activity_validate_and_lock(self) ) {
         log_notice(PFIX"(%s): iphb wakeup", background_activity_get_id(self));
-        if( background_activity_in_state_locked(self, BACKGROUND_ACTIVITY_STATE_WAITING) )
+        if( background_activity_in_state_locked(self, BACKGROUND_ACTIVITY_STATE_WAITING) ) {
+            accounting_wakeup(&self->bga_accounting);
             background_activity_set_state_locked(self, BACKGROUND_ACTIVITY_STATE_RUNNING);
+        }
         background_activity_unlock(self);
     }
 }
 
+/* ========================================================================= *
+ * CLOCK_TRACKING
+ * ========================================================================= */
+
+/** Arm timerfd so that it gets canceled on system time changes
+ *
+ * @param fd  CLOCK_REALTIME timerfd
+ *
+ * @return true on success, false otherwise
+ */
+static bool
+background_activity_clockwatch_arm(int fd)
+{
+    struct itimerspec its;
+
+    memset(&its, 0, sizeof its);
+    its.it_value.tv_sec = (wakeup_delay_clock_now(BACKGROUND_ACTIVITY_CLOCK_REALTIME) +
+                           BACKGROUND_ACTIVITY_CLOCKWATCH_PERIOD);
+
+    if( timerfd_settime(fd, TFD_TIMER_ABSTIME | TFD_TIMER_CANCEL_ON_SET,
+                        &its, 0) == -1 ) {
+        log_warning(PFIX": timerfd_settime: %m");
+        return false;
+    }
+
+    return true;
+}
+
+/** Handle system time change notification
+ *
+ * @param chn   io channel for timerfd
+ * @param cnd   io condition
+ * @param aptr  background activity object as void pointer
+ *
+ * @return TRUE to keep io watch alive, or FALSE to remove it
+ */
+static gboolean
+background_activity_clockwatch_cb(GIOChannel *chn, GIOCondition cnd,
+                                  gpointer aptr)
+{
+    gboolean               keep_going = FALSE;
+    background_activity_t *self       = aptr;
+
+    log_function("%p", self);
+
+    background_activity_lock(self);
+
+    if( !self->bga_clockwatch_id ) {
+        /* Watch id was cleared but callback function still got executed
+         * -> assume some sort of glib remove vs dispatch glitch. */
+        log_warning(PFIX"(%s): stray clock change - no watch id",
+                    background_activity_get_id(self));
+        goto bailout;
+    }
+
+    if( background_activity_in_shutdown_locked(self) )
+        goto cleanup;
+
+    if( cnd & ~G_IO_IN )
+        goto cleanup;
+
+    int      fd  = g_io_channel_unix_get_fd(chn);
+    uint64_t cnt = 0;
+    bool     changed = false;
+
+    if( read(fd, &cnt, sizeof cnt) == -1 ) {
+        if( errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK ) {
+            keep_going = TRUE;
+            goto cleanup;
+        }
+
+        if( errno != ECANCELED ) {
+            log_error(PFIX"(%s): timerfd read error: %m",
+                      background_activity_get_id(self));
+            goto cleanup;
+        }
+
+        changed = true;
+    }
+
+    /* Canceled and expired timers alike need to be re-armed */
+    if( !background_activity_clockwatch_arm(fd) )
+        goto cleanup;
+
+    keep_going = TRUE;
+
+    if( !changed )
+        goto cleanup;
+
+    if( !background_activity_in_state_locked(self, BACKGROUND_ACTIVITY_STATE_WAITING) )
+        goto cleanup;
+
+    log_notice(PFIX"(%s): system time changed; reprogram wakeup",
+               background_activity_get_id(self));
+
+    heartbeat_stop(self->bga_heartbeat);
+    background_activity_heartbeat_program_locked(self);
+
+cleanup:
+    if( !keep_going ) {
+        self->bga_clockwatch_id = 0;
+        if( self->bga_clockwatch_fd != -1 )
+            close(self->bga_clockwatch_fd), self->bga_clockwatch_fd = -1;
+    }
+
+bailout:
+    background_activity_unlock(self);
+
+    return keep_going;
+}
+
+/** Start tracking system time changes
+ *
+ * @param self  background activity object pointer
+ */
+static void
+background_activity_clockwatch_start_locked(background_activity_t *self)
+{
+    int fd = -1;
+
+    if( self->bga_clockwatch_id )
+        goto cleanup;
+
+    if( background_activity_in_shutdown_locked(self) )
+        goto cleanup;
+
+    log_function("%p", self);
+
+    if( (fd = timerfd_create(CLOCK_REALTIME, TFD_CLOEXEC | TFD_NONBLOCK)) == -1 ) {
+        log_warning(PFIX"(%s): timerfd_create: %m",
+                    background_activity_get_id(self));
+        goto cleanup;
+    }
+
+    if( !background_activity_clockwatch_arm(fd) )
+        goto cleanup;
+
+    background_activity_iowatch_start_locked(self, &self->bga_clockwatch_id,
+                                             fd, G_IO_IN,
+                                             background_activity_clockwatch_cb);
+    if( !self->bga_clockwatch_id )
+        goto cleanup;
+
+    /* background_activity_t owns the fd */
+    self->bga_clockwatch_fd = fd, fd = -1;
+
+cleanup:
+    if( fd != -1 )
+        close(fd);
+}
+
+/** Stop tracking system time changes
+ *
+ * @param self  background activity object pointer
+ */
+static void
+background_activity_clockwatch_stop_locked(background_activity_t *self)
+{
+    background_activity_iowatch_stop_locked(self, &self->bga_clockwatch_id);
+
+    if( self->bga_clockwatch_fd != -1 ) {
+        log_function("%p", self);
+        close(self->bga_clockwatch_fd),
+            self->bga_clockwatch_fd = -1;
+    }
+}
+
 /* ========================================================================= *
  * EXTERNAL_API  --  documented in: keepalive-backgroundactivity.h
  * ========================================================================= */
@@ -894,6 +1175,7 @@ background_activity_get_wakeup_range(background_activity_t *self,
 {
     log_function("APICALL %p", self);
     if( background_activity_validate_and_lock(self) ) {
+        wakeup_delay_evaluate(&self->bga_wakeup_curr);
         *range_lo = self->bga_wakeup_curr.wd_range_lo;
         *range_hi = self->bga_wakeup_curr.wd_range_hi;
         background_activity_unlock(self);
@@ -915,6 +1197,39 @@ background_activity_set_wakeup_range(background_activity_t *self,
     }
 }
 
+void
+background_activity_set_wakeup_deadline(background_activity_t *self,
+                                        background_activity_clock_t clock,
+                                        time_t lo_deadline,
+                                        time_t hi_deadline)
+{
+    log_function("APICALL %p", self);
+    if( background_activity_validate_and_lock(self) ) {
+        wakeup_delay_set_deadline(&self->bga_wakeup_curr, clock,
+                                  lo_deadline, hi_deadline);
+        background_activity_unlock(self);
+    }
+}
+
+bool
+background_activity_get_wakeup_deadline(background_activity_t *self,
+                                        background_activity_clock_t *clock,
+                                        time_t *lo_deadline,
+                                        time_t *hi_deadline)
+{
+    log_function("APICALL %p", self);
+    bool absolute = false;
+    if( background_activity_validate_and_lock(self) ) {
+        if( (absolute = self->bga_wakeup_curr.wd_absolute) ) {
+            *clock       = self->bga_wakeup_curr.wd_clock;
+            *lo_deadline = self->bga_wakeup_curr.wd_deadline_lo;
+            *hi_deadline = self->bga_wakeup_curr.wd_deadline_hi;
+        }
+        background_activity_unlock(self);
+    }
+    return absolute;
+}
+
 bool
 background_activity_is_waiting(background_activity_t *self)
 {
@@ -947,6 +1262,21 @@ background_activity_wait(background_activity_t *self)
     background_activity_set_state(self, BACKGROUND_ACTIVITY_STATE_WAITING);
 }
 
+void
+background_activity_wait_until(background_activity_t *self,
+                               background_activity_clock_t clock,
+                               time_t lo_deadline,
+                               time_t hi_deadline)
+{
+    log_function("APICALL %p", self);
+    if( background_activity_validate_and_lock(self) ) {
+        wakeup_delay_set_deadline(&self->bga_wakeup_curr, clock,
+                                  lo_deadline, hi_deadline);
+        background_activity_set_state_locked(self, BACKGROUND_ACTIVITY_STATE_WAITING);
+        background_activity_unlock(self);
+    }
+}
+
 void
 background_activity_run(background_activity_t *self)
 {
@@ -1054,3 +1384,63 @@ background_activity_set_stopped_callback(background_activity_t *self,
         background_activity_unlock(self);
     }
 }
+
+void
+background_activity_set_run_budget(background_activity_t *self,
+                                   int seconds,
+                                   background_activity_overrun_t action)
+{
+    log_function("APICALL %p", self);
+    if( background_activity_validate_and_lock(self) ) {
+        self->bga_run_budget     = seconds > 0 ? seconds : 0;
+        self->bga_overrun_action = action;
+        background_activity_unlock(self);
+    }
+}
+
+int
+background_activity_get_run_budget(background_activity_t *self)
+{
+    int seconds = 0;
+    if( background_activity_validate_and_lock(self) ) {
+        seconds = self->bga_run_budget;
+        background_activity_unlock(self);
+    }
+    return seconds;
+}
+
+void
+background_activity_set_overrun_callback(background_activity_t *self,
+                                         background_activity_event_fn cb)
+{
+    if( background_activity_validate_and_lock(self) ) {
+        self->bga_overrun_cb = cb;
+        background_activity_unlock(self);
+    }
+}
+
+unsigned
+background_activity_get_overrun_count(background_activity_t *self)
+{
+    unsigned count = 0;
+    if( background_activity_validate_and_lock(self) ) {
+        count = self->bga_overrun_count;
+        background_activity_unlock(self);
+    }
+    return count;
+}
+
+bool
+background_activity_get_accounting(background_activity_t *self,
+                                   keepalive_accounting_t *acc)
+{
+    bool ack = false;
+
+    if( background_activity_validate_and_lock(self) ) {
+        accounting_get(&self->bga_accounting, acc);
+        ack = true;
+        background_activity_unlock(self);
+    }
+
+    return ack;
+}
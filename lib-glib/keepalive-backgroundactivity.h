@@ -35,7 +35,10 @@
 #ifndef KEEPALIVE_GLIB_BACKGROUNDACTIVITY_H_
 # define KEEPALIVE_GLIB_BACKGROUNDACTIVITY_H_
 
+# include "keepalive-accounting.h"
+
 # include <stdbool.h>
+# include <time.h>
 
 # ifdef __cplusplus
 extern "C" {
@@ -112,6 +115,37 @@ typedef enum
 
 } background_activity_frequency_t;
 
+/** Enumeration of clocks that can be used for absolute wakeup deadlines
+ *
+ * @sa background_activity_set_wakeup_deadline()
+ */
+typedef enum
+{
+    /** Seconds since boot, including time spent in suspend (CLOCK_BOOTTIME) */
+    BACKGROUND_ACTIVITY_CLOCK_BOOTTIME = 0,
+
+    /** Wall clock seconds since epoch (CLOCK_REALTIME)
+     *
+     * System time changes are tracked while waiting and the
+     * wakeup is reprogrammed to match the adjusted clock. */
+    BACKGROUND_ACTIVITY_CLOCK_REALTIME = 1,
+
+} background_activity_clock_t;
+
+/** Enumeration of actions taken when running state exceeds its budget
+ *
+ * @sa background_activity_set_run_budget()
+ */
+typedef enum
+{
+    /** Make transition to stopped state */
+    BACKGROUND_ACTIVITY_OVERRUN_STOP = 0,
+
+    /** Make transition to waiting state using current wakeup slot/range */
+    BACKGROUND_ACTIVITY_OVERRUN_WAIT = 1,
+
+} background_activity_overrun_t;
+
 /** Create background activity object
  *
  * Initially has reference count of 1.
@@ -225,6 +259,53 @@ void background_activity_set_wakeup_range(background_activity_t *self, int range
 void background_activity_get_wakeup_range(background_activity_t *self,
                                           int *range_lo, int *range_hi);
 
+/** Set absolute wakeup deadline for background activity object
+ *
+ * Instead of relative wait lengths, the wakeup is defined as a
+ * window of absolute clock time. The relative IPHB wakeup range is
+ * evaluated when the object enters waiting state, so repeatedly
+ * requesting the same deadline while already waiting does not cause
+ * reprogramming IPC.
+ *
+ * Deadlines that are already in the past lead to wakeup as soon
+ * as possible. If hi_deadline is not larger than lo_deadline, the
+ * window is expanded to heartbeat delay length.
+ *
+ * When BACKGROUND_ACTIVITY_CLOCK_REALTIME is used, changes to system
+ * time are tracked while waiting and the IPHB wakeup is reprogrammed
+ * so that it still happens at the requested wall clock time.
+ *
+ * Calling background_activity_set_wakeup_slot() or
+ * background_activity_set_wakeup_range() switches back to
+ * relative wakeups.
+ *
+ * @param self         background activity object pointer
+ * @param clock        clock the deadlines are expressed in
+ * @param lo_deadline  earliest wakeup time in seconds
+ * @param hi_deadline  latest wakeup time in seconds
+ *
+ * @sa background_activity_wait_until()
+ */
+void background_activity_set_wakeup_deadline(background_activity_t *self,
+                                             background_activity_clock_t clock,
+                                             time_t lo_deadline,
+                                             time_t hi_deadline);
+
+/** Get absolute wakeup deadline used by background activity object
+ *
+ * @param self         background activity object pointer
+ * @param clock        [output] clock the deadlines are expressed in
+ * @param lo_deadline  [output] earliest wakeup time in seconds
+ * @param hi_deadline  [output] latest wakeup time in seconds
+ *
+ * @return true if absolute deadline is in use, false if relative
+ *         slot or range is used (outputs are left untouched)
+ */
+bool background_activity_get_wakeup_deadline(background_activity_t *self,
+                                             background_activity_clock_t *clock,
+                                             time_t *lo_deadline,
+                                             time_t *hi_deadline);
+
 /** Check if background activity object is in stopped state
  *
  * Stopped state means the object is not waiting for IPHB
@@ -267,6 +348,21 @@ bool background_activity_is_running(background_activity_t *self);
  */
 void background_activity_wait(background_activity_t *self);
 
+/** Set background activity object to wait until absolute deadline
+ *
+ * Shorthand for background_activity_set_wakeup_deadline()
+ * followed by background_activity_wait().
+ *
+ * @param self         background activity object pointer
+ * @param clock        clock the deadlines are expressed in
+ * @param lo_deadline  earliest wakeup time in seconds
+ * @param hi_deadline  latest wakeup time in seconds
+ */
+void background_activity_wait_until(background_activity_t *self,
+                                    background_activity_clock_t clock,
+                                    time_t lo_deadline,
+                                    time_t hi_deadline);
+
 /** Set background activity object to running state
  *
  * CPU-keepalive session is started and device is blocked from
@@ -382,6 +478,72 @@ void background_activity_set_waiting_callback(background_activity_t *self,
  */
 void background_activity_set_stopped_callback(background_activity_t *self,
                                               background_activity_event_fn cb);
+
+/** Set maximum time background activity object can stay in running state
+ *
+ * Running state that is not terminated by the application within the
+ * given budget is considered an overrun: a warning is logged, overrun
+ * callback is notified and overrun counter is incremented. If the
+ * object is still in running state after overrun callback returns,
+ * transition to stopped or waiting state is made as specified by the
+ * action parameter.
+ *
+ * Changes take effect when the object enters running state.
+ *
+ * @param self     background activity object pointer
+ * @param seconds  maximum running state duration, or 0 to disable
+ * @param action   BACKGROUND_ACTIVITY_OVERRUN_STOP|WAIT
+ */
+void background_activity_set_run_budget(background_activity_t *self,
+                                        int seconds,
+                                        background_activity_overrun_t action);
+
+/** Get maximum time background activity object can stay in running state
+ *
+ * @param self  background activity object pointer
+ *
+ * @return running state budget in seconds, or 0 if not limited
+ */
+int background_activity_get_run_budget(background_activity_t *self);
+
+/** Set notification function to be called on running state overrun
+ *
+ * The callback can terminate the running state itself, for example
+ * by calling background_activity_wait() with adjusted wakeup range.
+ *
+ * @param self  background activity object pointer
+ * @param cb    callback function pointer, or NULL
+ *
+ * @sa background_activity_set_run_budget()
+ */
+void background_activity_set_overrun_callback(background_activity_t *self,
+                                              background_activity_event_fn cb);
+
+/** Get number of running state budget overruns
+ *
+ * @param self  background activity object pointer
+ *
+ * @return number of times running state budget has been exceeded
+ */
+unsigned background_activity_get_overrun_count(background_activity_t *self);
+
+/** Get power accounting data for background activity object
+ *
+ * Wakeups are IPHB wakeups, runs are running state periods and
+ * IPC messages are IPHB requests made while entering and leaving
+ * waiting state.
+ *
+ * CPU-keepalive sessions used for staying in running state are
+ * accounted separately under "cpukeepalive" kind using the same
+ * id string, see keepalive_accounting_snapshot().
+ *
+ * @param self  background activity object pointer
+ * @param acc   [output] accounting data
+ *
+ * @return true on success, or false if object is not valid
+ */
+bool background_activity_get_accounting(background_activity_t *self,
+                                        keepalive_accounting_t *acc);
 # pragma GCC visibility pop
 
 # ifdef __cplusplus
@@ -29,6 +29,8 @@
 
 #include "keepalive-cpukeepalive.h"
 #include "keepalive-object.h"
+#include "accounting.h"
+#include "sharedkeepalive.h"
 
 #include "xdbus.h"
 #include "logging.h"
@@ -124,6 +126,15 @@ struct cpukeepalive_t
     /** Timer id for delayed session rething */
     guint            cka_delayed_rethink_id;
 
+    /** Power accounting data */
+    accounting_t     cka_accounting;
+
+    /** Monotonic time of pending start request [ms], or -1 */
+    int64_t          cka_start_requested_ms;
+
+    /** Instrumentation data */
+    cpukeepalive_stats_t cka_stats;
+
     // NOTE: cpukeepalive_ctor & cpukeepalive_dtor
 };
 
@@ -236,6 +247,11 @@ void            cpukeepalive_unref (cpukeepalive_t *self);
 void            cpukeepalive_start (cpukeepalive_t *self);
 void            cpukeepalive_stop  (cpukeepalive_t *self);
 const char     *cpukeepalive_get_id(const cpukeepalive_t *self);
+bool            cpukeepalive_get_accounting(cpukeepalive_t *self, keepalive_accounting_t *acc);
+bool            cpukeepalive_get_stats     (cpukeepalive_t *self, cpukeepalive_stats_t *stats);
+void            cpukeepalive_shared_acquire(void);
+void            cpukeepalive_shared_release(void);
+unsigned        cpukeepalive_shared_holders(void);
 
 /* ========================================================================= *
  * HAXOR
@@ -306,11 +322,18 @@ cpukeepalive_ctor(cpukeepalive_t *self)
 
     /* Assign unique (within process) id for use with MCE D-Bus IPC */
     self->cka_id = cpukeepalive_generate_id();
+    accounting_ctor(&self->cka_accounting, "cpukeepalive", self->cka_id);
 
     /* Session neither requested nor running */
     self->cka_requested = false;
     self->cka_session_renew_id = 0;
 
+    /* No sessions to instrument yet */
+    self->cka_start_requested_ms = -1;
+    self->cka_stats.cks_renewals = 0;
+    self->cka_stats.cks_start_latency_ms = -1;
+    self->cka_stats.cks_start_latency_max_ms = -1;
+
     /* No system bus connection */
     self->cka_connect_attempted = false;
     self->cka_systembus = 0;
@@ -389,6 +412,9 @@ cpukeepalive_dtor(cpukeepalive_t *self)
 
     log_function("%p", self);
 
+    /* Fold accounting data into process totals */
+    accounting_dtor(&self->cka_accounting);
+
     /* Free id string */
     free(self->cka_id),
         self->cka_id = 0;
@@ -525,6 +551,9 @@ cpukeepalive_ipc_start_locked(cpukeepalive_t *self,
                                          self->cka_systembus, service, object,
                                          interface, method, arg_type, va);
     va_end(va);
+
+    if( *where )
+        accounting_ipc(&self->cka_accounting);
 }
 
 static void
@@ -668,13 +697,14 @@ cpukeepalive_session_ipc_locked(cpukeepalive_t *self, const char *method)
 
     if( xdbus_connection_is_valid(self->cka_systembus) ) {
         const char *arg = cpukeepalive_get_id_locked(self);
-        xdbus_simple_call(self->cka_systembus,
-                          MCE_SERVICE,
-                          MCE_REQUEST_PATH,
-                          MCE_REQUEST_IF,
-                          method,
-                          DBUS_TYPE_STRING, &arg,
-                          DBUS_TYPE_INVALID);
+        if( xdbus_simple_call(self->cka_systembus,
+                              MCE_SERVICE,
+                              MCE_REQUEST_PATH,
+                              MCE_REQUEST_IF,
+                              method,
+                              DBUS_TYPE_STRING, &arg,
+                              DBUS_TYPE_INVALID) )
+            accounting_ipc(&self->cka_accounting);
 
         /* We need to make sure these method call messages are
          * actually sent as soon as possible.
@@ -705,6 +735,7 @@ cpukeepalive_session_renew_cb(gpointer aptr)
     cpukeepalive_lock(self);
 
     if( self->cka_session_renew_id ) {
+        self->cka_stats.cks_renewals += 1;
         cpukeepalive_session_ipc_locked(self, MCE_CPU_KEEPALIVE_START_REQ);
         result = G_SOURCE_CONTINUE;
     }
@@ -725,6 +756,16 @@ cpukeepalive_session_start_locked(cpukeepalive_t *self)
 
     log_function("%p", self);
 
+    accounting_run_begin(&self->cka_accounting);
+
+    if( self->cka_start_requested_ms >= 0 ) {
+        int64_t latency = g_get_monotonic_time() / 1000 - self->cka_start_requested_ms;
+        self->cka_start_requested_ms = -1;
+        self->cka_stats.cks_start_latency_ms = latency;
+        if( self->cka_stats.cks_start_latency_max_ms < latency )
+            self->cka_stats.cks_start_latency_max_ms = latency;
+    }
+
     cpukeepalive_session_ipc_locked(self, MCE_CPU_KEEPALIVE_START_REQ);
 
     cpukeepalive_timer_start_locked(self, &self->cka_session_renew_id,
@@ -769,6 +810,8 @@ cpukeepalive_session_stop_locked(cpukeepalive_t *self)
 
     cpukeepalive_session_ipc_locked(self, MCE_CPU_KEEPALIVE_STOP_REQ);
 
+    accounting_run_end(&self->cka_accounting);
+
 cleanup:
     return;
 }
@@ -1243,6 +1286,8 @@ cpukeepalive_start(cpukeepalive_t *self)
     if( cpukeepalive_validate_and_lock(self) ) {
         if( !self->cka_requested ) {
             self->cka_requested = true;
+            if( !self->cka_session_renew_id )
+                self->cka_start_requested_ms = g_get_monotonic_time() / 1000;
             cpukeepalive_rethink_schedule_locked(self);
         }
         cpukeepalive_unlock(self);
@@ -1257,6 +1302,7 @@ cpukeepalive_stop(cpukeepalive_t *self)
     if( cpukeepalive_validate_and_lock(self) ) {
         if( self->cka_requested ) {
             self->cka_requested = false;
+            self->cka_start_requested_ms = -1;
             cpukeepalive_rethink_schedule_locked(self);
         }
         cpukeepalive_unlock(self);
@@ -1278,3 +1324,49 @@ cpukeepalive_get_id(const cpukeepalive_t *self)
 
     return id;
 }
+
+bool
+cpukeepalive_get_accounting(cpukeepalive_t *self, keepalive_accounting_t *acc)
+{
+    bool ack = false;
+
+    if( cpukeepalive_validate_and_lock(self) ) {
+        accounting_get(&self->cka_accounting, acc);
+        ack = true;
+        cpukeepalive_unlock(self);
+    }
+
+    return ack;
+}
+
+bool
+cpukeepalive_get_stats(cpukeepalive_t *self, cpukeepalive_stats_t *stats)
+{
+    bool ack = false;
+
+    if( cpukeepalive_validate_and_lock(self) ) {
+        *stats = self->cka_stats;
+        ack = true;
+        cpukeepalive_unlock(self);
+    }
+
+    return ack;
+}
+
+void
+cpukeepalive_shared_acquire(void)
+{
+    sharedkeepalive_acquire();
+}
+
+void
+cpukeepalive_shared_release(void)
+{
+    sharedkeepalive_release();
+}
+
+unsigned
+cpukeepalive_shared_holders(void)
+{
+    return sharedkeepalive_get_holders();
+}
@@ -34,6 +34,10 @@
 #ifndef KEEPALIVE_GLIB_CPUKEEPALIVE_H_
 # define KEEPALIVE_GLIB_CPUKEEPALIVE_H_
 
+# include "keepalive-accounting.h"
+
+# include <stdbool.h>
+
 # ifdef __cplusplus
 extern "C" {
 # elif 0
@@ -111,6 +115,72 @@ void cpukeepalive_stop(cpukeepalive_t *self);
  */
 const char *cpukeepalive_get_id(const cpukeepalive_t *self);
 
+/** Get power accounting data for CPU-keepalive object
+ *
+ * Runs are CPU-keepalive sessions with MCE and running time is the
+ * time device has been blocked from suspending by those sessions.
+ *
+ * @param self  CPU-keepalive object
+ * @param acc   [output] accounting data
+ *
+ * @return true on success, or false if object is not valid
+ */
+bool cpukeepalive_get_accounting(cpukeepalive_t *self,
+                                 keepalive_accounting_t *acc);
+
+/** Instrumentation data for CPU-keepalive object
+ *
+ * Complements power accounting data with details about how the
+ * keepalive sessions with MCE have been handled.
+ */
+typedef struct
+{
+    /** Number of session renew requests sent to MCE */
+    unsigned cks_renewals;
+
+    /** Delay from cpukeepalive_start() to the first keepalive
+     *  request of the most recent session being sent [ms],
+     *  or -1 if no session has been started yet */
+    int64_t  cks_start_latency_ms;
+
+    /** Longest start delay seen so far [ms], or -1 */
+    int64_t  cks_start_latency_max_ms;
+} cpukeepalive_stats_t;
+
+/** Get instrumentation data for CPU-keepalive object
+ *
+ * @param self   CPU-keepalive object
+ * @param stats  [output] instrumentation data
+ *
+ * @return true on success, or false if object is not valid
+ */
+bool cpukeepalive_get_stats(cpukeepalive_t *self,
+                            cpukeepalive_stats_t *stats);
+
+/** Add holder to process wide shared CPU-keepalive session
+ *
+ * All holders within the process share one CPU-keepalive object,
+ * i.e. one keepalive session with MCE. The same session is used also
+ * by keepalive_idle_add() and hybrid mode keepalive timeouts.
+ *
+ * The session is started when the first holder is added. Can be
+ * called from any thread, but the session itself is handled from
+ * the default glib main context.
+ */
+void cpukeepalive_shared_acquire(void);
+
+/** Remove holder from process wide shared CPU-keepalive session
+ *
+ * The session is stopped when the last holder is removed.
+ */
+void cpukeepalive_shared_release(void);
+
+/** Get number of process wide shared CPU-keepalive session holders
+ *
+ * @return number of holders
+ */
+unsigned cpukeepalive_shared_holders(void);
+
 # pragma GCC visibility pop
 
 # ifdef __cplusplus
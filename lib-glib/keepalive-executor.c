@@ -0,0 +1,469 @@
+/****************************************************************************************
+**
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of nemo-keepalive package.
+**
+** You may use this file under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+****************************************************************************************/
+
+#include "keepalive-executor.h"
+#include "keepalive-cpukeepalive.h"
+
+#include "logging.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include <pthread.h>
+
+#include <glib.h>
+
+/* ========================================================================= *
+ * CONSTANTS
+ * ========================================================================= */
+
+/** Logging prefix for this module */
+#define PFIX "executor: "
+
+/* ========================================================================= *
+ * TYPES
+ * ========================================================================= */
+
+/** Enumeration of executor job states */
+typedef enum
+{
+    EXECUTOR_JOB_QUEUED,
+    EXECUTOR_JOB_RUNNING,
+    EXECUTOR_JOB_FINISHED,
+} executor_job_state_t;
+
+typedef struct executor_job_t executor_job_t;
+
+/** Executor job bookkeeping */
+struct executor_job_t
+{
+    /** Executor the job belongs to */
+    keepalive_executor_t        *kej_executor;
+
+    /** Function to call in worker thread */
+    keepalive_executor_job_fn    kej_job_cb;
+
+    /** Function to call in owner context after finishing */
+    keepalive_executor_done_fn   kej_done_cb;
+
+    /** User data for callbacks */
+    gpointer                     kej_data;
+
+    /** Current job state */
+    executor_job_state_t         kej_state;
+
+    /** Flag for: deadline has passed */
+    bool                         kej_expired;
+
+    /** Status to report on completion */
+    keepalive_executor_status_t  kej_status;
+
+    /** Flag for: job is holding the cpu keepalive */
+    bool                         kej_holding;
+
+    /** Deadline timer attached to owner context, or NULL */
+    GSource                     *kej_deadline;
+};
+
+/** Keepalive executor state */
+struct keepalive_executor_t
+{
+    /** Data access lock */
+    pthread_mutex_t  kae_mutex;
+
+    /** Worker threads */
+    GThreadPool     *kae_pool;
+
+    /** Context used for completion notifications */
+    GMainContext    *kae_context;
+
+    /** CPU keepalive shared by all jobs */
+    cpukeepalive_t  *kae_keepalive;
+
+    /** Number of jobs holding the cpu keepalive */
+    guint            kae_holders;
+
+    /** Number of jobs not yet completed */
+    guint            kae_pending;
+
+    /** Flag for: keepalive_executor_free() has been called */
+    bool             kae_released;
+};
+
+/* ========================================================================= *
+ * Prototypes
+ * ========================================================================= */
+
+/* ------------------------------------------------------------------------- *
+ * EXECUTOR
+ * ------------------------------------------------------------------------- */
+
+static void                  executor_lock          (keepalive_executor_t *self);
+static void                  executor_unlock        (keepalive_executor_t *self);
+static void                  executor_hold_locked   (keepalive_executor_t *self);
+static void                  executor_unhold_locked (keepalive_executor_t *self);
+static void                  executor_delete        (keepalive_executor_t *self);
+
+/* ------------------------------------------------------------------------- *
+ * EXECUTOR_JOB
+ * ------------------------------------------------------------------------- */
+
+static void                  executor_job_run_cb     (gpointer data, gpointer user_data);
+static gboolean              executor_job_deadline_cb(gpointer aptr);
+static gboolean              executor_job_complete_cb(gpointer aptr);
+
+/* ------------------------------------------------------------------------- *
+ * EXTERNAL_API
+ * ------------------------------------------------------------------------- */
+
+keepalive_executor_t        *keepalive_executor_new        (gint max_threads);
+void                         keepalive_executor_free       (keepalive_executor_t *self);
+gboolean                     keepalive_executor_push       (keepalive_executor_t *self, keepalive_executor_job_fn job, keepalive_executor_done_fn done, gpointer data);
+gboolean                     keepalive_executor_push_full  (keepalive_executor_t *self, keepalive_executor_job_fn job, keepalive_executor_done_fn done, gpointer data, guint deadline);
+guint                        keepalive_executor_get_pending(keepalive_executor_t *self);
+
+/* ========================================================================= *
+ * EXECUTOR
+ * ========================================================================= */
+
+static void
+executor_lock(keepalive_executor_t *self)
+{
+    if( pthread_mutex_lock(&self->kae_mutex) != 0 )
+        log_abort("executor mutex lock failed");
+}
+
+static void
+executor_unlock(keepalive_executor_t *self)
+{
+    if( pthread_mutex_unlock(&self->kae_mutex) != 0 )
+        log_abort("executor mutex unlock failed");
+}
+
+/** Add cpu keepalive holder
+ *
+ * The keepalive session is started when the first holder is added.
+ */
+static void
+executor_hold_locked(keepalive_executor_t *self)
+{
+    if( self->kae_holders++ == 0 ) {
+        log_debug(PFIX"start keepalive");
+        cpukeepalive_start(self->kae_keepalive);
+    }
+}
+
+/** Remove cpu keepalive holder
+ *
+ * The keepalive session is stopped when the last holder is removed.
+ * As cpukeepalive_t evaluates the situation from an idle callback,
+ * consecutive jobs do not cause start/stop ipc in between.
+ */
+static void
+executor_unhold_locked(keepalive_executor_t *self)
+{
+    if( self->kae_holders == 0 ) {
+        log_warning(PFIX"unbalanced keepalive release");
+    }
+    else if( --self->kae_holders == 0 ) {
+        log_debug(PFIX"stop keepalive");
+        cpukeepalive_stop(self->kae_keepalive);
+    }
+}
+
+/** Release executor resources
+ *
+ * Called after keepalive_executor_free() once all jobs are done.
+ */
+static void
+executor_delete(keepalive_executor_t *self)
+{
+    log_function("%p", self);
+
+    cpukeepalive_stop(self->kae_keepalive);
+    cpukeepalive_unref(self->kae_keepalive),
+        self->kae_keepalive = 0;
+
+    g_main_context_unref(self->kae_context),
+        self->kae_context = 0;
+
+    pthread_mutex_destroy(&self->kae_mutex);
+    free(self);
+}
+
+/* ========================================================================= *
+ * EXECUTOR_JOB
+ * ========================================================================= */
+
+/** Execute job in worker thread
+ */
+static void
+executor_job_run_cb(gpointer data, gpointer user_data)
+{
+    executor_job_t       *job  = data;
+    keepalive_executor_t *self = user_data;
+
+    executor_lock(self);
+    bool skip = job->kej_expired;
+    if( !skip )
+        job->kej_state = EXECUTOR_JOB_RUNNING;
+    executor_unlock(self);
+
+    if( !skip )
+        job->kej_job_cb(job->kej_data);
+
+    executor_lock(self);
+    job->kej_state = EXECUTOR_JOB_FINISHED;
+    executor_unlock(self);
+
+    /* Note: g_main_context_invoke() would call the completion
+     *       callback right here in the worker thread if the owner
+     *       context happens to be acquirable -> always go via idle
+     *       source attached to the owner context.
+     */
+    GSource *src = g_idle_source_new();
+    g_source_set_priority(src, G_PRIORITY_DEFAULT);
+    g_source_set_callback(src, executor_job_complete_cb, job, 0);
+    g_source_attach(src, self->kae_context);
+    g_source_unref(src);
+}
+
+/** Handle job deadline in owner context
+ */
+static gboolean
+executor_job_deadline_cb(gpointer aptr)
+{
+    executor_job_t       *job  = aptr;
+    keepalive_executor_t *self = job->kej_executor;
+
+    executor_lock(self);
+
+    if( job->kej_state != EXECUTOR_JOB_FINISHED ) {
+        log_notice(PFIX"job %p missed deadline while %s", job,
+                   job->kej_state == EXECUTOR_JOB_QUEUED ?
+                   "queued" : "running");
+        job->kej_expired = true;
+
+        /* Worker threads skip jobs that expired while queued */
+        if( job->kej_state == EXECUTOR_JOB_QUEUED )
+            job->kej_status = KEEPALIVE_EXECUTOR_JOB_EXPIRED;
+        else
+            job->kej_status = KEEPALIVE_EXECUTOR_JOB_OVERRUN;
+
+        /* Deadline limits also the time the job keeps device awake */
+        if( job->kej_holding ) {
+            job->kej_holding = false;
+            executor_unhold_locked(self);
+        }
+    }
+
+    executor_unlock(self);
+
+    g_source_unref(job->kej_deadline),
+        job->kej_deadline = 0;
+
+    return G_SOURCE_REMOVE;
+}
+
+/** Make job completion notification in owner context
+ */
+static gboolean
+executor_job_complete_cb(gpointer aptr)
+{
+    executor_job_t       *job  = aptr;
+    keepalive_executor_t *self = job->kej_executor;
+
+    if( job->kej_deadline ) {
+        g_source_destroy(job->kej_deadline);
+        g_source_unref(job->kej_deadline),
+            job->kej_deadline = 0;
+    }
+
+    /* Status is updated only from owner context, i.e. here */
+    if( job->kej_done_cb )
+        job->kej_done_cb(job->kej_data, job->kej_status);
+
+    executor_lock(self);
+    if( job->kej_holding ) {
+        job->kej_holding = false;
+        executor_unhold_locked(self);
+    }
+    bool delete = ( --self->kae_pending == 0 && self->kae_released );
+    executor_unlock(self);
+
+    free(job);
+
+    if( delete )
+        executor_delete(self);
+
+    return G_SOURCE_REMOVE;
+}
+
+/* ========================================================================= *
+ * EXTERNAL_API  --  documented in: keepalive-executor.h
+ * ========================================================================= */
+
+keepalive_executor_t *
+keepalive_executor_new(gint max_threads)
+{
+    keepalive_executor_t *self = calloc(1, sizeof *self);
+
+    if( !self )
+        goto cleanup;
+
+    pthread_mutex_init(&self->kae_mutex, 0);
+    self->kae_context   = g_main_context_ref_thread_default();
+    self->kae_keepalive = cpukeepalive_new();
+    self->kae_holders   = 0;
+    self->kae_pending   = 0;
+    self->kae_released  = false;
+
+    GError *err = 0;
+    self->kae_pool = g_thread_pool_new(executor_job_run_cb, self,
+                                       max_threads, FALSE, &err);
+    if( !self->kae_pool ) {
+        log_error(PFIX"failed to create thread pool: %s",
+                  err ? err->message : "unknown error");
+        g_clear_error(&err);
+        executor_delete(self), self = 0;
+    }
+
+cleanup:
+    log_function("%p", self);
+    return self;
+}
+
+void
+keepalive_executor_free(keepalive_executor_t *self)
+{
+    log_function("%p", self);
+
+    if( !self )
+        goto cleanup;
+
+    /* Let queued jobs finish, but do not wait for them */
+    g_thread_pool_free(self->kae_pool, FALSE, FALSE),
+        self->kae_pool = 0;
+
+    executor_lock(self);
+    self->kae_released = true;
+    bool delete = ( self->kae_pending == 0 );
+    executor_unlock(self);
+
+    if( delete )
+        executor_delete(self);
+
+cleanup:
+    return;
+}
+
+gboolean
+keepalive_executor_push(keepalive_executor_t *self,
+                        keepalive_executor_job_fn job,
+                        keepalive_executor_done_fn done,
+                        gpointer data)
+{
+    return keepalive_executor_push_full(self, job, done, data, 0);
+}
+
+gboolean
+keepalive_executor_push_full(keepalive_executor_t *self,
+                             keepalive_executor_job_fn job,
+                             keepalive_executor_done_fn done,
+                             gpointer data,
+                             guint deadline)
+{
+    gboolean        ack = FALSE;
+    executor_job_t *ent = 0;
+
+    if( !self || !job || !self->kae_pool )
+        goto cleanup;
+
+    if( !(ent = calloc(1, sizeof *ent)) )
+        goto cleanup;
+
+    ent->kej_executor = self;
+    ent->kej_job_cb   = job;
+    ent->kej_done_cb  = done;
+    ent->kej_data     = data;
+    ent->kej_state    = EXECUTOR_JOB_QUEUED;
+    ent->kej_expired  = false;
+    ent->kej_status   = KEEPALIVE_EXECUTOR_JOB_COMPLETED;
+    ent->kej_holding  = true;
+    ent->kej_deadline = 0;
+
+    executor_lock(self);
+    self->kae_pending += 1;
+    executor_hold_locked(self);
+    executor_unlock(self);
+
+    if( deadline > 0 ) {
+        ent->kej_deadline = g_timeout_source_new(deadline);
+        g_source_set_callback(ent->kej_deadline,
+                              executor_job_deadline_cb, ent, 0);
+        g_source_attach(ent->kej_deadline, self->kae_context);
+    }
+
+    GError *err = 0;
+    if( !g_thread_pool_push(self->kae_pool, ent, &err) ) {
+        log_error(PFIX"failed to push job: %s",
+                  err ? err->message : "unknown error");
+        g_clear_error(&err);
+
+        if( ent->kej_deadline ) {
+            g_source_destroy(ent->kej_deadline);
+            g_source_unref(ent->kej_deadline),
+                ent->kej_deadline = 0;
+        }
+
+        executor_lock(self);
+        executor_unhold_locked(self);
+        self->kae_pending -= 1;
+        executor_unlock(self);
+
+        free(ent), ent = 0;
+        goto cleanup;
+    }
+
+    ack = TRUE;
+
+cleanup:
+    return ack;
+}
+
+guint
+keepalive_executor_get_pending(keepalive_executor_t *self)
+{
+    guint pending = 0;
+
+    if( self ) {
+        executor_lock(self);
+        pending = self->kae_pending;
+        executor_unlock(self);
+    }
+
+    return pending;
+}
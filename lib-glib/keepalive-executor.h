@@ -0,0 +1,157 @@
+/****************************************************************************************
+**
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of nemo-keepalive package.
+**
+** You may use this file under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+****************************************************************************************/
+
+/** @file keepalive-executor.h
+ *
+ * @brief Provides thread pool that keeps the device awake while
+ *        it has unfinished jobs.
+ */
+
+#ifndef KEEPALIVE_GLIB_EXECUTOR_H_
+# define KEEPALIVE_GLIB_EXECUTOR_H_
+
+# include <glib.h>
+
+# ifdef __cplusplus
+extern "C" {
+# elif 0
+} /* fool JED indentation ... */
+# endif
+
+# pragma GCC visibility push(default)
+
+/** Opaque keepalive executor structure
+ *
+ * Allocate via keepalive_executor_new() and
+ * release via keepalive_executor_free().
+ */
+typedef struct keepalive_executor_t keepalive_executor_t;
+
+/** Enumeration of ways an executor job can finish */
+typedef enum
+{
+    /** Job was executed before its deadline */
+    KEEPALIVE_EXECUTOR_JOB_COMPLETED = 0,
+
+    /** Job was executed, but finished only after its deadline */
+    KEEPALIVE_EXECUTOR_JOB_OVERRUN   = 1,
+
+    /** Job was not executed because it was not started before
+     *  its deadline */
+    KEEPALIVE_EXECUTOR_JOB_EXPIRED   = 2,
+} keepalive_executor_status_t;
+
+/** Prototype for executor job functions
+ *
+ * Called from a worker thread.
+ *
+ * @param data  user data pointer as given to keepalive_executor_push()
+ */
+typedef void (*keepalive_executor_job_fn)(gpointer data);
+
+/** Prototype for executor job completion notifications
+ *
+ * Called from the main context that was the thread default
+ * context when the executor was created.
+ *
+ * @param data    user data pointer as given to keepalive_executor_push()
+ * @param status  how the job finished
+ */
+typedef void (*keepalive_executor_done_fn)(gpointer data, keepalive_executor_status_t status);
+
+/** Create keepalive executor
+ *
+ * Jobs pushed to the executor are executed in a GThreadPool. All
+ * jobs share a single CPU-keepalive session. It is started when the
+ * first job is queued and stopped when no more jobs that need it remain.
+ *
+ * Job completion notifications are dispatched via the thread default
+ * main context of the thread that creates the executor.
+ *
+ * @param max_threads  maximum number of worker threads, or -1 for
+ *                     no limit
+ *
+ * @return executor object, or NULL on failure
+ */
+keepalive_executor_t *keepalive_executor_new(gint max_threads);
+
+/** Release keepalive executor
+ *
+ * Jobs that have already been pushed are still executed and their
+ * completion notifications made. Actual release of resources happens
+ * after the last job has finished.
+ *
+ * @param self  executor object, or NULL
+ */
+void keepalive_executor_free(keepalive_executor_t *self);
+
+/** Push job to keepalive executor
+ *
+ * @param self  executor object
+ * @param job   function to call in worker thread
+ * @param done  function to call in owner context when the job is
+ *              finished, or NULL
+ * @param data  data to pass to job and done functions
+ *
+ * @return TRUE if job was queued, FALSE otherwise
+ */
+gboolean keepalive_executor_push(keepalive_executor_t *self, keepalive_executor_job_fn job, keepalive_executor_done_fn done, gpointer data);
+
+/** Push job with deadline to keepalive executor
+ *
+ * Like keepalive_executor_push(), but the job keeps the device awake
+ * at most until the deadline. If the job has not started by then, it
+ * is not executed at all and is reported as expired. If it is still
+ * executing, it is allowed to finish but is reported as overrun.
+ *
+ * @param self      executor object
+ * @param job       function to call in worker thread
+ * @param done      function to call in owner context when the job is
+ *                  finished, or NULL
+ * @param data      data to pass to job and done functions
+ * @param deadline  maximum time from push to finish, in milliseconds,
+ *                  or 0 for no deadline
+ *
+ * @return TRUE if job was queued, FALSE otherwise
+ */
+gboolean keepalive_executor_push_full(keepalive_executor_t *self, keepalive_executor_job_fn job, keepalive_executor_done_fn done, gpointer data, guint deadline);
+
+/** Get number of unfinished jobs
+ *
+ * @param self  executor object
+ *
+ * @return number of jobs that are queued or executing, or whose
+ *         completion notification has not yet been made
+ */
+guint keepalive_executor_get_pending(keepalive_executor_t *self);
+
+# pragma GCC visibility pop
+
+# ifdef __cplusplus
+};
+# endif
+
+#endif /* KEEPALIVE_GLIB_EXECUTOR_H_ */
@@ -29,6 +29,7 @@
 
 #include "keepalive-heartbeat.h"
 #include "keepalive-object.h"
+#include "accounting.h"
 
 #include "logging.h"
 
@@ -101,6 +102,9 @@ struct heartbeat_t
 
     /** Wakeup notification callback set via heartbeat_set_notify() */
     heartbeat_wakeup_fn  hb_user_notify;
+
+    /** Accounting record for counting IPHB IPC, or NULL */
+    accounting_t        *hb_accounting;
 };
 
 /* ========================================================================= *
@@ -161,6 +165,7 @@ static void heartbeat_stop_locked      (heartbeat_t *self);
 static void heartbeat_start_locked     (heartbeat_t *self);
 static void heartbeat_set_delay_locked (heartbeat_t *self, int delay_lo, int delay_hi);
 static void heartbeat_set_notify_locked(heartbeat_t *self, heartbeat_wakeup_fn notify_cb, void *user_data, heartbeat_free_fn user_free_cb);
+static void heartbeat_iphb_wait_locked (heartbeat_t *self, int delay_lo, int delay_hi, int resume);
 
 /* ------------------------------------------------------------------------- *
  * EXTERNAL_API
@@ -174,6 +179,12 @@ void         heartbeat_set_delay (heartbeat_t *self, int delay_lo, int delay_hi)
 void         heartbeat_start     (heartbeat_t *self);
 void         heartbeat_stop      (heartbeat_t *self);
 
+/* ------------------------------------------------------------------------- *
+ * INTERNAL_API
+ * ------------------------------------------------------------------------- */
+
+void         heartbeat_set_accounting(heartbeat_t *self, accounting_t *acc);
+
 /* ========================================================================= *
  * OBJECT_LIFETIME
  * ========================================================================= */
@@ -229,6 +240,9 @@ heartbeat_ctor(heartbeat_t *self)
 
     /* No notification callback */
     self->hb_user_notify = 0;
+
+    /* No IPC accounting */
+    self->hb_accounting  = 0;
 }
 
 /** Callback for handling keepalive_object_t shutdown
@@ -551,7 +565,7 @@ heartbeat_iphb_wakeup_schedule_locked(heartbeat_t *self)
     int lo = self->hb_delay_lo;
     int hi = self->hb_delay_hi;
     log_notice(PFIX"iphb_wait2(%d, %d)", lo, hi);
-    iphb_wait2(self->hb_iphb_handle, lo, hi, 0, 1);
+    heartbeat_iphb_wait_locked(self, lo, hi, 1);
     self->hb_waiting = true;
 
 cleanup:
@@ -711,7 +725,7 @@ heartbeat_stop_locked(heartbeat_t *self)
     log_function("%p", self);
 
     if( self->hb_waiting && self->hb_iphb_handle )
-        iphb_wait2(self->hb_iphb_handle, 0, 0, 0, 0);
+        heartbeat_iphb_wait_locked(self, 0, 0, 0);
 
     self->hb_waiting = false;
     self->hb_started = false;
@@ -741,6 +755,25 @@ heartbeat_set_delay_locked(heartbeat_t *self, int delay_lo, int delay_hi)
     self->hb_delay_hi = delay_hi;
 }
 
+/** Send wakeup request to IPHB daemon
+ *
+ * Zero delays cancel already programmed wakeup.
+ *
+ * @param self      heartbeat object
+ * @param delay_lo  minimum seconds to wakeup
+ * @param delay_hi  maximum seconds to wakeup
+ * @param resume    nonzero to wake up the device from suspend
+ */
+static void
+heartbeat_iphb_wait_locked(heartbeat_t *self, int delay_lo, int delay_hi,
+                           int resume)
+{
+    iphb_wait2(self->hb_iphb_handle, delay_lo, delay_hi, 0, resume);
+
+    if( self->hb_accounting )
+        accounting_ipc(self->hb_accounting);
+}
+
 static void
 heartbeat_set_notify_locked(heartbeat_t *self,
                             heartbeat_wakeup_fn notify_cb,
@@ -832,3 +865,17 @@ heartbeat_stop(heartbeat_t *self)
         heartbeat_unlock(self);
     }
 }
+
+/* ========================================================================= *
+ * INTERNAL_API --  documented in: accounting.h
+ * ========================================================================= */
+
+void
+heartbeat_set_accounting(heartbeat_t *self, accounting_t *acc)
+{
+    log_function("%p", self);
+    if( heartbeat_validate_and_lock(self) ) {
+        self->hb_accounting = acc;
+        heartbeat_unlock(self);
+    }
+}
@@ -0,0 +1,131 @@
+/****************************************************************************************
+**
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of nemo-keepalive package.
+**
+** You may use this file under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+****************************************************************************************/
+
+#include "keepalive-idle.h"
+#include "sharedkeepalive.h"
+
+#include "logging.h"
+
+#include <stdlib.h>
+
+#include <glib.h>
+
+/* ========================================================================= *
+ * TYPES
+ * ========================================================================= */
+
+typedef struct keepalive_idle_t keepalive_idle_t;
+
+struct keepalive_idle_t
+{
+    GSourceFunc     kai_func;
+    gpointer        kai_data;
+    GDestroyNotify  kai_notify;
+};
+
+/* ========================================================================= *
+ * INTERNAL FUNCTION PROTOTYPES
+ * ========================================================================= */
+
+// GSOURCE_GLUE
+
+static gboolean keepalive_idle_dispatch_cb(gpointer aptr);
+static void     keepalive_idle_destroy_cb (gpointer aptr);
+
+/* ========================================================================= *
+ * INTERNAL FUNCTIONS
+ * ========================================================================= */
+
+/* ------------------------------------------------------------------------- *
+ * GSOURCE_GLUE
+ * ------------------------------------------------------------------------- */
+
+static
+gboolean
+keepalive_idle_dispatch_cb(gpointer aptr)
+{
+    keepalive_idle_t *self = aptr;
+
+    log_enter_function();
+
+    return self->kai_func(self->kai_data);
+}
+
+static
+void
+keepalive_idle_destroy_cb(gpointer aptr)
+{
+    keepalive_idle_t *self = aptr;
+
+    log_enter_function();
+
+    if( self->kai_notify )
+        self->kai_notify(self->kai_data);
+
+    free(self);
+
+    /* Suspend is allowed after the last idle source is gone */
+    sharedkeepalive_release();
+}
+
+/* ========================================================================= *
+ * EXTERNAL API --  documented in: keepalive-idle.h
+ * ========================================================================= */
+
+guint
+keepalive_idle_add_full(gint priority,
+                        GSourceFunc function,
+                        gpointer data,
+                        GDestroyNotify notify)
+{
+    guint id = 0;
+
+    keepalive_idle_t *self = calloc(1, sizeof *self);
+
+    if( !self )
+        goto cleanup;
+
+    self->kai_func   = function;
+    self->kai_data   = data;
+    self->kai_notify = notify;
+
+    /* Released in keepalive_idle_destroy_cb() */
+    sharedkeepalive_acquire();
+
+    id = g_idle_add_full(priority, keepalive_idle_dispatch_cb, self,
+                         keepalive_idle_destroy_cb);
+
+cleanup:
+    return id;
+}
+
+guint
+keepalive_idle_add(GSourceFunc function,
+                   gpointer data)
+{
+    return keepalive_idle_add_full(G_PRIORITY_DEFAULT_IDLE,
+                                   function, data, 0);
+}
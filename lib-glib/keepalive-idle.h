@@ -0,0 +1,88 @@
+/****************************************************************************************
+**
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of nemo-keepalive package.
+**
+** You may use this file under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+****************************************************************************************/
+
+/** @file keepalive-idle.h
+ *
+ * @brief Provides suspend blocking idle callbacks with glib compatible API.
+ */
+
+#ifndef KEEPALIVE_GLIB_IDLE_H_
+# define KEEPALIVE_GLIB_IDLE_H_
+
+# include <glib.h>
+
+# ifdef __cplusplus
+extern "C" {
+# elif 0
+} /* fool JED indentation ... */
+# endif
+
+# pragma GCC visibility push(default)
+
+/** Drop in replacement for g_idle_add_full()
+ *
+ * Unlike normal glib idle callbacks, these keep the device from
+ * suspending from the time the source is added until it is removed
+ * i.e. while the callback is pending and while it is being executed.
+ *
+ * All keepalive idle sources within the process share one
+ * CPU-keepalive session with MCE. The session is started when the
+ * first source is added and released only after all sources have
+ * been removed, so that a burst of idle callbacks costs the same
+ * amount of D-Bus IPC as a single one.
+ *
+ * As the keepalive is held for as long as the source exists, idle
+ * callbacks that keep returning TRUE block suspend indefinitely.
+ *
+ * @param priority  the priority of the idle source. Typically this will
+ *                  be in the range between G_PRIORITY_DEFAULT_IDLE and
+ *                  G_PRIORITY_HIGH_IDLE.
+ * @param function  function to call
+ * @param data      data to pass to function
+ * @param notify    function to call when the idle is removed, or NULL.
+ *
+ * @return the ID (greater than 0) of the event source
+ */
+guint keepalive_idle_add_full(gint priority, GSourceFunc function, gpointer data, GDestroyNotify notify);
+
+/** Drop in replacement for g_idle_add()
+ *
+ * See keepalive_idle_add_full() for details.
+ *
+ * @param function  function to call
+ * @param data      data to pass to function
+ *
+ * @return the ID (greater than 0) of the event source
+ */
+guint keepalive_idle_add(GSourceFunc function, gpointer data);
+
+# pragma GCC visibility pop
+
+# ifdef __cplusplus
+};
+# endif
+
+#endif /* KEEPALIVE_GLIB_IDLE_H_ */
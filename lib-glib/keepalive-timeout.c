@@ -29,6 +29,7 @@
 
 #include "keepalive-timeout.h"
 #include "keepalive-backgroundactivity.h"
+#include "sharedkeepalive.h"
 
 #include "logging.h"
 
@@ -43,6 +44,22 @@
 /* Logging prefix for this module */
 #define PFIX "timeout: "
 
+/** Default limit for using hybrid mode, in milliseconds
+ *
+ * Matches the global heartbeat period, i.e. the maximum time that
+ * an IPHB wakeup could be delayed for alignment purposes anyway.
+ *
+ * Applies only to timeouts added via keepalive_timeout_add_hybrid().
+ */
+#define KEEPALIVE_TIMEOUT_HYBRID_THRESHOLD_DEFAULT (12 * 1000)
+
+/** Limit for using hybrid mode while shared keepalive is held, in ms
+ *
+ * Holding on to a keepalive session that is already active for other
+ * reasons is cheap, but extending it for long periods is not.
+ */
+#define KEEPALIVE_TIMEOUT_HYBRID_HELD_LIMIT (60 * 1000)
+
 /* ========================================================================= *
  * TYPES
  * ========================================================================= */
@@ -55,6 +72,14 @@ struct keepalive_timeout_t
 
     background_activity_t *kat_activity;
     bool                   kat_triggered;
+
+    /* Requested priority, used also for deriving IPHB wakeup range */
+    gint                   kat_priority;
+
+    /* Hybrid mode: monotonic ready time + shared cpu keepalive */
+    bool                   kat_hybrid;
+    guint                  kat_interval;
+    gint                   kat_slack;
 };
 
 /* ========================================================================= *
@@ -71,6 +96,19 @@ static void     keepalive_timeout_finalize_cb (GSource *srce);
 // BACKGROUND_ACTIVITY_GLUE
 
 static void     keepalive_timeout_trigger_cb  (background_activity_t *activity, void *aptr);
+static void     keepalive_timeout_iphb_start  (keepalive_timeout_t *self, background_activity_frequency_t slot);
+
+// HYBRID_MODE
+
+static guint    keepalive_timeout_hybrid_threshold   (void);
+static bool     keepalive_timeout_held_by_others     (void);
+static bool     keepalive_timeout_use_hybrid         (guint interval);
+static void     keepalive_timeout_hybrid_start       (keepalive_timeout_t *self);
+static void     keepalive_timeout_hybrid_stop        (keepalive_timeout_t *self);
+
+// ADD_TIMEOUT
+
+static guint    keepalive_timeout_add_internal(gint priority, bool glib_priority, guint interval, gint slack, background_activity_frequency_t slot, bool hybrid, GSourceFunc func, gpointer data, GDestroyNotify notify);
 
 /* ========================================================================= *
  * INTERNAL FUNCTIONS
@@ -115,7 +153,23 @@ keepalive_timeout_dispatch_cb(GSource *srce, GSourceFunc cb, gpointer aptr)
 
     bool repeat = cb(aptr);
 
-    if( repeat )
+    if( self->kat_hybrid ) {
+        /* Hybrid mode covers only the first interval, further
+         * repeats are scheduled via IPHB so that the device
+         * is allowed to suspend in between.
+         */
+        keepalive_timeout_hybrid_stop(self);
+        if( repeat ) {
+            /* Keep close to the requested interval instead of
+             * falling back to priority based default range.
+             */
+            if( self->kat_slack < 0 )
+                self->kat_slack = 0;
+            keepalive_timeout_iphb_start(self,
+                                         BACKGROUND_ACTIVITY_FREQUENCY_RANGE);
+        }
+    }
+    else if( repeat )
         background_activity_wait(self->kat_activity);
     else
         background_activity_stop(self->kat_activity);
@@ -133,6 +187,11 @@ keepalive_timeout_finalize_cb(GSource *srce)
 
     log_enter_function();
 
+    keepalive_timeout_hybrid_stop(self);
+
+    if( !self->kat_activity )
+        return;
+
     /* Internal references might keep the object alive for a
      * while after we let go of it -> make sure notification
      * callbacks are not active if that happens.
@@ -179,16 +238,199 @@ keepalive_timeout_trigger_cb(background_activity_t *activity, void *aptr)
     self->kat_triggered = true;
 }
 
-/* ========================================================================= *
- * EXTERNAL API --  documented in: keepalive-timeout.h
- * ========================================================================= */
+/** Start waiting for IPHB wakeup via background activity
+ *
+ * @param self  keepalive timeout source
+ * @param slot  global wakeup slot, or
+ *              BACKGROUND_ACTIVITY_FREQUENCY_RANGE to use interval
+ */
+static
+void
+keepalive_timeout_iphb_start(keepalive_timeout_t *self,
+                             background_activity_frequency_t slot)
+{
+    self->kat_activity = background_activity_new();
 
+    background_activity_set_running_callback(self->kat_activity,
+                                             keepalive_timeout_trigger_cb);
+    background_activity_set_user_data(self->kat_activity,
+                                      self, 0);
+
+    if( slot != BACKGROUND_ACTIVITY_FREQUENCY_RANGE ) {
+        background_activity_set_wakeup_slot(self->kat_activity, slot);
+    }
+    else {
+        /* Minimum wait as requested */
+        int delay_lo = (self->kat_interval + 999) / 1000;
+
+        /* Default to: let background object decide maximum wait */
+        int delay_hi = -1;
+
+        if( self->kat_slack >= 0 ) {
+            /* Use the range caller said is acceptable */
+            delay_hi = (int)(((gint64)self->kat_interval +
+                              self->kat_slack) / 1000);
+            if( delay_hi <= delay_lo )
+                delay_hi = delay_lo + 1;
+        }
+        else if( self->kat_priority <= G_PRIORITY_HIGH ) {
+            /* Use tighter wakeup range for high priority timeouts */
+            delay_hi = delay_lo + 1;
+        }
+
+        background_activity_set_wakeup_range(self->kat_activity,
+                                             delay_lo, delay_hi);
+    }
+
+    background_activity_wait(self->kat_activity);
+}
+
+/* ------------------------------------------------------------------------- *
+ * HYBRID_MODE
+ * ------------------------------------------------------------------------- */
+
+/** Timeouts shorter than this use hybrid mode, in milliseconds */
+static volatile gint keepalive_timeout_hybrid_threshold_ms =
+    KEEPALIVE_TIMEOUT_HYBRID_THRESHOLD_DEFAULT;
+
+static
 guint
-keepalive_timeout_add_full(gint priority,
-                           guint interval,
-                           GSourceFunc func,
-                           gpointer data,
-                           GDestroyNotify notify)
+keepalive_timeout_hybrid_threshold(void)
+{
+    return (guint)g_atomic_int_get(&keepalive_timeout_hybrid_threshold_ms);
+}
+
+/** Predicate for: shared keepalive is held by someone else than caller
+ *
+ * When a hybrid mode timeout callback is being dispatched, the
+ * shared keepalive held on behalf of that very timeout is about to
+ * be released and must not be used as a reason to add more hybrid
+ * mode timeouts - otherwise callbacks that re-add themselves would
+ * keep blocking suspend indefinitely.
+ *
+ * @return true if there are other holders, false otherwise
+ */
+static
+bool
+keepalive_timeout_held_by_others(void)
+{
+    unsigned  own  = 0;
+    GSource  *srce = g_main_current_source();
+
+    if( srce && srce->source_funcs == &keepalive_timeout_funcs ) {
+        keepalive_timeout_t *self = (keepalive_timeout_t *)srce;
+        if( self->kat_hybrid )
+            own = 1;
+    }
+
+    return sharedkeepalive_get_holders() > own;
+}
+
+/** Predicate for: timeout should be handled in hybrid mode
+ *
+ * Short timeouts are cheaper to implement by blocking suspend
+ * and using normal monotonic timer than by making the round trip
+ * to DSME and MCE via IPHB. The same applies to moderately long
+ * timeouts added while the process is already keeping the device
+ * awake via the shared keepalive for other reasons.
+ *
+ * @param interval  timeout in milliseconds
+ *
+ * @return true if hybrid mode should be used, false otherwise
+ */
+static
+bool
+keepalive_timeout_use_hybrid(guint interval)
+{
+    guint threshold = keepalive_timeout_hybrid_threshold();
+
+    if( threshold == 0 )
+        return false;
+
+    if( interval < threshold )
+        return true;
+
+    if( interval < KEEPALIVE_TIMEOUT_HYBRID_HELD_LIMIT &&
+        keepalive_timeout_held_by_others() )
+        return true;
+
+    return false;
+}
+
+/** Start hybrid mode wait for keepalive timeout
+ *
+ * Suspend is blocked until keepalive_timeout_hybrid_stop() is called.
+ *
+ * @param self  keepalive timeout source
+ */
+static
+void
+keepalive_timeout_hybrid_start(keepalive_timeout_t *self)
+{
+    if( self->kat_hybrid )
+        return;
+
+    log_debug(PFIX"%u ms timeout in hybrid mode", self->kat_interval);
+
+    self->kat_hybrid = true;
+    sharedkeepalive_acquire();
+
+    gint64 now = g_get_monotonic_time();
+    g_source_set_ready_time(&self->kat_source,
+                            now + (gint64)self->kat_interval * 1000);
+}
+
+/** Stop hybrid mode wait for keepalive timeout
+ *
+ * @param self  keepalive timeout source
+ */
+static
+void
+keepalive_timeout_hybrid_stop(keepalive_timeout_t *self)
+{
+    if( !self->kat_hybrid )
+        return;
+
+    self->kat_hybrid = false;
+    g_source_set_ready_time(&self->kat_source, -1);
+
+    /* Actual cpu keepalive stop is evaluated from idle callback,
+     * so a callback that is still running does not get cut off.
+     */
+    sharedkeepalive_release();
+}
+
+/* ------------------------------------------------------------------------- *
+ * ADD_TIMEOUT
+ * ------------------------------------------------------------------------- */
+
+/** Create and attach keepalive timeout source
+ *
+ * @param priority       priority of the timeout
+ * @param glib_priority  true if priority applies also to glib source
+ * @param interval  minimum time between callbacks, in milliseconds
+ * @param slack     allowed additional delay in milliseconds, or
+ *                  negative value to derive it from priority
+ * @param slot      global wakeup slot, or
+ *                  BACKGROUND_ACTIVITY_FREQUENCY_RANGE to use interval
+ * @param hybrid    true if hybrid mode may be used for the first interval
+ * @param func      function to call
+ * @param data      data to pass to function
+ * @param notify    function to call when the timeout is removed, or NULL
+ *
+ * @return the ID (greater than 0) of the event source
+ */
+static
+guint
+keepalive_timeout_add_internal(gint priority,
+                               bool glib_priority,
+                               guint interval,
+                               gint slack,
+                               background_activity_frequency_t slot,
+                               bool hybrid,
+                               GSourceFunc func,
+                               gpointer data,
+                               GDestroyNotify notify)
 {
     guint id = 0;
 
@@ -198,28 +440,25 @@ keepalive_timeout_add_full(gint priority,
     if( !self )
         goto cleanup;
 
-    self->kat_activity  = background_activity_new();
-    self->kat_triggered = false;
+    /* Legacy timeouts use priority only for IPHB wakeup range */
+    if( glib_priority )
+        g_source_set_priority((GSource*)self, priority);
 
-    background_activity_set_running_callback(self->kat_activity,
-                                             keepalive_timeout_trigger_cb);
-    background_activity_set_user_data(self->kat_activity,
-                                      self, 0);
-
-    /* Minimum wait as requested */
-    int delay_lo = (interval + 999) / 1000;
-
-    /* Default to: let background object decide maximum wait */
-    int delay_hi = -1;
+    self->kat_activity  = 0;
+    self->kat_triggered = false;
+    self->kat_priority  = priority;
+    self->kat_hybrid    = false;
+    self->kat_interval  = interval;
+    self->kat_slack     = slack;
 
-    if( priority <= G_PRIORITY_HIGH ) {
-        /* Use tighter wakeup range for high priority timeouts */
-        delay_hi = delay_lo + 1;
-    }
+    /* Global slots are for aligning wakeups -> no hybrid mode */
+    if( slot != BACKGROUND_ACTIVITY_FREQUENCY_RANGE )
+        hybrid = false;
 
-    background_activity_set_wakeup_range(self->kat_activity,
-                                         delay_lo, delay_hi);
-    background_activity_wait(self->kat_activity);
+    if( hybrid && keepalive_timeout_use_hybrid(interval) )
+        keepalive_timeout_hybrid_start(self);
+    else
+        keepalive_timeout_iphb_start(self, slot);
 
     g_source_set_callback((GSource*)self, func, data, notify);
     id = g_source_attach((GSource*)self, 0);
@@ -231,6 +470,22 @@ cleanup:
     return id;
 }
 
+/* ========================================================================= *
+ * EXTERNAL API --  documented in: keepalive-timeout.h
+ * ========================================================================= */
+
+guint
+keepalive_timeout_add_full(gint priority,
+                           guint interval,
+                           GSourceFunc func,
+                           gpointer data,
+                           GDestroyNotify notify)
+{
+    return keepalive_timeout_add_internal(priority, false, interval, -1,
+                                          BACKGROUND_ACTIVITY_FREQUENCY_RANGE,
+                                          false, func, data, notify);
+}
+
 guint
 keepalive_timeout_add(guint interval,
                       GSourceFunc function,
@@ -259,3 +514,60 @@ keepalive_timeout_add_seconds(guint interval,
     return keepalive_timeout_add_full(G_PRIORITY_DEFAULT, interval * 1000,
                                       function, data, 0);
 }
+
+guint
+keepalive_timeout_add_hybrid(gint priority,
+                             guint interval,
+                             GSourceFunc function,
+                             gpointer data,
+                             GDestroyNotify notify)
+{
+    return keepalive_timeout_add_internal(priority, true, interval, -1,
+                                          BACKGROUND_ACTIVITY_FREQUENCY_RANGE,
+                                          true, function, data, notify);
+}
+
+void
+keepalive_timeout_set_hybrid_threshold(guint interval)
+{
+    g_atomic_int_set(&keepalive_timeout_hybrid_threshold_ms, (gint)interval);
+}
+
+guint
+keepalive_timeout_get_hybrid_threshold(void)
+{
+    return keepalive_timeout_hybrid_threshold();
+}
+
+guint
+keepalive_timeout_add_range(gint priority,
+                            guint interval,
+                            guint slack,
+                            GSourceFunc function,
+                            gpointer data,
+                            GDestroyNotify notify)
+{
+    if( slack > G_MAXINT )
+        slack = G_MAXINT;
+
+    return keepalive_timeout_add_internal(priority, true, interval,
+                                          (gint)slack,
+                                          BACKGROUND_ACTIVITY_FREQUENCY_RANGE,
+                                          false, function, data, notify);
+}
+
+guint
+keepalive_timeout_add_slot(gint priority,
+                           background_activity_frequency_t slot,
+                           GSourceFunc function,
+                           gpointer data,
+                           GDestroyNotify notify)
+{
+    if( slot <= BACKGROUND_ACTIVITY_FREQUENCY_RANGE ) {
+        log_warning(PFIX"invalid wakeup slot: %d", (int)slot);
+        return 0;
+    }
+
+    return keepalive_timeout_add_internal(priority, true, 0, -1, slot, false,
+                                          function, data, notify);
+}
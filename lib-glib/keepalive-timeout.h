@@ -34,6 +34,8 @@
 #ifndef KEEPALIVE_GLIB_TIMEOUT_H_
 # define KEEPALIVE_GLIB_TIMEOUT_H_
 
+# include "keepalive-backgroundactivity.h"
+
 # include <glib.h>
 
 # ifdef __cplusplus
@@ -70,6 +72,9 @@ extern "C" {
  * of G_PRIORITY_HIGH can be used and the wakeup is scheduled to occur
  * at range of [interval, interval + 1 second].
  *
+ * Short timeouts that should not pay the cost of IPHB round trips can
+ * use keepalive_timeout_add_hybrid() instead.
+ *
  * @param priority  the priority of the timeout source. Typically this
  *                  will be in the range between G_PRIORITY_DEFAULT and
  *                  G_PRIORITY_HIGH.
@@ -122,6 +127,99 @@ guint keepalive_timeout_add_seconds_full(gint priority, guint interval, GSourceF
  */
 guint keepalive_timeout_add_seconds(guint interval, GSourceFunc function, gpointer data);
 
+/** Keepalive timeout with explicitly specified wakeup range
+ *
+ * Like keepalive_timeout_add_full(), but instead of deriving the
+ * acceptable wakeup range from priority, the caller specifies how
+ * much later than interval the callback may be called.
+ *
+ * Specifying as large slack as the application can tolerate, e.g.
+ * "anywhere within the next 10 minutes is fine", allows the system
+ * to align the wakeup with other activity and thus saves power.
+ *
+ * The wakeup range is [interval, interval + slack], rounded to full
+ * seconds. The range is always at least one second wide.
+ *
+ * @param priority  the priority of the timeout source
+ * @param interval  the minimum time between calls to the function,
+ *                  in milliseconds
+ * @param slack     the maximum additional delay that is acceptable,
+ *                  in milliseconds
+ * @param function  function to call
+ * @param data      data to pass to function
+ * @param notify    function to call when the timeout is removed, or NULL.
+ *
+ * @return the ID (greater than 0) of the event source
+ */
+guint keepalive_timeout_add_range(gint priority, guint interval, guint slack, GSourceFunc function, gpointer data, GDestroyNotify notify);
+
+/** Keepalive timeout triggered at global wakeup slot
+ *
+ * The callback is called at the next global wakeup slot, i.e. at the
+ * same time as all other processes that use the same slot, see
+ * background_activity_set_wakeup_slot(). If the callback returns TRUE,
+ * it is called again at the following slot.
+ *
+ * Global wakeup slots never use hybrid mode.
+ *
+ * @param priority  the priority of the timeout source
+ * @param slot      the global wakeup slot to use
+ * @param function  function to call
+ * @param data      data to pass to function
+ * @param notify    function to call when the timeout is removed, or NULL.
+ *
+ * @return the ID (greater than 0) of the event source, or 0 if slot is
+ *         not valid
+ */
+guint keepalive_timeout_add_slot(gint priority, background_activity_frequency_t slot, GSourceFunc function, gpointer data, GDestroyNotify notify);
+
+/** Keepalive timeout that may block suspend instead of using IPHB
+ *
+ * Short timeouts are cheaper to implement by blocking suspend via
+ * CPU-keepalive session shared by the whole process and using a normal
+ * monotonic timer with millisecond resolution, than by making round
+ * trips to DSME and MCE via IPHB. This is called hybrid mode.
+ *
+ * Hybrid mode is used if the interval is shorter than the threshold
+ * set via keepalive_timeout_set_hybrid_threshold(). It is used also for
+ * intervals shorter than one minute, if the shared keepalive is already
+ * held for other reasons, e.g. due to other pending hybrid mode timeouts
+ * or keepalive idle callbacks. A hybrid mode timeout that is being
+ * dispatched does not count as such a reason.
+ *
+ * Hybrid mode covers only the first interval. If the callback returns
+ * TRUE, further calls are scheduled via IPHB using wakeup range of
+ * [interval, interval + 1 second] and the device is allowed to suspend
+ * in between. Note that callbacks that keep re-adding short hybrid
+ * mode timeouts keep blocking suspend.
+ *
+ * @param priority  the priority of the timeout source
+ * @param interval  the time between calls to the function, in milliseconds
+ * @param function  function to call
+ * @param data      data to pass to function
+ * @param notify    function to call when the timeout is removed, or NULL.
+ *
+ * @return the ID (greater than 0) of the event source
+ */
+guint keepalive_timeout_add_hybrid(gint priority, guint interval, GSourceFunc function, gpointer data, GDestroyNotify notify);
+
+/** Set upper limit for timeouts that are handled in hybrid mode
+ *
+ * Affects only timeouts that are added via keepalive_timeout_add_hybrid()
+ * after the call.
+ *
+ * By default timeouts shorter than 12 seconds use hybrid mode.
+ *
+ * @param interval  threshold in milliseconds, or 0 to disable hybrid mode
+ */
+void keepalive_timeout_set_hybrid_threshold(guint interval);
+
+/** Get upper limit for timeouts that are handled in hybrid mode
+ *
+ * @return threshold in milliseconds, or 0 if hybrid mode is disabled
+ */
+guint keepalive_timeout_get_hybrid_threshold(void);
+
 # pragma GCC visibility pop
 
 # ifdef __cplusplus
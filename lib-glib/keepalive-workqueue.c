@@ -0,0 +1,484 @@
+/****************************************************************************************
+**
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of nemo-keepalive package.
+**
+** You may use this file under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+****************************************************************************************/
+
+#include "keepalive-workqueue.h"
+
+#include "logging.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include <glib.h>
+
+/* ========================================================================= *
+ * CONSTANTS
+ * ========================================================================= */
+
+/** Logging prefix for this module */
+#define PFIX "workqueue: "
+
+/* ========================================================================= *
+ * TYPES
+ * ========================================================================= */
+
+/** Background work item */
+struct background_work_t
+{
+    /** Queue the work item belongs to */
+    background_work_queue_t    *bgw_queue;
+
+    /** Work function */
+    background_work_fn          bgw_func;
+
+    /** Data for work function */
+    void                       *bgw_data;
+
+    /** Function for releasing bgw_data */
+    background_activity_free_fn bgw_free_cb;
+
+    /** Next item in queue */
+    background_work_t          *bgw_next;
+};
+
+/** Background work queue */
+struct background_work_queue_t
+{
+    /** Activity object used for waking up and keeping device awake */
+    background_activity_t          *bwq_activity;
+
+    /** Global wakeup slot */
+    background_activity_frequency_t bwq_slot;
+
+    /** Maximum number of concurrently executing work items */
+    unsigned                        bwq_parallelism;
+
+    /** Work items waiting to be executed */
+    background_work_t              *bwq_head;
+    background_work_t              *bwq_tail;
+
+    /** Number of queued work items */
+    unsigned                        bwq_queued;
+
+    /** Number of executing work items */
+    unsigned                        bwq_inflight;
+
+    /** Idle callback id for starting work items */
+    guint                           bwq_dispatch_id;
+
+    /** Flag for: background_work_queue_free() has been called */
+    bool                            bwq_released;
+};
+
+/* ========================================================================= *
+ * Prototypes
+ * ========================================================================= */
+
+/* ------------------------------------------------------------------------- *
+ * WORK_ITEM
+ * ------------------------------------------------------------------------- */
+
+static background_work_t       *background_work_create           (background_work_queue_t *queue, background_work_fn func, void *data, background_activity_free_fn free_cb);
+static void                     background_work_delete           (background_work_t *self);
+
+/* ------------------------------------------------------------------------- *
+ * WORK_QUEUE
+ * ------------------------------------------------------------------------- */
+
+static background_work_t       *background_work_queue_pop        (background_work_queue_t *self);
+static void                     background_work_queue_delete     (background_work_queue_t *self);
+static void                     background_work_queue_activate   (background_work_queue_t *self);
+static void                     background_work_queue_rethink    (background_work_queue_t *self);
+static void                     background_work_queue_dispatch   (background_work_queue_t *self);
+static gboolean                 background_work_queue_dispatch_cb(gpointer aptr);
+static void                     background_work_queue_schedule   (background_work_queue_t *self);
+static void                     background_work_queue_running_cb (background_activity_t *activity, void *aptr);
+
+/* ------------------------------------------------------------------------- *
+ * EXTERNAL_API
+ * ------------------------------------------------------------------------- */
+
+background_work_queue_t        *background_work_queue_new            (background_activity_frequency_t slot);
+background_work_queue_t        *background_work_queue_shared         (background_activity_frequency_t slot);
+void                            background_work_queue_free           (background_work_queue_t *self);
+void                            background_work_queue_set_parallelism(background_work_queue_t *self, unsigned parallelism);
+unsigned                        background_work_queue_get_parallelism(const background_work_queue_t *self);
+background_activity_frequency_t background_work_queue_get_slot       (const background_work_queue_t *self);
+void                            background_work_queue_enqueue        (background_work_queue_t *self, background_work_fn func, void *data, background_activity_free_fn free_cb);
+unsigned                        background_work_queue_get_pending    (const background_work_queue_t *self);
+void                            background_work_done                 (background_work_t *work);
+
+/* ========================================================================= *
+ * WORK_ITEM
+ * ========================================================================= */
+
+static background_work_t *
+background_work_create(background_work_queue_t *queue,
+                       background_work_fn func,
+                       void *data,
+                       background_activity_free_fn free_cb)
+{
+    background_work_t *self = calloc(1, sizeof *self);
+
+    if( self ) {
+        self->bgw_queue   = queue;
+        self->bgw_func    = func;
+        self->bgw_data    = data;
+        self->bgw_free_cb = free_cb;
+        self->bgw_next    = 0;
+    }
+
+    return self;
+}
+
+static void
+background_work_delete(background_work_t *self)
+{
+    if( self->bgw_free_cb )
+        self->bgw_free_cb(self->bgw_data);
+    free(self);
+}
+
+/* ========================================================================= *
+ * WORK_QUEUE
+ * ========================================================================= */
+
+static background_work_t *
+background_work_queue_pop(background_work_queue_t *self)
+{
+    background_work_t *work = self->bwq_head;
+
+    if( work ) {
+        if( !(self->bwq_head = work->bgw_next) )
+            self->bwq_tail = 0;
+        work->bgw_next = 0;
+        self->bwq_queued -= 1;
+    }
+
+    return work;
+}
+
+static void
+background_work_queue_delete(background_work_queue_t *self)
+{
+    log_function("%p", self);
+
+    background_activity_set_running_callback(self->bwq_activity, 0);
+    background_activity_stop(self->bwq_activity);
+    background_activity_unref(self->bwq_activity),
+        self->bwq_activity = 0;
+
+    free(self);
+}
+
+/** Make sure queued work gets executed
+ *
+ * If work is already being done, queued items are started within the
+ * same wakeup window. Otherwise wait for the next wakeup slot.
+ */
+static void
+background_work_queue_activate(background_work_queue_t *self)
+{
+    if( background_activity_is_running(self->bwq_activity) ) {
+        background_work_queue_schedule(self);
+    }
+    else if( self->bwq_slot == BACKGROUND_ACTIVITY_FREQUENCY_RANGE ) {
+        background_activity_run(self->bwq_activity);
+    }
+    else if( !background_activity_is_waiting(self->bwq_activity) ) {
+        background_activity_wait(self->bwq_activity);
+    }
+}
+
+/** Release keepalive as soon as there is nothing left to do
+ */
+static void
+background_work_queue_rethink(background_work_queue_t *self)
+{
+    if( self->bwq_inflight > 0 || self->bwq_head )
+        return;
+
+    if( self->bwq_dispatch_id ) {
+        g_source_remove(self->bwq_dispatch_id),
+            self->bwq_dispatch_id = 0;
+    }
+
+    if( background_activity_is_running(self->bwq_activity) ) {
+        log_debug(PFIX"%p: drained", self);
+        background_activity_stop(self->bwq_activity);
+    }
+}
+
+/** Start queued work items up to configured parallelism
+ */
+static void
+background_work_queue_dispatch(background_work_queue_t *self)
+{
+    while( !self->bwq_released &&
+           self->bwq_inflight < self->bwq_parallelism ) {
+        background_work_t *work = background_work_queue_pop(self);
+        if( !work )
+            break;
+
+        self->bwq_inflight += 1;
+
+        /* Note: Calling background_work_done() from within the
+         *       work function is allowed -> do not touch the work
+         *       item after this. */
+        work->bgw_func(work, work->bgw_data);
+    }
+
+    background_work_queue_rethink(self);
+}
+
+static gboolean
+background_work_queue_dispatch_cb(gpointer aptr)
+{
+    background_work_queue_t *self = aptr;
+
+    log_function("%p", self);
+
+    if( self->bwq_dispatch_id ) {
+        self->bwq_dispatch_id = 0;
+        background_work_queue_dispatch(self);
+    }
+
+    return G_SOURCE_REMOVE;
+}
+
+/** Schedule start of queued work items from an idle callback
+ *
+ * Used for avoiding recursion when work items are finished or added
+ * from within work functions.
+ */
+static void
+background_work_queue_schedule(background_work_queue_t *self)
+{
+    if( !self->bwq_dispatch_id && !self->bwq_released ) {
+        self->bwq_dispatch_id =
+            g_idle_add(background_work_queue_dispatch_cb, self);
+    }
+}
+
+static void
+background_work_queue_running_cb(background_activity_t *activity,
+                                 void *aptr)
+{
+    (void)activity;
+
+    background_work_queue_t *self = aptr;
+
+    log_function("%p", self);
+
+    background_work_queue_dispatch(self);
+}
+
+/* ========================================================================= *
+ * SHARED_QUEUES
+ * ========================================================================= */
+
+/** List of process wide shared queues */
+static GSList *background_work_queue_shared_list = 0;
+
+/* ========================================================================= *
+ * EXTERNAL_API  --  documented in: keepalive-workqueue.h
+ * ========================================================================= */
+
+background_work_queue_t *
+background_work_queue_new(background_activity_frequency_t slot)
+{
+    background_work_queue_t *self = calloc(1, sizeof *self);
+
+    if( !self )
+        goto cleanup;
+
+    self->bwq_activity    = background_activity_new();
+    self->bwq_slot        = slot;
+    self->bwq_parallelism = 1;
+    self->bwq_head        = 0;
+    self->bwq_tail        = 0;
+    self->bwq_queued      = 0;
+    self->bwq_inflight    = 0;
+    self->bwq_dispatch_id = 0;
+    self->bwq_released    = false;
+
+    if( slot != BACKGROUND_ACTIVITY_FREQUENCY_RANGE )
+        background_activity_set_wakeup_slot(self->bwq_activity, slot);
+
+    background_activity_set_running_callback(self->bwq_activity,
+                                             background_work_queue_running_cb);
+    background_activity_set_user_data(self->bwq_activity, self, 0);
+
+cleanup:
+    log_function("%p", self);
+    return self;
+}
+
+background_work_queue_t *
+background_work_queue_shared(background_activity_frequency_t slot)
+{
+    background_work_queue_t *self = 0;
+
+    for( GSList *item = background_work_queue_shared_list; item;
+         item = item->next ) {
+        background_work_queue_t *queue = item->data;
+        if( queue->bwq_slot == slot ) {
+            self = queue;
+            goto cleanup;
+        }
+    }
+
+    if( (self = background_work_queue_new(slot)) ) {
+        background_work_queue_shared_list =
+            g_slist_prepend(background_work_queue_shared_list, self);
+    }
+
+cleanup:
+    return self;
+}
+
+void
+background_work_queue_free(background_work_queue_t *self)
+{
+    log_function("%p", self);
+
+    if( !self )
+        goto cleanup;
+
+    if( g_slist_find(background_work_queue_shared_list, self) ) {
+        log_warning(PFIX"%p: attempt to free shared queue", self);
+        goto cleanup;
+    }
+
+    self->bwq_released = true;
+
+    if( self->bwq_dispatch_id ) {
+        g_source_remove(self->bwq_dispatch_id),
+            self->bwq_dispatch_id = 0;
+    }
+
+    background_work_t *work;
+    while( (work = background_work_queue_pop(self)) )
+        background_work_delete(work);
+
+    /* Work in progress keeps the queue alive */
+    if( self->bwq_inflight == 0 )
+        background_work_queue_delete(self);
+
+cleanup:
+    return;
+}
+
+void
+background_work_queue_set_parallelism(background_work_queue_t *self,
+                                      unsigned parallelism)
+{
+    if( parallelism < 1 )
+        parallelism = 1;
+
+    if( self->bwq_parallelism != parallelism ) {
+        self->bwq_parallelism = parallelism;
+        if( background_activity_is_running(self->bwq_activity) )
+            background_work_queue_schedule(self);
+    }
+}
+
+unsigned
+background_work_queue_get_parallelism(const background_work_queue_t *self)
+{
+    return self->bwq_parallelism;
+}
+
+background_activity_frequency_t
+background_work_queue_get_slot(const background_work_queue_t *self)
+{
+    return self->bwq_slot;
+}
+
+void
+background_work_queue_enqueue(background_work_queue_t *self,
+                              background_work_fn func,
+                              void *data,
+                              background_activity_free_fn free_cb)
+{
+    background_work_t *work = 0;
+
+    if( !self || !func || self->bwq_released )
+        goto cleanup;
+
+    if( !(work = background_work_create(self, func, data, free_cb)) )
+        goto cleanup;
+
+    if( self->bwq_tail )
+        self->bwq_tail->bgw_next = work;
+    else
+        self->bwq_head = work;
+    self->bwq_tail = work;
+    self->bwq_queued += 1;
+
+    background_work_queue_activate(self);
+
+cleanup:
+    return;
+}
+
+unsigned
+background_work_queue_get_pending(const background_work_queue_t *self)
+{
+    return self->bwq_queued + self->bwq_inflight;
+}
+
+void
+background_work_done(background_work_t *work)
+{
+    if( !work )
+        goto cleanup;
+
+    background_work_queue_t *self = work->bgw_queue;
+
+    background_work_delete(work);
+
+    if( self->bwq_inflight == 0 ) {
+        log_warning(PFIX"%p: unbalanced work done", self);
+        goto cleanup;
+    }
+
+    self->bwq_inflight -= 1;
+
+    if( self->bwq_released ) {
+        if( self->bwq_inflight == 0 )
+            background_work_queue_delete(self);
+        goto cleanup;
+    }
+
+    /* Start the next item or release keepalive right away */
+    if( self->bwq_head )
+        background_work_queue_schedule(self);
+    else
+        background_work_queue_rethink(self);
+
+cleanup:
+    return;
+}
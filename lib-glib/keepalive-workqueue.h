@@ -0,0 +1,177 @@
+/****************************************************************************************
+**
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of nemo-keepalive package.
+**
+** You may use this file under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+****************************************************************************************/
+
+/** @file keepalive-workqueue.h
+ *
+ * @brief Provides queue for executing background work within
+ *        shared wakeup windows.
+ */
+
+#ifndef KEEPALIVE_GLIB_WORKQUEUE_H_
+# define KEEPALIVE_GLIB_WORKQUEUE_H_
+
+# include "keepalive-backgroundactivity.h"
+
+# ifdef __cplusplus
+extern "C" {
+# elif 0
+} /* fool JED indentation ... */
+# endif
+
+# pragma GCC visibility push(default)
+
+/** Opaque background work queue structure
+ *
+ * Allocate via background_work_queue_new() and release via
+ * background_work_queue_free(), or use process wide queues
+ * available via background_work_queue_shared().
+ */
+typedef struct background_work_queue_t background_work_queue_t;
+
+/** Opaque background work item structure
+ *
+ * Allocated by background_work_queue_enqueue() and released
+ * after background_work_done() has been called.
+ */
+typedef struct background_work_t background_work_t;
+
+/** Prototype for background work functions
+ *
+ * Called from the main loop while the queue is keeping the device
+ * awake. When the work is finished - either before returning or
+ * later on from some asynchronous callback - background_work_done()
+ * MUST be called.
+ *
+ * @param work  work item handle
+ * @param data  data pointer as given to background_work_queue_enqueue()
+ */
+typedef void (*background_work_fn)(background_work_t *work, void *data);
+
+/** Create background work queue
+ *
+ * Work items added to the queue are executed at the next wakeup of
+ * the given global slot, under a single background activity object.
+ * The device is kept awake until the queue has been drained, after
+ * which the cpu keepalive is released immediately.
+ *
+ * If BACKGROUND_ACTIVITY_FREQUENCY_RANGE is used as slot, work items
+ * are executed as soon as possible instead of waiting for a wakeup.
+ *
+ * Background work queues must be used only from the main thread.
+ *
+ * @param slot  global wakeup slot to use
+ *
+ * @return queue object
+ */
+background_work_queue_t *background_work_queue_new(background_activity_frequency_t slot);
+
+/** Get process wide shared background work queue
+ *
+ * Unrelated modules that need to do work at the same global slot
+ * should use the shared queue so that all the work gets done within
+ * one wakeup window.
+ *
+ * The returned queue is owned by the library and must not be freed.
+ *
+ * @param slot  global wakeup slot to use
+ *
+ * @return queue object
+ */
+background_work_queue_t *background_work_queue_shared(background_activity_frequency_t slot);
+
+/** Release background work queue
+ *
+ * Work items that have not been started are discarded. Work items
+ * that are in progress must still be finished via background_work_done().
+ *
+ * @param self  queue object, or NULL
+ */
+void background_work_queue_free(background_work_queue_t *self);
+
+/** Set maximum number of concurrently executing work items
+ *
+ * By default work items are executed one at a time.
+ *
+ * @param self         queue object
+ * @param parallelism  number of work items, values less than 1 are
+ *                     treated as 1
+ */
+void background_work_queue_set_parallelism(background_work_queue_t *self, unsigned parallelism);
+
+/** Get maximum number of concurrently executing work items
+ *
+ * @param self  queue object
+ *
+ * @return number of work items
+ */
+unsigned background_work_queue_get_parallelism(const background_work_queue_t *self);
+
+/** Get global wakeup slot used by background work queue
+ *
+ * @param self  queue object
+ *
+ * @return global wakeup slot
+ */
+background_activity_frequency_t background_work_queue_get_slot(const background_work_queue_t *self);
+
+/** Add work item to background work queue
+ *
+ * If the queue is already executing work, the item is executed within
+ * the same wakeup window. Otherwise the next wakeup is waited for.
+ *
+ * @param self     queue object
+ * @param func     work function
+ * @param data     data to pass to work function
+ * @param free_cb  function for releasing data after the work is done
+ *                 or discarded, or NULL
+ */
+void background_work_queue_enqueue(background_work_queue_t *self, background_work_fn func, void *data, background_activity_free_fn free_cb);
+
+/** Get number of unfinished work items
+ *
+ * @param self  queue object
+ *
+ * @return number of queued and executing work items
+ */
+unsigned background_work_queue_get_pending(const background_work_queue_t *self);
+
+/** Mark work item finished
+ *
+ * Must be called exactly once for each work item that has been passed
+ * to a background_work_fn callback. The work item is released and must
+ * not be used after the call.
+ *
+ * @param work  work item handle
+ */
+void background_work_done(background_work_t *work);
+
+# pragma GCC visibility pop
+
+# ifdef __cplusplus
+};
+# endif
+
+#endif /* KEEPALIVE_GLIB_WORKQUEUE_H_ */
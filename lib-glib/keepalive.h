@@ -70,6 +70,11 @@
  *
  * Example: @ref periodic-wakeup.c "periodic-wakeup.c"
  *
+ * When several modules within a process need to do work at the same
+ * global wakeup slot, they can use a shared background work queue from
+ * keepalive-workqueue.h instead of individual background activities.
+ * The work is then done back to back within one wakeup window.
+ *
  * @section glibtimercompat GLib Timeout Compatibility API
  *
  * In some cases application just needs to ensure it wakes up to handle
@@ -79,6 +84,24 @@
  *
  * Example: @ref simple-timer-wakeup.c "simple-timer-wakeup.c"
  *
+ * Similarly keepalive-idle.h provides idle callbacks that keep the
+ * device from suspending until they have been dispatched.
+ *
+ * @section executor Thread Pool Execution
+ *
+ * Work that is offloaded to worker threads should not get stalled by
+ * device suspend. The keepalive executor from keepalive-executor.h
+ * wraps GThreadPool and keeps the device awake while there are queued
+ * or executing jobs. Completion is reported back via the main context
+ * that created the executor.
+ *
+ * @section accounting Power Accounting
+ *
+ * To find out which components are keeping the device awake, wakeups,
+ * running time and IPC counts are tracked for background activity and
+ * CPU-keepalive objects. Use functionality listed in
+ * keepalive-accounting.h
+ *
  */
 
 /** @example keep-display-on.c
@@ -124,6 +147,10 @@ extern "C" {
 # include "keepalive-displaykeepalive.h"
 # include "keepalive-backgroundactivity.h"
 # include "keepalive-timeout.h"
+# include "keepalive-idle.h"
+# include "keepalive-executor.h"
+# include "keepalive-workqueue.h"
+# include "keepalive-accounting.h"
 
 # ifdef __cplusplus
 };
@@ -0,0 +1,149 @@
+/****************************************************************************************
+**
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of nemo-keepalive package.
+**
+** You may use this file under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+****************************************************************************************/
+
+#include "sharedkeepalive.h"
+#include "keepalive-cpukeepalive.h"
+
+#include "logging.h"
+
+#include <stdlib.h>
+
+#include <pthread.h>
+
+/* ========================================================================= *
+ * Prototypes
+ * ========================================================================= */
+
+/* ------------------------------------------------------------------------- *
+ * SHARED_KEEPALIVE
+ * ------------------------------------------------------------------------- */
+
+static void sharedkeepalive_lock  (void);
+static void sharedkeepalive_unlock(void);
+
+void        sharedkeepalive_acquire(void);
+void        sharedkeepalive_release(void);
+bool        sharedkeepalive_is_held(void);
+unsigned    sharedkeepalive_get_holders(void);
+
+/* ========================================================================= *
+ * SHARED_KEEPALIVE
+ * ========================================================================= */
+
+/** Mutex for protecting shared keepalive state */
+static pthread_mutex_t sharedkeepalive_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/** CPU keepalive object shared by all holders within the process
+ *
+ * Created on first use and then kept around until process exit.
+ */
+static cpukeepalive_t *sharedkeepalive_object = 0;
+
+/** Number of active holders */
+static unsigned sharedkeepalive_count = 0;
+
+static void
+sharedkeepalive_lock(void)
+{
+    if( pthread_mutex_lock(&sharedkeepalive_mutex) != 0 )
+        log_abort("shared keepalive mutex lock failed");
+}
+
+static void
+sharedkeepalive_unlock(void)
+{
+    if( pthread_mutex_unlock(&sharedkeepalive_mutex) != 0 )
+        log_abort("shared keepalive mutex unlock failed");
+}
+
+/** Add holder to process wide shared CPU keepalive
+ *
+ * The CPU keepalive session is started when the first holder
+ * is added.
+ */
+void
+sharedkeepalive_acquire(void)
+{
+    sharedkeepalive_lock();
+
+    if( sharedkeepalive_count++ == 0 ) {
+        if( !sharedkeepalive_object )
+            sharedkeepalive_object = cpukeepalive_new();
+        log_debug("shared keepalive: start");
+        cpukeepalive_start(sharedkeepalive_object);
+    }
+
+    sharedkeepalive_unlock();
+}
+
+/** Remove holder from process wide shared CPU keepalive
+ *
+ * The CPU keepalive session is stopped when the last holder is
+ * removed. As cpukeepalive_t evaluates start/stop requests from
+ * an idle callback, holders that come and go within the same
+ * mainloop iteration do not cause any D-Bus traffic.
+ */
+void
+sharedkeepalive_release(void)
+{
+    sharedkeepalive_lock();
+
+    if( sharedkeepalive_count == 0 ) {
+        log_warning("shared keepalive: unbalanced release");
+    }
+    else if( --sharedkeepalive_count == 0 ) {
+        log_debug("shared keepalive: stop");
+        cpukeepalive_stop(sharedkeepalive_object);
+    }
+
+    sharedkeepalive_unlock();
+}
+
+/** Predicate for: process wide shared CPU keepalive has holders
+ *
+ * @return true if there are holders, false otherwise
+ */
+bool
+sharedkeepalive_is_held(void)
+{
+    sharedkeepalive_lock();
+    bool held = sharedkeepalive_count > 0;
+    sharedkeepalive_unlock();
+    return held;
+}
+
+/** Get number of process wide shared CPU keepalive holders
+ *
+ * @return number of holders
+ */
+unsigned
+sharedkeepalive_get_holders(void)
+{
+    sharedkeepalive_lock();
+    unsigned holders = sharedkeepalive_count;
+    sharedkeepalive_unlock();
+    return holders;
+}
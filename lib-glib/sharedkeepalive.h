@@ -0,0 +1,53 @@
+/****************************************************************************************
+**
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of nemo-keepalive package.
+**
+** You may use this file under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+****************************************************************************************/
+
+#ifndef KEEPALIVE_GLIB_SHAREDKEEPALIVE_H_
+# define KEEPALIVE_GLIB_SHAREDKEEPALIVE_H_
+
+# include <stdbool.h>
+
+# ifdef __cplusplus
+extern "C" {
+# elif 0
+} /* fool JED indentation ... */
+# endif
+
+/* Internal to libkeepalive-glib - documented at source code
+ *
+ * These functions are not exported and the header must not
+ * be included in the devel package
+ */
+
+void sharedkeepalive_acquire(void);
+void sharedkeepalive_release(void);
+bool sharedkeepalive_is_held(void);
+unsigned sharedkeepalive_get_holders(void);
+
+# ifdef __cplusplus
+};
+# endif
+
+#endif // KEEPALIVE_GLIB_SHAREDKEEPALIVE_H_
@@ -0,0 +1,216 @@
+/****************************************************************************************
+**
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of nemo-keepalive package.
+**
+** You may use this file under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+****************************************************************************************/
+
+#include "wakeupdelay.h"
+
+#include "logging.h"
+
+/* ========================================================================= *
+ * Prototypes
+ * ========================================================================= */
+
+/* ------------------------------------------------------------------------- *
+ * WAKEUP_DELAY
+ * ------------------------------------------------------------------------- */
+
+time_t wakeup_delay_clock_now   (background_activity_clock_t clock);
+void   wakeup_delay_set_slot    (wakeup_delay_t *self, background_activity_frequency_t slot);
+void   wakeup_delay_set_range   (wakeup_delay_t *self, int range_lo, int range_hi);
+void   wakeup_delay_set_deadline(wakeup_delay_t *self, background_activity_clock_t clock, time_t deadline_lo, time_t deadline_hi);
+void   wakeup_delay_evaluate    (wakeup_delay_t *self);
+bool   wakeup_delay_eq_p        (const wakeup_delay_t *self, const wakeup_delay_t *that);
+
+/* ========================================================================= *
+ * WAKEUP_DELAY
+ * ========================================================================= */
+
+/** Default initial wakeup delay */
+const wakeup_delay_t wakeup_delay_default =
+{
+    .wd_slot     = BACKGROUND_ACTIVITY_FREQUENCY_ONE_HOUR,
+    .wd_range_lo = BACKGROUND_ACTIVITY_FREQUENCY_ONE_HOUR,
+    .wd_range_hi = BACKGROUND_ACTIVITY_FREQUENCY_ONE_HOUR,
+    .wd_absolute = false,
+};
+
+/** Get current time of a deadline clock
+ *
+ * @param clock  BACKGROUND_ACTIVITY_CLOCK_BOOTTIME|REALTIME
+ *
+ * @return current time in seconds
+ */
+time_t
+wakeup_delay_clock_now(background_activity_clock_t clock)
+{
+    struct timespec ts = { 0, 0 };
+    clockid_t       id = CLOCK_BOOTTIME;
+
+    if( clock == BACKGROUND_ACTIVITY_CLOCK_REALTIME )
+        id = CLOCK_REALTIME;
+
+    if( clock_gettime(id, &ts) == -1 )
+        log_error("clock_gettime: %m");
+
+    return ts.tv_sec;
+}
+
+/** Set wakeup delay to use global wakeup slot
+ *
+ * @param self  wake up delay object
+ * @param slot  global wakeup slot to use
+ */
+void
+wakeup_delay_set_slot(wakeup_delay_t *self,
+                      background_activity_frequency_t slot)
+{
+    // basically it is just a second count, but it must be
+
+    // a) not smaller than the smallest allowed global slot
+
+    if( slot < BACKGROUND_ACTIVITY_FREQUENCY_THIRTY_SECONDS )
+        slot = BACKGROUND_ACTIVITY_FREQUENCY_THIRTY_SECONDS;
+
+    // b) evenly divisible by the smallest allowed global slot
+
+    slot = slot - (slot % BACKGROUND_ACTIVITY_FREQUENCY_THIRTY_SECONDS);
+
+    self->wd_slot     = slot;
+    self->wd_range_lo = slot;
+    self->wd_range_hi = slot;
+    self->wd_absolute = false;
+}
+
+/** Set wakeup delay to use wakeup range
+ *
+ * @param self      wake up delay object
+ * @param range_lo  minimum seconds to wait
+ * @param range_hi  maximum seconds to wait
+ */
+void
+wakeup_delay_set_range(wakeup_delay_t *self,
+                       int range_lo, int range_hi)
+{
+    /* Zero wait is not supported */
+    if( range_lo < 1 )
+        range_lo = 1;
+
+    /* Expand invalid range to heartbeat length */
+    if( range_hi <= range_lo )
+        range_hi = range_lo + BACKGROUND_ACTIVITY_HEARTBEAT_PERIOD;
+
+    self->wd_slot     = BACKGROUND_ACTIVITY_FREQUENCY_RANGE;
+    self->wd_range_lo = range_lo;
+    self->wd_range_hi = range_hi;
+    self->wd_absolute = false;
+}
+
+/** Set wakeup delay to use absolute deadlines
+ *
+ * @param self         wake up delay object
+ * @param clock        clock the deadlines are expressed in
+ * @param deadline_lo  earliest wakeup time
+ * @param deadline_hi  latest wakeup time
+ */
+void
+wakeup_delay_set_deadline(wakeup_delay_t *self,
+                          background_activity_clock_t clock,
+                          time_t deadline_lo, time_t deadline_hi)
+{
+    if( clock != BACKGROUND_ACTIVITY_CLOCK_REALTIME )
+        clock = BACKGROUND_ACTIVITY_CLOCK_BOOTTIME;
+
+    /* Expand invalid window to heartbeat length */
+    if( deadline_hi <= deadline_lo )
+        deadline_hi = deadline_lo + BACKGROUND_ACTIVITY_HEARTBEAT_PERIOD;
+
+    self->wd_slot        = BACKGROUND_ACTIVITY_FREQUENCY_RANGE;
+    self->wd_absolute    = true;
+    self->wd_clock       = clock;
+    self->wd_deadline_lo = deadline_lo;
+    self->wd_deadline_hi = deadline_hi;
+
+    wakeup_delay_evaluate(self);
+}
+
+/** Update relative wakeup range from absolute deadlines
+ *
+ * Does nothing if absolute deadlines are not in use.
+ *
+ * @param self  wake up delay object
+ */
+void
+wakeup_delay_evaluate(wakeup_delay_t *self)
+{
+    if( !self->wd_absolute )
+        goto cleanup;
+
+    const time_t limit = BACKGROUND_ACTIVITY_FREQUENCY_MAXIMUM_FREQUENCY;
+    time_t       now   = wakeup_delay_clock_now(self->wd_clock);
+    time_t       lo    = self->wd_deadline_lo - now;
+    time_t       hi    = self->wd_deadline_hi - now;
+
+    /* Passed deadlines -> wake up as soon as possible */
+    if( lo < 1 )
+        lo = 1;
+
+    if( lo > limit - 1 )
+        lo = limit - 1;
+
+    /* Note that equal lo and hi would make IPHB treat
+     * the wakeup as global slot instead of range */
+    if( hi <= lo )
+        hi = lo + 1;
+
+    if( hi > limit )
+        hi = limit;
+
+    self->wd_range_lo = (int)lo;
+    self->wd_range_hi = (int)hi;
+
+cleanup:
+    return;
+}
+
+/** Predicate for: two wake up delay objects are the same
+ *
+ * @param self      wake up delay object
+ */
+bool
+wakeup_delay_eq_p(const wakeup_delay_t *self, const wakeup_delay_t *that)
+{
+    if( self->wd_absolute != that->wd_absolute )
+        return false;
+
+    /* Relative range changes as time passes, compare deadlines */
+    if( self->wd_absolute )
+        return (self->wd_clock       == that->wd_clock       &&
+                self->wd_deadline_lo == that->wd_deadline_lo &&
+                self->wd_deadline_hi == that->wd_deadline_hi);
+
+    return (self->wd_slot     == that->wd_slot     &&
+            self->wd_range_lo == that->wd_range_lo &&
+            self->wd_range_hi == that->wd_range_hi);
+}
@@ -0,0 +1,93 @@
+/****************************************************************************************
+**
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of nemo-keepalive package.
+**
+** You may use this file under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+****************************************************************************************/
+
+#ifndef KEEPALIVE_GLIB_WAKEUPDELAY_H_
+# define KEEPALIVE_GLIB_WAKEUPDELAY_H_
+
+# include "keepalive-backgroundactivity.h"
+
+# include <stdbool.h>
+# include <time.h>
+
+# ifdef __cplusplus
+extern "C" {
+# elif 0
+} /* fool JED indentation ... */
+# endif
+
+/* Internal to libkeepalive-glib - documented at source code
+ *
+ * These functions are not exported and the header must not
+ * be included in the devel package. Offline tools such as the
+ * wakeup simulator may compile wakeupdelay.c in directly.
+ */
+
+/** Assumed hw watchdog kicking period DSME is using [s]
+ *
+ * Currently there is no way to tell what kind of period DSME
+ * is using - assume that it is 12 seconds */
+# define BACKGROUND_ACTIVITY_HEARTBEAT_PERIOD 12
+
+/** Wakeup delay using either Global slot or range */
+typedef struct
+{
+    /** Global wakeup slot, or BACKGROUND_ACTIVITY_FREQUENCY_RANGE
+     *  in case ranged wakeup is to be used */
+    background_activity_frequency_t wd_slot;
+
+    /** Minimum ranged wait period length */
+    int                             wd_range_lo;
+
+    /** Maximum ranged wait period length */
+    int                             wd_range_hi;
+
+    /** Flag for: range is evaluated from absolute deadlines */
+    bool                            wd_absolute;
+
+    /** Clock used for absolute deadlines */
+    background_activity_clock_t     wd_clock;
+
+    /** Earliest absolute wakeup time */
+    time_t                          wd_deadline_lo;
+
+    /** Latest absolute wakeup time */
+    time_t                          wd_deadline_hi;
+} wakeup_delay_t;
+
+extern const wakeup_delay_t wakeup_delay_default;
+
+time_t wakeup_delay_clock_now   (background_activity_clock_t clock);
+void   wakeup_delay_set_slot    (wakeup_delay_t *self, background_activity_frequency_t slot);
+void   wakeup_delay_set_range   (wakeup_delay_t *self, int range_lo, int range_hi);
+void   wakeup_delay_set_deadline(wakeup_delay_t *self, background_activity_clock_t clock, time_t deadline_lo, time_t deadline_hi);
+void   wakeup_delay_evaluate    (wakeup_delay_t *self);
+bool   wakeup_delay_eq_p        (const wakeup_delay_t *self, const wakeup_delay_t *that);
+
+# ifdef __cplusplus
+};
+# endif
+
+#endif /* KEEPALIVE_GLIB_WAKEUPDELAY_H_ */
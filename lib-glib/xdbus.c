@@ -48,6 +48,33 @@ xdbus_connection_is_valid(DBusConnection *con)
     return con && dbus_connection_get_is_connected(con);
 }
 
+/** Helper for constructing D-Bus method call messages
+ */
+static DBusMessage *
+xdbus_method_call_message_va(const char *service,
+                             const char *object,
+                             const char *interface,
+                             const char *method,
+                             int arg_type,
+                             va_list va)
+{
+    DBusMessage *req = dbus_message_new_method_call(service, object,
+                                                    interface, method);
+    if( !req )
+        goto cleanup;
+
+    if( arg_type != DBUS_TYPE_INVALID &&
+        !dbus_message_append_args_valist(req, arg_type, va) ) {
+        dbus_message_unref(req), req = 0;
+        goto cleanup;
+    }
+
+    log_notice(PFIX"calling method: %s.%s", interface, method);
+
+cleanup:
+    return req;
+}
+
 /** Helper for making asynchronous D-Bus method calls; varargs version
  */
 DBusPendingCall *
@@ -69,16 +96,11 @@ xdbus_method_call_va(DBusConnection *con,
     if( !xdbus_connection_is_valid(con) )
         goto cleanup;
 
-    req = dbus_message_new_method_call(service, object, interface, method);
+    req = xdbus_method_call_message_va(service, object, interface, method,
+                                       arg_type, va);
     if( !req )
         goto cleanup;
 
-    if( arg_type != DBUS_TYPE_INVALID &&
-        !dbus_message_append_args_valist(req, arg_type, va) )
-        goto cleanup;
-
-    log_notice(PFIX"calling method: %s.%s", interface, method);
-
     if( !notify_cb ) {
         dbus_message_set_no_reply(req, TRUE);
         dbus_connection_send(con, req, 0);
@@ -144,8 +166,10 @@ xdbus_method_call(DBusConnection *con,
 }
 
 /** Helper for making async D-Bus method calls without waiting for reply
+ *
+ * @return true if the message was queued for sending, false otherwise
  */
-void
+bool
 xdbus_simple_call(DBusConnection *con,
                   const char *service,
                   const char *object,
@@ -154,18 +178,33 @@ xdbus_simple_call(DBusConnection *con,
                   int arg_type,
                   ...)
 {
-    DBusPendingCall *res = 0;
+    bool         ack = false;
+    DBusMessage *req = 0;
 
     va_list va;
 
+    if( !xdbus_connection_is_valid(con) )
+        goto cleanup;
+
     va_start(va, arg_type);
-    res = xdbus_method_call_va(con, service, object, interface, method,
-                               0, 0, 0, arg_type, va);
+    req = xdbus_method_call_message_va(service, object, interface, method,
+                                       arg_type, va);
     va_end(va);
 
-    /* Note: this should never happen */
-    if( res ) {
-        dbus_pending_call_cancel(res);
-        dbus_pending_call_unref(res);
-    }
+    if( !req )
+        goto cleanup;
+
+    dbus_message_set_no_reply(req, TRUE);
+
+    if( !dbus_connection_send(con, req, 0) )
+        goto cleanup;
+
+    ack = true;
+
+cleanup:
+
+    if( req )
+        dbus_message_unref(req);
+
+    return ack;
 }
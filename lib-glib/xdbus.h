@@ -47,7 +47,7 @@ extern "C" {
 bool             xdbus_connection_is_valid (DBusConnection *con);
 DBusPendingCall *xdbus_method_call_va      (DBusConnection *con, const char *service, const char *object, const char *interface, const char *method, DBusPendingCallNotifyFunction notify_cb, void *data, DBusFreeFunction free_cb, int arg_type, va_list va);
 DBusPendingCall *xdbus_method_call         (DBusConnection *con, const char *service, const char *object, const char *interface, const char *method, DBusPendingCallNotifyFunction notify_cb, void *data, DBusFreeFunction free_cb, int arg_type, ...);
-void             xdbus_simple_call         (DBusConnection *con, const char *service, const char *object, const char *interface, const char *method, int arg_type, ...);
+bool             xdbus_simple_call         (DBusConnection *con, const char *service, const char *object, const char *interface, const char *method, int arg_type, ...);
 
 # ifdef __cplusplus
 };
@@ -40,9 +40,6 @@ BackgroundActivity::BackgroundActivity(QObject *parent)
 {
     TRACE
     priv = new BackgroundActivityPrivate(this);
-
-    QObject::connect(priv->m_heartbeat, SIGNAL(timeout()),
-                     this, SLOT(run()));
 }
 
 BackgroundActivity::~BackgroundActivity()
@@ -61,6 +58,18 @@ void BackgroundActivity::wakeupRange(int &min_delay, int &max_delay) const
     priv->wakeupRange(min_delay, max_delay);
 }
 
+bool BackgroundActivity::wakeupDeadline(QDateTime &earliest,
+                                        QDateTime &latest) const
+{
+    qint64 lo = 0, hi = 0;
+    if (!priv->wakeupDeadline(lo, hi)) {
+        return false;
+    }
+    earliest = QDateTime::fromMSecsSinceEpoch(lo * 1000);
+    latest   = QDateTime::fromMSecsSinceEpoch(hi * 1000);
+    return true;
+}
+
 void BackgroundActivity::setWakeupFrequency(Frequency slot)
 {
     TRACE
@@ -73,6 +82,15 @@ void BackgroundActivity::setWakeupRange(int min_delay, int max_delay)
     priv->setWakeupRange(min_delay, max_delay);
 }
 
+void BackgroundActivity::setWakeupDeadline(const QDateTime &earliest,
+                                           const QDateTime &latest)
+{
+    TRACE
+    qint64 lo = earliest.toMSecsSinceEpoch() / 1000;
+    qint64 hi = latest.isValid() ? latest.toMSecsSinceEpoch() / 1000 : lo;
+    priv->setWakeupDeadline(lo, hi);
+}
+
 BackgroundActivity::State BackgroundActivity::state() const
 {
     return priv->state();
@@ -102,6 +120,13 @@ void BackgroundActivity::wait(int min_delay, int max_delay)
     setWakeupRange(min_delay, max_delay), wait();
 }
 
+void BackgroundActivity::waitUntil(const QDateTime &earliest,
+                                   const QDateTime &latest)
+{
+    TRACE
+    setWakeupDeadline(earliest, latest), wait();
+}
+
 void BackgroundActivity::run()
 {
     TRACE
@@ -133,3 +158,20 @@ QString BackgroundActivity::id() const
 {
     return priv->id();
 }
+
+int BackgroundActivity::runBudget() const
+{
+    return priv->runBudget();
+}
+
+void BackgroundActivity::setRunBudget(int seconds,
+                                      BackgroundActivity::State overrun_state)
+{
+    TRACE
+    priv->setRunBudget(seconds, overrun_state);
+}
+
+unsigned BackgroundActivity::overrunCount() const
+{
+    return priv->overrunCount();
+}
@@ -33,6 +33,7 @@
 
 # include <QObject>
 # include <QEvent>
+# include <QDateTime>
 
 class BackgroundActivityPrivate;
 
@@ -73,6 +74,7 @@ public:
 
     Frequency wakeupFrequency() const;
     void wakeupRange(int &, int &) const;
+    bool wakeupDeadline(QDateTime &earliest, QDateTime &latest) const;
 
     bool isWaiting() const;
     bool isRunning() const;
@@ -81,13 +83,22 @@ public:
 
     void setWakeupFrequency(Frequency slot);
     void setWakeupRange(int min_delay, int max_delay);
+    void setWakeupDeadline(const QDateTime &earliest,
+                           const QDateTime &latest = QDateTime());
     void setState(BackgroundActivity::State new_state);
 
     void wait(Frequency slot);
     void wait(int min_delay, int max_delay = -1);
+    void waitUntil(const QDateTime &earliest,
+                   const QDateTime &latest = QDateTime());
 
     QString id() const;
 
+    int runBudget() const;
+    void setRunBudget(int seconds,
+                      BackgroundActivity::State overrun_state = Stopped);
+    unsigned overrunCount() const;
+
 public Q_SLOTS:
     void wait();
     void run();
@@ -102,6 +113,8 @@ Q_SIGNALS:
     void wakeupFrequencyChanged();
     void wakeupRangeChanged();
 
+    void overrun();
+
 private:
     Q_DISABLE_COPY(BackgroundActivity)
     BackgroundActivityPrivate *priv;
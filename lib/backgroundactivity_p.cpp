@@ -29,27 +29,22 @@
 ****************************************************************************************/
 
 #include "backgroundactivity_p.h"
-#include "heartbeat.h"
 #include "common.h"
 
-#include <QtGlobal>
+#include <QAbstractEventDispatcher>
+#include <QCoreApplication>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPointer>
 
-#include <errno.h>
+#include <dbus/dbus.h>
 
-#include <mce/dbus-names.h>
+#include "../dbus-gmain/dbus-gmain.h"
 
 /* ========================================================================= *
  * class BackgroundActivityPrivate
  * ========================================================================= */
 
-static QString get_unique_id()
-{
-    static unsigned id = 0;
-    char temp[32];
-    snprintf(temp, sizeof temp, "BlockSuspend-%u", ++id);
-    return QString(temp);
-}
-
 /* ------------------------------------------------------------------------- *
  * contructors & destructor
  * ------------------------------------------------------------------------- */
@@ -59,135 +54,185 @@ BackgroundActivityPrivate::BackgroundActivityPrivate(BackgroundActivity *parent)
 {
     pub = parent;
 
-    m_id = get_unique_id();
-
     // Default to: Stopped
     m_state = BackgroundActivity::Stopped;
 
-    // Default to: No wakeup defined
-    m_wakeup_freq = BackgroundActivity::Range;
-    m_wakeup_range_min = 0;
-    m_wakeup_range_max = 0;
-
-    m_heartbeat = new Heartbeat(this);
-
-    // The MCE D-Bus interface is created on demand
-    m_mce_interface = 0;
-
-    // Renew period has not been queried from MCE, but default to 1 minute
-    m_keepalive_queried = false;
-    m_keepalive_period  = 60; // [s]
-    m_keepalive_timer   = new QTimer();
-    connect(m_keepalive_timer, SIGNAL(timeout()), this, SLOT(renewKeepalivePeriod()));
+    m_usable = checkEventDispatcher();
+    setupSystemBus();
+
+    // IPHB wakeups, keepalive renewals, system time change tracking
+    // and running state budget are all handled by libkeepalive-glib.
+    // Notifications can be in flight while this object gets deleted
+    // -> glib object owns a guarded pointer that it releases when done
+    m_activity = background_activity_new();
+    background_activity_set_user_data(m_activity,
+                                      new QPointer<BackgroundActivityPrivate>(this),
+                                      glibUserDataFree);
+    background_activity_set_running_callback(m_activity, glibStateCallback);
+    background_activity_set_waiting_callback(m_activity, glibStateCallback);
+    background_activity_set_stopped_callback(m_activity, glibStateCallback);
+    background_activity_set_overrun_callback(m_activity, glibOverrunCallback);
 }
 
 BackgroundActivityPrivate::~BackgroundActivityPrivate()
 {
-    delete m_heartbeat;
-    delete m_keepalive_timer;
-    delete m_mce_interface;
+    // Internal references might keep the glib object alive for a
+    // while after we let go of it -> make sure notification
+    // callbacks are not active if that happens.
+    background_activity_set_running_callback(m_activity, 0);
+    background_activity_set_waiting_callback(m_activity, 0);
+    background_activity_set_stopped_callback(m_activity, 0);
+    background_activity_set_overrun_callback(m_activity, 0);
+
+    background_activity_stop(m_activity);
+    background_activity_unref(m_activity);
+    m_activity = 0;
 }
 
 /* ------------------------------------------------------------------------- *
- * keepalive timer
+ * libkeepalive-glib integration
  * ------------------------------------------------------------------------- */
 
+bool
+BackgroundActivityPrivate::checkEventDispatcher()
+{
+    static bool checked = false;
+    static bool usable = true;
+
+    QCoreApplication *app = QCoreApplication::instance();
+    if (checked || !app) {
+        return usable;
+    }
+    checked = true;
+
+    // Timers and io watches are attached to the default glib main
+    // context, which is dispatched only by glib based Qt event loop
+    QAbstractEventDispatcher *dispatcher =
+        QAbstractEventDispatcher::instance(app->thread());
+    if (dispatcher && !dispatcher->inherits("QEventDispatcherGlib")) {
+        qCritical("BackgroundActivity: event dispatcher %s is not glib based; "
+                  "wakeups and keepalive renewals can't be delivered",
+                  dispatcher->metaObject()->className());
+        usable = false;
+    }
+    return usable;
+}
+
 void
-BackgroundActivityPrivate::startKeepalivePeriod()
+BackgroundActivityPrivate::setupSystemBus()
 {
-    // Sanity check
-    if (m_state != BackgroundActivity::Running) {
+    static QBasicMutex mutex;
+    static bool done = false;
+
+    QMutexLocker locker(&mutex);
+    if (done) {
         return;
     }
-    TRACE
-
-    mceInterface()->req_cpu_keepalive_start(m_id);
-    m_keepalive_timer->setInterval(m_keepalive_period * 1000); // [ms]
-    m_keepalive_timer->start();
+    done = true;
+
+    // libkeepalive-glib uses shared libdbus system bus connection,
+    // which needs to be dispatched from glib main loop
+    DBusError err = DBUS_ERROR_INIT;
+    DBusConnection *bus = dbus_bus_get(DBUS_BUS_SYSTEM, &err);
+    if (!bus) {
+        qWarning("system bus connect failed: %s: %s", err.name, err.message);
+        dbus_error_free(&err);
+        return;
+    }
+    dbus_gmain_set_up_connection(bus, 0);
+    dbus_connection_unref(bus);
 }
 
 void
-BackgroundActivityPrivate::renewKeepalivePeriod()
+BackgroundActivityPrivate::glibUserDataFree(void *aptr)
 {
-    TRACE
-    mceInterface()->req_cpu_keepalive_start(m_id);
+    delete static_cast<QPointer<BackgroundActivityPrivate> *>(aptr);
 }
 
 void
-BackgroundActivityPrivate::stopKeepalivePeriod()
+BackgroundActivityPrivate::glibStateCallback(background_activity_t *activity,
+                                             void *aptr)
 {
-    TRACE
-    m_keepalive_timer->stop();
-    mceInterface()->req_cpu_keepalive_stop(m_id);
+    Q_UNUSED(activity);
+    QPointer<BackgroundActivityPrivate> *ref =
+        static_cast<QPointer<BackgroundActivityPrivate> *>(aptr);
+    BackgroundActivityPrivate *self = ref ? ref->data() : 0;
+    if (self) {
+        // Glib main loop runs in the main thread, activity might not
+        QMetaObject::invokeMethod(self, "glibStateReported", Qt::AutoConnection);
+    }
 }
 
-/* ------------------------------------------------------------------------- *
- * IPC with MCE
- * ------------------------------------------------------------------------- */
-
-ComNokiaMceRequestInterface *
-BackgroundActivityPrivate::mceInterface()
+void
+BackgroundActivityPrivate::glibOverrunCallback(background_activity_t *activity,
+                                               void *aptr)
 {
-    if (!m_mce_interface) {
-        //qDebug("@ %s\n", __PRETTY_FUNCTION__);
-        m_mce_interface = new ComNokiaMceRequestInterface(MCE_SERVICE,
-                                                          MCE_REQUEST_PATH,
-                                                          QDBusConnection::systemBus(),
-                                                          this);
+    Q_UNUSED(activity);
+    QPointer<BackgroundActivityPrivate> *ref =
+        static_cast<QPointer<BackgroundActivityPrivate> *>(aptr);
+    BackgroundActivityPrivate *self = ref ? ref->data() : 0;
+    if (self) {
+        QMetaObject::invokeMethod(self, "glibOverrunReported", Qt::AutoConnection);
     }
-    return m_mce_interface;
 }
 
 void
-BackgroundActivityPrivate::keepalivePeriodReply(QDBusPendingCallWatcher *call)
+BackgroundActivityPrivate::glibStateReported()
 {
-    TRACE
-
-    QDBusPendingReply<int> pc = *call;
-
-    if (!pc.isValid()) {
-        qWarning("INVALID keepalive period reply");
-    } else if (pc.isError()) {
-        qWarning() << pc.error();
-    } else {
-        int period = pc.value(); // [s]
-
-        if (m_keepalive_period != period) {
-            m_keepalive_period = period;
-
-            // if timer is already active
-            if (m_keepalive_timer->isActive()) {
-                // stop timer
-                m_keepalive_timer->stop();
-                // make extra renew request
-                renewKeepalivePeriod();
-                // restart timer with modified period
-                m_keepalive_timer->setInterval(m_keepalive_period * 1000); // [ms]
-                m_keepalive_timer->start();
-            }
-        }
+    // Transitions made via this class have already been signaled,
+    // only changes made by libkeepalive-glib itself need handling
+    BackgroundActivity::State new_state = BackgroundActivity::Stopped;
+    if (background_activity_is_running(m_activity)) {
+        new_state = BackgroundActivity::Running;
+    } else if (background_activity_is_waiting(m_activity)) {
+        new_state = BackgroundActivity::Waiting;
     }
 
-    call->deleteLater();
+    if (m_state != new_state) {
+        TRACE
+        m_state = new_state;
+        emitStateSignals();
+    }
 }
 
 void
-BackgroundActivityPrivate::queryKeepalivePeriod()
+BackgroundActivityPrivate::glibOverrunReported()
 {
-    if (m_keepalive_queried) {
-        // Already done
-        return;
-    }
     TRACE
+    qWarning("%s: running state exceeded %d second budget; overrun #%u",
+             qPrintable(id()), runBudget(), overrunCount());
+
+    Q_EMIT pub->overrun();
+}
 
-    m_keepalive_queried = true;
+/* ------------------------------------------------------------------------- *
+ * running state budget
+ * ------------------------------------------------------------------------- */
 
-    QDBusPendingReply<int> pc = mceInterface()->req_cpu_keepalive_period();
+int
+BackgroundActivityPrivate::runBudget() const
+{
+    return background_activity_get_run_budget(m_activity);
+}
 
-    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(pc, this);
+void
+BackgroundActivityPrivate::setRunBudget(int seconds,
+                                        BackgroundActivity::State overrun_state)
+{
+    TRACE
+    // Overrun must terminate the running state
+    background_activity_overrun_t action = BACKGROUND_ACTIVITY_OVERRUN_STOP;
+    if (overrun_state == BackgroundActivity::Waiting) {
+        action = BACKGROUND_ACTIVITY_OVERRUN_WAIT;
+    }
+    background_activity_set_run_budget(m_activity, seconds > 0 ? seconds : 0,
+                                       action);
+}
 
-    connect(watcher, SIGNAL(finished(QDBusPendingCallWatcher *)),
-            this, SLOT(keepalivePeriodReply(QDBusPendingCallWatcher *)));
+unsigned
+BackgroundActivityPrivate::overrunCount() const
+{
+    return background_activity_get_overrun_count(m_activity);
 }
 
 /* ------------------------------------------------------------------------- *
@@ -208,54 +253,35 @@ BackgroundActivityPrivate::setState(BackgroundActivity::State new_state)
         return;
     }
 
-    TRACE
-
-    /* leave old state */
-    bool was_running = false;
-
-    switch (m_state) {
-    case BackgroundActivity::Stopped:
-        break;
-
-    case BackgroundActivity::Waiting:
-        /* heartbeat timer can be cancelled before state transition */
-        m_heartbeat->stop();
-        break;
-
-    case BackgroundActivity::Running:
-        /* keepalive timer must be cancelled after state transition */
-        was_running = true;
-        break;
+    /* without glib main loop the activity would never wake up, or
+     * would block suspend indefinitely -> stay stopped instead */
+    if (!m_usable && new_state != BackgroundActivity::Stopped) {
+        qWarning("%s: glib main loop is not available; staying stopped",
+                 qPrintable(id()));
+        return;
     }
 
-    /* enter new state */
+    TRACE
+
     m_state = new_state;
     switch (m_state) {
     case BackgroundActivity::Stopped:
+        background_activity_stop(m_activity);
         break;
     case BackgroundActivity::Waiting:
-        queryKeepalivePeriod();
-
-        if (m_wakeup_freq != BackgroundActivity::Range) {
-            m_heartbeat->setInterval(m_wakeup_freq);
-        } else {
-            m_heartbeat->setInterval(m_wakeup_range_min, m_wakeup_range_max);
-        }
-
-        m_heartbeat->start();
+        background_activity_wait(m_activity);
         break;
     case BackgroundActivity::Running:
-        queryKeepalivePeriod();
-        startKeepalivePeriod();
+        background_activity_run(m_activity);
         break;
     }
 
-    /* special case: allow heartbeat timer reprogramming
-     * to occur before stopping the keepalive period */
-    if ( was_running ) {
-        stopKeepalivePeriod();
-    }
+    emitStateSignals();
+}
 
+void
+BackgroundActivityPrivate::emitStateSignals()
+{
     /* emit state transition signals */
     Q_EMIT pub->stateChanged();
     switch (m_state) {
@@ -274,14 +300,17 @@ BackgroundActivityPrivate::setState(BackgroundActivity::State new_state)
 BackgroundActivity::Frequency
 BackgroundActivityPrivate::wakeupSlot() const
 {
-    return m_wakeup_freq;
+    return BackgroundActivity::Frequency(background_activity_get_wakeup_slot(m_activity));
 }
 
 void
 BackgroundActivityPrivate::wakeupRange(int &range_min, int &range_max) const
 {
-    range_min = m_wakeup_range_min;
-    range_max = m_wakeup_range_max;
+    if (wakeupSlot() != BackgroundActivity::Range) {
+        range_min = range_max = 0;
+    } else {
+        background_activity_get_wakeup_range(m_activity, &range_min, &range_max);
+    }
 }
 
 void
@@ -289,32 +318,27 @@ BackgroundActivityPrivate::setWakeup(BackgroundActivity::Frequency slot,
                                      int range_min, int range_max)
 {
     TRACE
-    // TODO: need a way not to hardcode this
-    const int heartbeat_interval = 12;
-
-    BackgroundActivity::Frequency old_slot = m_wakeup_freq;
-    int old_wakeup_range_min = m_wakeup_range_min;
-    int old_wakeup_range_max = m_wakeup_range_max;
+    BackgroundActivity::Frequency old_slot = wakeupSlot();
+    int old_wakeup_range_min, old_wakeup_range_max;
+    wakeupRange(old_wakeup_range_min, old_wakeup_range_max);
 
+    // Relative wakeups override absolute deadline
     if (slot != BackgroundActivity::Range) {
-        m_wakeup_freq = slot;
-        m_wakeup_range_min = 0;
-        m_wakeup_range_max = 0;
+        background_activity_set_wakeup_slot(m_activity,
+                                            background_activity_frequency_t(slot));
     } else {
-        if (range_max < range_min) {
-            range_max = range_min + heartbeat_interval;
-        }
-        m_wakeup_freq = BackgroundActivity::Range;
-        m_wakeup_range_min = range_min;
-        m_wakeup_range_max = range_max;
+        background_activity_set_wakeup_range(m_activity, range_min, range_max);
     }
 
-    if (old_slot !=  m_wakeup_freq) {
+    int new_wakeup_range_min, new_wakeup_range_max;
+    wakeupRange(new_wakeup_range_min, new_wakeup_range_max);
+
+    if (old_slot != wakeupSlot()) {
         Q_EMIT pub->wakeupFrequencyChanged();
     }
 
-    if (old_wakeup_range_min != m_wakeup_range_min ||
-            old_wakeup_range_max != m_wakeup_range_max) {
+    if (old_wakeup_range_min != new_wakeup_range_min ||
+            old_wakeup_range_max != new_wakeup_range_max) {
         Q_EMIT pub->wakeupRangeChanged();
     }
 }
@@ -333,8 +357,58 @@ BackgroundActivityPrivate::setWakeupRange(int range_min, int range_max)
     setWakeup(BackgroundActivity::Range, range_min, range_max);
 }
 
+bool
+BackgroundActivityPrivate::wakeupDeadline(qint64 &deadline_lo,
+                                          qint64 &deadline_hi) const
+{
+    background_activity_clock_t clock = BACKGROUND_ACTIVITY_CLOCK_BOOTTIME;
+    time_t lo = 0, hi = 0;
+
+    if (!background_activity_get_wakeup_deadline(m_activity, &clock, &lo, &hi) ||
+            clock != BACKGROUND_ACTIVITY_CLOCK_REALTIME) {
+        return false;
+    }
+
+    deadline_lo = lo;
+    deadline_hi = hi;
+    return true;
+}
+
+void
+BackgroundActivityPrivate::setWakeupDeadline(qint64 deadline_lo,
+                                             qint64 deadline_hi)
+{
+    TRACE
+    qint64 old_lo = 0, old_hi = 0;
+    bool old_set = wakeupDeadline(old_lo, old_hi);
+    BackgroundActivity::Frequency old_slot = wakeupSlot();
+
+    background_activity_set_wakeup_deadline(m_activity,
+                                            BACKGROUND_ACTIVITY_CLOCK_REALTIME,
+                                            time_t(deadline_lo),
+                                            time_t(deadline_hi));
+
+    qint64 new_lo = 0, new_hi = 0;
+    wakeupDeadline(new_lo, new_hi);
+
+    if (old_set && old_lo == new_lo && old_hi == new_hi) {
+        // Avoid needless IPHB reprogramming
+        return;
+    }
+
+    // Reprogram already active wait
+    if (m_state == BackgroundActivity::Waiting) {
+        background_activity_wait(m_activity);
+    }
+
+    if (old_slot != wakeupSlot()) {
+        Q_EMIT pub->wakeupFrequencyChanged();
+    }
+    Q_EMIT pub->wakeupRangeChanged();
+}
+
 QString
 BackgroundActivityPrivate::id() const
 {
-    return m_id;
+    return QString::fromUtf8(background_activity_get_id(m_activity));
 }
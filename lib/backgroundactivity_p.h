@@ -32,31 +32,25 @@
 # define BACKGROUNDACTIVITY_P_H_
 
 # include "backgroundactivity.h"
-# include "heartbeat.h"
-# include "mceiface.h"
+
+# include <keepalive-backgroundactivity.h>
 
 class BackgroundActivityPrivate : public QObject
 {
     Q_OBJECT
 
     friend class BackgroundActivity;
+    friend class CpuKeepalivePrivate;
 
 private:
     BackgroundActivityPrivate(const BackgroundActivityPrivate &that);
     explicit BackgroundActivityPrivate(BackgroundActivity *parent = 0);
     virtual ~BackgroundActivityPrivate();
 
-    void startKeepalivePeriod();
-    void stopKeepalivePeriod();
-
-    void queryKeepalivePeriod();
-
     void setState(BackgroundActivity::State new_state);
 
     BackgroundActivity::State state() const;
 
-    ComNokiaMceRequestInterface *mceInterface();
-
     BackgroundActivity::Frequency wakeupSlot() const;
     void wakeupRange(int &range_min, int &range_max) const;
     void setWakeup(BackgroundActivity::Frequency slot,
@@ -65,29 +59,37 @@ private:
     void setWakeupFrequency(BackgroundActivity::Frequency slot);
     void setWakeupRange(int range_min, int range_max);
 
+    bool wakeupDeadline(qint64 &deadline_lo, qint64 &deadline_hi) const;
+    void setWakeupDeadline(qint64 deadline_lo, qint64 deadline_hi);
+
     QString id() const;
 
+    int runBudget() const;
+    void setRunBudget(int seconds, BackgroundActivity::State overrun_state);
+    unsigned overrunCount() const;
+
+    void emitStateSignals();
+
+    static bool checkEventDispatcher();
+    static void setupSystemBus();
+
+    static void glibUserDataFree(void *aptr);
+    static void glibStateCallback(background_activity_t *activity, void *aptr);
+    static void glibOverrunCallback(background_activity_t *activity, void *aptr);
+
 private Q_SLOTS:
-    void renewKeepalivePeriod();
-    void keepalivePeriodReply(QDBusPendingCallWatcher *call);
+    void glibStateReported();
+    void glibOverrunReported();
 
 private:
     BackgroundActivity::State m_state;
-    BackgroundActivity::Frequency m_wakeup_freq;
-    int m_wakeup_range_min;
-    int m_wakeup_range_max;
-
-    BackgroundActivity *pub;
-
-    QString m_id;
 
-    Heartbeat *m_heartbeat;
+    /* False if wakeups can't be delivered, i.e. activity stays stopped */
+    bool m_usable;
 
-    bool    m_keepalive_queried;
-    int     m_keepalive_period;
-    QTimer *m_keepalive_timer;
+    BackgroundActivity *pub;
 
-    ComNokiaMceRequestInterface *m_mce_interface;
+    background_activity_t *m_activity;
 };
 
 #endif /* BACKGROUNDACTIVITY_P_H_ */
@@ -0,0 +1,294 @@
+/****************************************************************************************
+**
+** Copyright (C) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of nemo-keepalive package.
+**
+** You may use this file under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+****************************************************************************************/
+
+#include "backgroundworkqueue_p.h"
+#include "common.h"
+
+#include <QAtomicInt>
+#include <QCoreApplication>
+#include <QHash>
+#include <QPointer>
+#include <QSharedPointer>
+
+#include <glib.h>
+
+/* Work item passed to libkeepalive-glib shared queue */
+struct BackgroundWorkQueueItem
+{
+    BackgroundWorkQueue::AsyncJob         job;
+    QPointer<BackgroundWorkQueuePrivate>  owner;
+};
+
+static gboolean backgroundWorkDoneCb(gpointer aptr)
+{
+    background_work_done(static_cast<background_work_t *>(aptr));
+    return G_SOURCE_REMOVE;
+}
+
+/* ========================================================================= *
+ * class BackgroundWorkQueuePrivate
+ * ========================================================================= */
+
+BackgroundWorkQueuePrivate::BackgroundWorkQueuePrivate(BackgroundActivity::Frequency slot,
+                                                       BackgroundWorkQueue *parent)
+    : QObject(parent)
+    , pub(parent)
+    , m_slot(slot)
+    , m_parallelism(1)
+    , m_inflight(0)
+    , m_dispatch_queued(false)
+    , m_activity(new BackgroundActivity(this))
+    , m_backend(0)
+{
+    TRACE
+    if (m_slot != BackgroundActivity::Range)
+        m_activity->setWakeupFrequency(m_slot);
+
+    QObject::connect(m_activity, SIGNAL(running()),
+                     this, SLOT(dispatch()));
+}
+
+BackgroundWorkQueuePrivate::~BackgroundWorkQueuePrivate()
+{
+    TRACE
+    if (m_activity)
+        m_activity->stop();
+}
+
+void BackgroundWorkQueuePrivate::setBackend(background_work_queue_t *backend)
+{
+    /* Wakeups and keepalive are handled by the backend queue */
+    delete m_activity, m_activity = 0;
+
+    m_backend = backend;
+    m_parallelism = (int)background_work_queue_get_parallelism(m_backend);
+}
+
+void BackgroundWorkQueuePrivate::enqueue(const BackgroundWorkQueue::AsyncJob &job)
+{
+    if (!job)
+        return;
+
+    if (m_backend) {
+        BackgroundWorkQueueItem *item = new BackgroundWorkQueueItem;
+        item->job   = job;
+        item->owner = this;
+        m_inflight += 1;
+        background_work_queue_enqueue(m_backend, backendWorkCb,
+                                      item, backendFreeCb);
+        return;
+    }
+
+    m_queue.enqueue(job);
+    activate();
+}
+
+void BackgroundWorkQueuePrivate::activate()
+{
+    /* Jobs added while working are done within the same wakeup
+     * window, otherwise wait for the next one. Running state is
+     * entered from mainloop so that jobs are never executed from
+     * within enqueue() */
+    if (m_activity->isRunning() || m_slot == BackgroundActivity::Range)
+        scheduleDispatch();
+    else if (!m_activity->isWaiting())
+        m_activity->wait();
+}
+
+void BackgroundWorkQueuePrivate::scheduleDispatch()
+{
+    if (!m_dispatch_queued) {
+        m_dispatch_queued = true;
+        QMetaObject::invokeMethod(this, "dispatch", Qt::QueuedConnection);
+    }
+}
+
+void BackgroundWorkQueuePrivate::rethink()
+{
+    if (m_inflight > 0 || !m_queue.isEmpty())
+        return;
+
+    /* Release keepalive the moment the queue drains */
+    if (m_activity->isRunning()) {
+        m_activity->stop();
+        Q_EMIT pub->drained();
+    }
+}
+
+void BackgroundWorkQueuePrivate::dispatch()
+{
+    TRACE
+    m_dispatch_queued = false;
+
+    if (!m_activity->isRunning()) {
+        /* Entering running state dispatches via running() signal */
+        if (m_slot == BackgroundActivity::Range && !m_queue.isEmpty())
+            m_activity->run();
+        return;
+    }
+
+    while (m_inflight < m_parallelism && !m_queue.isEmpty()) {
+        BackgroundWorkQueue::AsyncJob job = m_queue.dequeue();
+        m_inflight += 1;
+
+        /* Completion is always handled via event loop, which keeps
+         * things simple regardless of when / where done() is called */
+        QPointer<BackgroundWorkQueuePrivate> self(this);
+        QSharedPointer<QAtomicInt> once(new QAtomicInt(0));
+        job([self, once]() {
+            if (!once->testAndSetOrdered(0, 1)) {
+                qWarning("BackgroundWorkQueue: job finished twice");
+                return;
+            }
+            if (self)
+                QMetaObject::invokeMethod(self.data(), "jobDone",
+                                          Qt::QueuedConnection);
+        });
+    }
+
+    rethink();
+}
+
+void BackgroundWorkQueuePrivate::jobDone()
+{
+    TRACE
+    if (m_inflight > 0)
+        m_inflight -= 1;
+
+    if (!m_queue.isEmpty())
+        dispatch();
+    else
+        rethink();
+}
+
+void BackgroundWorkQueuePrivate::backendJobReleased()
+{
+    if (m_inflight > 0)
+        m_inflight -= 1;
+
+    if (m_inflight == 0)
+        Q_EMIT pub->drained();
+}
+
+void BackgroundWorkQueuePrivate::backendWorkCb(background_work_t *work, void *aptr)
+{
+    BackgroundWorkQueueItem *item = static_cast<BackgroundWorkQueueItem *>(aptr);
+
+    /* Like with Qt side queues, completion is handled via event loop
+     * regardless of when / where done() is called */
+    QSharedPointer<QAtomicInt> once(new QAtomicInt(0));
+    item->job([work, once]() {
+        if (!once->testAndSetOrdered(0, 1)) {
+            qWarning("BackgroundWorkQueue: job finished twice");
+            return;
+        }
+        g_idle_add(backgroundWorkDoneCb, work);
+    });
+}
+
+void BackgroundWorkQueuePrivate::backendFreeCb(void *aptr)
+{
+    /* Called after the job is done, or when it gets discarded */
+    BackgroundWorkQueueItem *item = static_cast<BackgroundWorkQueueItem *>(aptr);
+    if (item->owner)
+        item->owner->backendJobReleased();
+    delete item;
+}
+
+/* ========================================================================= *
+ * class BackgroundWorkQueue
+ * ========================================================================= */
+
+typedef QHash<int, QPointer<BackgroundWorkQueue> > BackgroundWorkQueueHash;
+Q_GLOBAL_STATIC(BackgroundWorkQueueHash, sharedBackgroundWorkQueues)
+
+BackgroundWorkQueue::BackgroundWorkQueue(BackgroundActivity::Frequency slot,
+                                         QObject *parent)
+    : QObject(parent)
+{
+    TRACE
+    priv = new BackgroundWorkQueuePrivate(slot, this);
+}
+
+BackgroundWorkQueue::~BackgroundWorkQueue()
+{
+    TRACE
+    delete priv;
+}
+
+BackgroundWorkQueue *BackgroundWorkQueue::shared(BackgroundActivity::Frequency slot)
+{
+    QPointer<BackgroundWorkQueue> &queue = (*sharedBackgroundWorkQueues())[slot];
+    if (!queue) {
+        queue = new BackgroundWorkQueue(slot, QCoreApplication::instance());
+        background_work_queue_t *backend =
+            background_work_queue_shared(background_activity_frequency_t(slot));
+        if (backend)
+            queue->priv->setBackend(backend);
+    }
+    return queue.data();
+}
+
+BackgroundActivity::Frequency BackgroundWorkQueue::slot() const
+{
+    return priv->m_slot;
+}
+
+int BackgroundWorkQueue::parallelism() const
+{
+    return priv->m_parallelism;
+}
+
+void BackgroundWorkQueue::setParallelism(int parallelism)
+{
+    priv->m_parallelism = qMax(parallelism, 1);
+    if (priv->m_backend)
+        background_work_queue_set_parallelism(priv->m_backend,
+                                              (unsigned)priv->m_parallelism);
+    else if (priv->m_activity->isRunning())
+        priv->scheduleDispatch();
+}
+
+int BackgroundWorkQueue::pending() const
+{
+    /* For shared queues: unfinished jobs added via this object */
+    return priv->m_queue.count() + priv->m_inflight;
+}
+
+void BackgroundWorkQueue::enqueue(const Job &job)
+{
+    if (!job)
+        return;
+    priv->enqueue([job](const DoneFunction &done) {
+        job();
+        done();
+    });
+}
+
+void BackgroundWorkQueue::enqueueAsync(const AsyncJob &job)
+{
+    priv->enqueue(job);
+}
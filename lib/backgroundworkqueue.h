@@ -0,0 +1,69 @@
+/****************************************************************************************
+**
+** Copyright (C) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of nemo-keepalive package.
+**
+** You may use this file under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+****************************************************************************************/
+
+#ifndef BACKGROUNDWORKQUEUE_H_
+# define BACKGROUNDWORKQUEUE_H_
+
+# include "backgroundactivity.h"
+
+# include <functional>
+
+class BackgroundWorkQueuePrivate;
+
+class BackgroundWorkQueue: public QObject
+{
+    Q_OBJECT
+
+public:
+    typedef std::function<void()> Job;
+    typedef std::function<void()> DoneFunction;
+    typedef std::function<void(const DoneFunction &done)> AsyncJob;
+
+    explicit BackgroundWorkQueue(BackgroundActivity::Frequency slot,
+                                 QObject *parent = 0);
+    virtual ~BackgroundWorkQueue();
+
+    static BackgroundWorkQueue *shared(BackgroundActivity::Frequency slot);
+
+    BackgroundActivity::Frequency slot() const;
+
+    int parallelism() const;
+    void setParallelism(int parallelism);
+
+    int pending() const;
+
+    void enqueue(const Job &job);
+    void enqueueAsync(const AsyncJob &job);
+
+Q_SIGNALS:
+    void drained();
+
+private:
+    Q_DISABLE_COPY(BackgroundWorkQueue)
+    BackgroundWorkQueuePrivate *priv;
+};
+
+#endif // BACKGROUNDWORKQUEUE_H_
@@ -0,0 +1,76 @@
+/****************************************************************************************
+**
+** Copyright (C) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of nemo-keepalive package.
+**
+** You may use this file under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+****************************************************************************************/
+
+#ifndef BACKGROUNDWORKQUEUE_P_H_
+# define BACKGROUNDWORKQUEUE_P_H_
+
+# include "backgroundworkqueue.h"
+
+# include <QQueue>
+
+# include <keepalive-workqueue.h>
+
+class BackgroundWorkQueuePrivate : public QObject
+{
+    Q_OBJECT
+
+    friend class BackgroundWorkQueue;
+
+private:
+    BackgroundWorkQueuePrivate(BackgroundActivity::Frequency slot,
+                               BackgroundWorkQueue *parent);
+    virtual ~BackgroundWorkQueuePrivate();
+
+    void setBackend(background_work_queue_t *backend);
+    void enqueue(const BackgroundWorkQueue::AsyncJob &job);
+    void activate();
+    void scheduleDispatch();
+    void rethink();
+    void backendJobReleased();
+
+    static void backendWorkCb(background_work_t *work, void *aptr);
+    static void backendFreeCb(void *aptr);
+
+private Q_SLOTS:
+    void dispatch();
+    void jobDone();
+
+private:
+    BackgroundWorkQueue *pub;
+
+    BackgroundActivity::Frequency            m_slot;
+    int                                      m_parallelism;
+    int                                      m_inflight;
+    bool                                     m_dispatch_queued;
+    QQueue<BackgroundWorkQueue::AsyncJob>    m_queue;
+    BackgroundActivity                      *m_activity;
+
+    /* Shared queues are backed by libkeepalive-glib shared queues so
+     * that Qt and glib users get their work done in one wakeup */
+    background_work_queue_t                 *m_backend;
+};
+
+#endif /* BACKGROUNDWORKQUEUE_P_H_ */
@@ -0,0 +1,109 @@
+/****************************************************************************************
+**
+** Copyright (C) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of nemo-keepalive package.
+**
+** You may use this file under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+****************************************************************************************/
+
+#include "cpukeepalive_p.h"
+#include "backgroundactivity_p.h"
+#include "common.h"
+
+#include <keepalive-cpukeepalive.h>
+
+/* ========================================================================= *
+ * class CpuKeepalivePrivate
+ * ========================================================================= */
+
+Q_GLOBAL_STATIC(CpuKeepalivePrivate, cpuKeepaliveInstance)
+
+CpuKeepalivePrivate *CpuKeepalivePrivate::instance()
+{
+    return cpuKeepaliveInstance();
+}
+
+CpuKeepalivePrivate::CpuKeepalivePrivate()
+    : m_holders(0)
+    , m_usable(false)
+{
+    TRACE
+    // Keepalive session is handled by libkeepalive-glib, which
+    // needs the same setup as BackgroundActivity does
+    m_usable = BackgroundActivityPrivate::checkEventDispatcher();
+    BackgroundActivityPrivate::setupSystemBus();
+}
+
+CpuKeepalivePrivate::~CpuKeepalivePrivate()
+{
+    TRACE
+}
+
+void CpuKeepalivePrivate::acquire()
+{
+    m_holders.fetchAndAddOrdered(1);
+
+    // Without glib main loop the session could not be renewed
+    // nor ended -> do not start it at all
+    if (!m_usable)
+        return;
+
+    // Holders that come and go before the glib main loop gets to
+    // evaluate the situation cause no keepalive IPC at all
+    cpukeepalive_shared_acquire();
+}
+
+void CpuKeepalivePrivate::release()
+{
+    int prev = m_holders.fetchAndAddOrdered(-1);
+    if (prev <= 0) {
+        qWarning("CpuKeepalive: unbalanced release");
+        m_holders.fetchAndAddOrdered(1);
+        return;
+    }
+
+    if (m_usable)
+        cpukeepalive_shared_release();
+}
+
+int CpuKeepalivePrivate::holders() const
+{
+    return m_holders.loadAcquire();
+}
+
+/* ========================================================================= *
+ * class CpuKeepalive
+ * ========================================================================= */
+
+void CpuKeepalive::acquire()
+{
+    CpuKeepalivePrivate::instance()->acquire();
+}
+
+void CpuKeepalive::release()
+{
+    CpuKeepalivePrivate::instance()->release();
+}
+
+int CpuKeepalive::holders()
+{
+    return CpuKeepalivePrivate::instance()->holders();
+}
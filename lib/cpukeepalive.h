@@ -0,0 +1,50 @@
+/****************************************************************************************
+**
+** Copyright (C) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of nemo-keepalive package.
+**
+** You may use this file under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+****************************************************************************************/
+
+#ifndef CPUKEEPALIVE_H_
+# define CPUKEEPALIVE_H_
+
+# include <QtGlobal>
+
+class CpuKeepalive
+{
+public:
+    static void acquire();
+    static void release();
+    static int holders();
+
+    class Locker
+    {
+    public:
+        Locker() { CpuKeepalive::acquire(); }
+        ~Locker() { CpuKeepalive::release(); }
+
+    private:
+        Q_DISABLE_COPY(Locker)
+    };
+};
+
+#endif // CPUKEEPALIVE_H_
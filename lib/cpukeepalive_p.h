@@ -0,0 +1,58 @@
+/****************************************************************************************
+**
+** Copyright (C) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of nemo-keepalive package.
+**
+** You may use this file under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+****************************************************************************************/
+
+#ifndef CPUKEEPALIVE_P_H_
+# define CPUKEEPALIVE_P_H_
+
+# include "cpukeepalive.h"
+
+# include <QAtomicInt>
+
+/* CpuKeepalive is a thin wrapper for the process wide shared
+ * CPU-keepalive session of libkeepalive-glib, so that Qt and glib
+ * based code within the same process share one keepalive session
+ * with MCE.
+ */
+class CpuKeepalivePrivate
+{
+public:
+    CpuKeepalivePrivate();
+    ~CpuKeepalivePrivate();
+
+    static CpuKeepalivePrivate *instance();
+
+    void acquire();
+    void release();
+    int holders() const;
+
+private:
+    Q_DISABLE_COPY(CpuKeepalivePrivate)
+
+    QAtomicInt m_holders;
+    bool       m_usable;
+};
+
+#endif /* CPUKEEPALIVE_P_H_ */
@@ -30,6 +30,8 @@
 #include "displayblanking_p.h"
 #include "common.h"
 
+#include <QMetaMethod>
+
 /* ========================================================================= *
  * class DisplayBlanking
  * ========================================================================= */
@@ -97,3 +99,11 @@ void DisplayBlanking::setPreventBlanking(bool prevent)
     TRACE
     priv->setPreventBlanking(prevent);
 }
+
+void DisplayBlanking::connectNotify(const QMetaMethod &signal)
+{
+    /* Display state is tracked only when someone is interested */
+    if (priv && signal == QMetaMethod::fromSignal(&DisplayBlanking::statusChanged))
+        priv->trackDisplayStatus();
+    QObject::connectNotify(signal);
+}
@@ -62,6 +62,9 @@ Q_SIGNALS:
     void preventBlankingChanged();
     void statusChanged();
 
+protected:
+    virtual void connectNotify(const QMetaMethod &signal);
+
 private:
     Q_DISABLE_COPY(DisplayBlanking)
     DisplayBlankingPrivate *priv;
@@ -43,39 +43,70 @@ DisplayBlankingSingleton::DisplayBlankingSingleton()
     , m_preventAllowed(false)
     , m_displayStatus(DisplayBlanking::Unknown)
     , m_instanceRefCount(0)
+    , m_trackingStatus(false)
+    , m_trackingPreventMode(false)
+    , m_mce(MceProxy::instance())
 {
-    m_mce_req_iface = new ComNokiaMceRequestInterface(MCE_SERVICE,
-                                                      MCE_REQUEST_PATH,
-                                                      QDBusConnection::systemBus(),
-                                                      this);
+    /* Track mce restarts */
+    connect(m_mce, SIGNAL(mceRunningChanged(bool)),
+            this, SLOT(mceRunningChanged(bool)));
 
-    m_mce_signal_iface = new ComNokiaMceSignalInterface(MCE_SERVICE,
-                                                        MCE_SIGNAL_PATH,
-                                                        QDBusConnection::systemBus(),
-                                                        this);
+    /* Display state and blank prevent policy are tracked only
+     * after the related functionality gets used - see
+     * trackDisplayStatus() and trackPreventMode() */
+}
 
-    /* Track blank prevent allowed */
-    {
-        connect(m_mce_signal_iface, SIGNAL(display_blanking_pause_allowed_ind(bool)),
-                this, SLOT(updatePreventMode(bool)));
+void DisplayBlankingSingleton::trackDisplayStatus()
+{
+    if (!m_trackingStatus) {
+        m_trackingStatus = true;
+        connect(m_mce->signalIface(), SIGNAL(display_status_ind(const QString &)),
+                this, SLOT(updateDisplayStatus(QString)));
+        queryDisplayStatus();
+    }
+}
 
-        QDBusPendingReply<bool> reply = m_mce_req_iface->get_display_blanking_pause_allowed();
-        QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(reply, this);
-        connect(watcher, SIGNAL(finished(QDBusPendingCallWatcher *)),
-                SLOT(getPreventModeComplete(QDBusPendingCallWatcher *)));
+void DisplayBlankingSingleton::trackPreventMode()
+{
+    if (!m_trackingPreventMode) {
+        m_trackingPreventMode = true;
+        connect(m_mce->signalIface(), SIGNAL(display_blanking_pause_allowed_ind(bool)),
+                this, SLOT(updatePreventMode(bool)));
+        queryPreventMode();
     }
+}
 
-    /* Track display state */
-    {
-        connect(m_mce_signal_iface, SIGNAL(display_status_ind(const QString &)),
-                this, SLOT(updateDisplayStatus(QString)));
+void DisplayBlankingSingleton::queryPreventMode()
+{
+    QDBusPendingReply<bool> reply = m_mce->requestIface()->get_display_blanking_pause_allowed();
+    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(reply, this);
+    connect(watcher, SIGNAL(finished(QDBusPendingCallWatcher *)),
+            SLOT(getPreventModeComplete(QDBusPendingCallWatcher *)));
+}
+
+void DisplayBlankingSingleton::queryDisplayStatus()
+{
+    QDBusPendingReply<QString> reply = m_mce->requestIface()->get_display_status();
+    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(reply, this);
+    connect(watcher, SIGNAL(finished(QDBusPendingCallWatcher *)),
+            SLOT(getDisplayStatusComplete(QDBusPendingCallWatcher *)));
+}
 
-        QDBusPendingReply<QString> reply = m_mce_req_iface->get_display_status();
-        QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(reply, this);
-        connect(watcher, SIGNAL(finished(QDBusPendingCallWatcher *)),
-                SLOT(getDisplayStatusComplete(QDBusPendingCallWatcher *)));
+void DisplayBlankingSingleton::mceRunningChanged(bool running)
+{
+    if (!running) {
+        if (m_trackingStatus)
+            updateDisplayStatus(QString());
+        return;
     }
 
+    /* Fresh mce instance: re-sync state and blank pause session */
+    if (m_trackingPreventMode)
+        queryPreventMode();
+    if (m_trackingStatus)
+        queryDisplayStatus();
+    if (m_renew_timer && m_renew_timer->isActive())
+        renewKeepalive();
 }
 
 DisplayBlanking::Status DisplayBlankingSingleton::displayStatus() const
@@ -94,20 +125,20 @@ QTimer *DisplayBlankingSingleton::keepaliveTimer()
 
 void DisplayBlankingSingleton::startKeepalive()
 {
-    m_mce_req_iface->req_display_blanking_pause();
+    m_mce->requestIface()->req_display_blanking_pause();
     keepaliveTimer()->setInterval(m_renew_period);
     keepaliveTimer()->start();
 }
 
 void DisplayBlankingSingleton::renewKeepalive()
 {
-    m_mce_req_iface->req_display_blanking_pause();
+    m_mce->requestIface()->req_display_blanking_pause();
 }
 
 void DisplayBlankingSingleton::stopKeepalive()
 {
     keepaliveTimer()->stop();
-    m_mce_req_iface->req_display_cancel_blanking_pause();
+    m_mce->requestIface()->req_display_cancel_blanking_pause();
 }
 
 void DisplayBlankingSingleton::evaluateKeepalive()
@@ -196,6 +227,8 @@ void DisplayBlankingSingleton::releaseInstance()
 
 void DisplayBlankingSingleton::attachPreventingObject(DisplayBlankingPrivate *object)
 {
+    /* Blank prevention starts once mce reports that it is allowed */
+    trackPreventMode();
     m_preventingObjects.insert(object);
     evaluateKeepalive();
 }
@@ -233,9 +266,15 @@ DisplayBlankingPrivate::~DisplayBlankingPrivate()
 
 DisplayBlanking::Status DisplayBlankingPrivate::displayStatus() const
 {
+    m_singleton->trackDisplayStatus();
     return m_singleton->displayStatus();
 }
 
+void DisplayBlankingPrivate::trackDisplayStatus()
+{
+    m_singleton->trackDisplayStatus();
+}
+
 bool DisplayBlankingPrivate::preventBlanking() const
 {
     return m_preventBlanking;
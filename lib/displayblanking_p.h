@@ -31,7 +31,7 @@
 # define DISPLAYBLANKING_P_H_
 
 # include "displayblanking.h"
-# include "mceiface.h"
+# include "mceproxy.h"
 
 class QTimer;
 
@@ -48,6 +48,7 @@ public:
     void attachPreventingObject(DisplayBlankingPrivate *object);
     void detachPreventingObject(DisplayBlankingPrivate *object);
     DisplayBlanking::Status displayStatus() const;
+    void trackDisplayStatus();
 Q_SIGNALS:
     void displayStatusChanged();
 
@@ -57,6 +58,9 @@ private:
     void startKeepalive();
     void stopKeepalive();
     void evaluateKeepalive();
+    void trackPreventMode();
+    void queryPreventMode();
+    void queryDisplayStatus();
 
 private Q_SLOTS:
     void renewKeepalive();
@@ -64,6 +68,7 @@ private Q_SLOTS:
     void getDisplayStatusComplete(QDBusPendingCallWatcher *call);
     void updatePreventMode(bool preventAllowed);
     void getPreventModeComplete(QDBusPendingCallWatcher *call);
+    void mceRunningChanged(bool running);
 
 private:
     static DisplayBlankingSingleton *s_instance;
@@ -73,9 +78,10 @@ private:
     bool    m_preventAllowed;
     DisplayBlanking::Status m_displayStatus;
     int m_instanceRefCount;
+    bool m_trackingStatus;
+    bool m_trackingPreventMode;
 
-    ComNokiaMceRequestInterface *m_mce_req_iface;
-    ComNokiaMceSignalInterface *m_mce_signal_iface;
+    MceProxy *m_mce;
 };
 
 class DisplayBlankingPrivate
@@ -85,6 +91,7 @@ public:
     ~DisplayBlankingPrivate();
 
     DisplayBlanking::Status displayStatus() const;
+    void trackDisplayStatus();
 
     bool preventBlanking() const;
     void setPreventBlanking(bool preventBlanking);
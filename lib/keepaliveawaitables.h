@@ -0,0 +1,258 @@
+/****************************************************************************************
+**
+** Copyright (C) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of nemo-keepalive package.
+**
+** You may use this file under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+****************************************************************************************/
+
+#ifndef KEEPALIVEAWAITABLES_H_
+# define KEEPALIVEAWAITABLES_H_
+
+/* C++20 coroutine support for keepalive classes.
+ *
+ * Header only - available when the including translation unit is
+ * compiled with coroutine support, the library itself does not
+ * need it.
+ *
+ *   Usage from a coroutine running on a thread with Qt event loop:
+ *
+ *     for (;;) {
+ *         auto awake = co_await Keepalive::nextWakeup(activity, slot);
+ *         doPeriodicWork();
+ *     } // <- keepalive released when 'awake' goes out of scope
+ *
+ *     {
+ *         auto awake = co_await Keepalive::keepAwake();
+ *         co_await someOtherAsyncOperation();
+ *     } // <- keepalive released
+ */
+
+# if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+#  include "backgroundactivity.h"
+#  include "cpukeepalive.h"
+
+#  include <QPointer>
+#  include <QTimer>
+
+#  include <coroutine>
+#  include <utility>
+
+namespace Keepalive {
+
+/* Keeps BackgroundActivity in Running state until destroyed */
+class WakeupGuard
+{
+public:
+    explicit WakeupGuard(BackgroundActivity *activity = nullptr)
+        : m_activity(activity)
+    {
+    }
+
+    WakeupGuard(WakeupGuard &&that) noexcept
+        : m_activity(std::exchange(that.m_activity, nullptr))
+    {
+    }
+
+    WakeupGuard &operator=(WakeupGuard &&that) noexcept
+    {
+        if (this != &that) {
+            reset();
+            m_activity = std::exchange(that.m_activity, nullptr);
+        }
+        return *this;
+    }
+
+    ~WakeupGuard()
+    {
+        reset();
+    }
+
+    /* Stop the activity now, i.e. release keepalive early */
+    void reset()
+    {
+        if (m_activity && m_activity->isRunning())
+            m_activity->stop();
+        m_activity = nullptr;
+    }
+
+private:
+    WakeupGuard(const WakeupGuard &) = delete;
+    WakeupGuard &operator=(const WakeupGuard &) = delete;
+
+    QPointer<BackgroundActivity> m_activity;
+};
+
+/* Keeps shared CpuKeepalive acquired until destroyed */
+class KeepAwakeGuard
+{
+public:
+    KeepAwakeGuard()
+        : m_held(true)
+    {
+    }
+
+    KeepAwakeGuard(KeepAwakeGuard &&that) noexcept
+        : m_held(std::exchange(that.m_held, false))
+    {
+    }
+
+    KeepAwakeGuard &operator=(KeepAwakeGuard &&that) noexcept
+    {
+        if (this != &that) {
+            reset();
+            m_held = std::exchange(that.m_held, false);
+        }
+        return *this;
+    }
+
+    ~KeepAwakeGuard()
+    {
+        reset();
+    }
+
+    /* Release keepalive early */
+    void reset()
+    {
+        if (std::exchange(m_held, false))
+            CpuKeepalive::release();
+    }
+
+private:
+    KeepAwakeGuard(const KeepAwakeGuard &) = delete;
+    KeepAwakeGuard &operator=(const KeepAwakeGuard &) = delete;
+
+    bool m_held;
+};
+
+/* Awaiter for the next BackgroundActivity wakeup
+ *
+ * Note: The activity must outlive the suspended coroutine.
+ */
+class WakeupAwaiter
+{
+public:
+    WakeupAwaiter(BackgroundActivity &activity,
+                  BackgroundActivity::Frequency slot)
+        : m_activity(&activity)
+        , m_slot(slot)
+        , m_min_delay(0)
+        , m_max_delay(0)
+    {
+    }
+
+    WakeupAwaiter(BackgroundActivity &activity, int min_delay, int max_delay)
+        : m_activity(&activity)
+        , m_slot(BackgroundActivity::Range)
+        , m_min_delay(min_delay)
+        , m_max_delay(max_delay)
+    {
+    }
+
+    bool await_ready() const noexcept
+    {
+        return false;
+    }
+
+    void await_suspend(std::coroutine_handle<> handle)
+    {
+        /* Disconnect already within signal emission so that further
+         * running periods can't resume the coroutine again, but resume
+         * via event loop in the thread the activity lives in */
+        m_connection = QObject::connect(m_activity, &BackgroundActivity::running,
+                                        m_activity, [this, handle]() {
+            QObject::disconnect(m_connection);
+            QTimer::singleShot(0, m_activity, [handle]() {
+                handle.resume();
+            });
+        }, Qt::DirectConnection);
+
+        if (m_slot != BackgroundActivity::Range)
+            m_activity->wait(m_slot);
+        else
+            m_activity->wait(m_min_delay, m_max_delay);
+    }
+
+    WakeupGuard await_resume()
+    {
+        return WakeupGuard(m_activity);
+    }
+
+private:
+    BackgroundActivity            *m_activity;
+    BackgroundActivity::Frequency  m_slot;
+    int                            m_min_delay;
+    int                            m_max_delay;
+    QMetaObject::Connection        m_connection;
+};
+
+/* Awaiter for acquiring shared CpuKeepalive
+ *
+ * The keepalive is requested from the main thread event loop, and the
+ * coroutine is resumed from the event loop of the current thread, so
+ * by the time a main thread coroutine resumes, the request has been
+ * processed.
+ */
+class KeepAwakeAwaiter
+{
+public:
+    bool await_ready() const noexcept
+    {
+        return false;
+    }
+
+    void await_suspend(std::coroutine_handle<> handle)
+    {
+        CpuKeepalive::acquire();
+        QTimer::singleShot(0, [handle]() {
+            handle.resume();
+        });
+    }
+
+    KeepAwakeGuard await_resume()
+    {
+        return KeepAwakeGuard();
+    }
+};
+
+inline WakeupAwaiter nextWakeup(BackgroundActivity &activity,
+                                BackgroundActivity::Frequency slot)
+{
+    return WakeupAwaiter(activity, slot);
+}
+
+inline WakeupAwaiter nextWakeup(BackgroundActivity &activity,
+                                int min_delay, int max_delay = -1)
+{
+    return WakeupAwaiter(activity, min_delay, max_delay);
+}
+
+inline KeepAwakeAwaiter keepAwake()
+{
+    return KeepAwakeAwaiter();
+}
+
+} // namespace Keepalive
+
+# endif // __cpp_impl_coroutine
+
+#endif // KEEPALIVEAWAITABLES_H_
@@ -0,0 +1,100 @@
+/****************************************************************************************
+**
+** Copyright (C) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of nemo-keepalive package.
+**
+** You may use this file under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+****************************************************************************************/
+
+#include "keepaliverunner.h"
+#include "cpukeepalive.h"
+#include "common.h"
+
+/* ========================================================================= *
+ * class KeepaliveRunnable
+ * ========================================================================= */
+
+/* Holds shared cpu keepalive from submit until the job is done */
+class KeepaliveRunnable : public QRunnable
+{
+public:
+    explicit KeepaliveRunnable(QRunnable *runnable)
+        : m_runnable(runnable)
+    {
+        setAutoDelete(true);
+        CpuKeepalive::acquire();
+    }
+
+    explicit KeepaliveRunnable(const std::function<void()> &job)
+        : m_runnable(0)
+        , m_job(job)
+    {
+        setAutoDelete(true);
+        CpuKeepalive::acquire();
+    }
+
+    virtual ~KeepaliveRunnable()
+    {
+        if (m_runnable && m_runnable->autoDelete())
+            delete m_runnable;
+        CpuKeepalive::release();
+    }
+
+    virtual void run()
+    {
+        if (m_runnable)
+            m_runnable->run();
+        else if (m_job)
+            m_job();
+    }
+
+private:
+    Q_DISABLE_COPY(KeepaliveRunnable)
+
+    QRunnable             *m_runnable;
+    std::function<void()>  m_job;
+};
+
+/* ========================================================================= *
+ * class KeepaliveRunner
+ * ========================================================================= */
+
+void KeepaliveRunner::start(QRunnable *runnable, int priority,
+                            QThreadPool *pool)
+{
+    TRACE
+    if (!runnable)
+        return;
+    if (!pool)
+        pool = QThreadPool::globalInstance();
+    pool->start(new KeepaliveRunnable(runnable), priority);
+}
+
+void KeepaliveRunner::start(const std::function<void()> &job, int priority,
+                            QThreadPool *pool)
+{
+    TRACE
+    if (!job)
+        return;
+    if (!pool)
+        pool = QThreadPool::globalInstance();
+    pool->start(new KeepaliveRunnable(job), priority);
+}
@@ -0,0 +1,44 @@
+/****************************************************************************************
+**
+** Copyright (C) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of nemo-keepalive package.
+**
+** You may use this file under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+****************************************************************************************/
+
+#ifndef KEEPALIVERUNNER_H_
+# define KEEPALIVERUNNER_H_
+
+# include <QRunnable>
+# include <QThreadPool>
+
+# include <functional>
+
+class KeepaliveRunner
+{
+public:
+    static void start(QRunnable *runnable, int priority = 0,
+                      QThreadPool *pool = 0);
+    static void start(const std::function<void()> &job, int priority = 0,
+                      QThreadPool *pool = 0);
+};
+
+#endif // KEEPALIVERUNNER_H_
@@ -0,0 +1,362 @@
+/****************************************************************************************
+**
+** Copyright (C) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of nemo-keepalive package.
+**
+** You may use this file under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+****************************************************************************************/
+
+#include "keepalivetimer_p.h"
+#include "common.h"
+
+#include <QThreadStorage>
+#include <QPointer>
+
+#include <time.h>
+
+/* Default slack: same as the global heartbeat period, i.e. the timer
+ * can be triggered together with any other heartbeat wakeup */
+#define KEEPALIVE_TIMER_DEFAULT_SLACK (12 * 1000)
+
+/* IPHB wakeups use one second resolution and RTC wakeups can have
+ * up to one second jitter -> timers that would expire within this
+ * time after a wakeup are triggered right away */
+#define KEEPALIVE_TIMER_TOLERANCE     1000
+
+/* ========================================================================= *
+ * class KeepaliveTimerPrivate
+ * ========================================================================= */
+
+KeepaliveTimerPrivate::KeepaliveTimerPrivate(KeepaliveTimer *parent)
+    : pub(parent)
+    , m_interval(0)
+    , m_slack(KEEPALIVE_TIMER_DEFAULT_SLACK)
+    , m_single_shot(false)
+    , m_active(false)
+    , m_deadline(0)
+{
+}
+
+/* ========================================================================= *
+ * class KeepaliveTimerScheduler
+ * ========================================================================= */
+
+/* One scheduler, and thus one IPHB connection, per thread */
+static QThreadStorage<KeepaliveTimerScheduler *> keepaliveTimerSchedulers;
+
+KeepaliveTimerScheduler *KeepaliveTimerScheduler::instance()
+{
+    if (!keepaliveTimerSchedulers.hasLocalData())
+        keepaliveTimerSchedulers.setLocalData(new KeepaliveTimerScheduler());
+    return keepaliveTimerSchedulers.localData();
+}
+
+qint64 KeepaliveTimerScheduler::boottime()
+{
+    struct timespec ts = { 0, 0 };
+    if (clock_gettime(CLOCK_BOOTTIME, &ts) == -1)
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * Q_INT64_C(1000) + ts.tv_nsec / 1000000;
+}
+
+KeepaliveTimerScheduler::KeepaliveTimerScheduler()
+    : QObject(0)
+    , m_activity(new BackgroundActivity(this))
+    , m_dispatching(false)
+    , m_programmed_lo(-1)
+    , m_programmed_hi(-1)
+{
+    TRACE
+    QObject::connect(m_activity, SIGNAL(running()),
+                     this, SLOT(activityRunning()));
+}
+
+KeepaliveTimerScheduler::~KeepaliveTimerScheduler()
+{
+    TRACE
+    m_activity->stop();
+}
+
+void KeepaliveTimerScheduler::attach(KeepaliveTimerPrivate *timer)
+{
+    timer->m_deadline = boottime() + timer->m_interval;
+    timer->m_active = true;
+    if (!m_timers.contains(timer))
+        m_timers.append(timer);
+    reschedule();
+}
+
+void KeepaliveTimerScheduler::detach(KeepaliveTimerPrivate *timer)
+{
+    timer->m_active = false;
+    if (m_timers.removeOne(timer))
+        reschedule();
+}
+
+void KeepaliveTimerScheduler::reschedule()
+{
+    /* Deferred until all due timers have been triggered */
+    if (m_dispatching)
+        return;
+
+    if (m_timers.isEmpty()) {
+        m_programmed_lo = m_programmed_hi = -1;
+        if (!m_activity->isStopped())
+            m_activity->stop();
+        return;
+    }
+
+    /* The earliest deadline determines the start of the wakeup
+     * range, the least tolerant timer the end of it */
+    qint64 lo = m_timers.first()->m_deadline;
+    qint64 hi = lo + m_timers.first()->m_slack;
+    Q_FOREACH (KeepaliveTimerPrivate *timer, m_timers) {
+        lo = qMin(lo, timer->m_deadline);
+        hi = qMin(hi, timer->m_deadline + timer->m_slack);
+    }
+
+    if (m_activity->isWaiting() &&
+        lo == m_programmed_lo && hi == m_programmed_hi)
+        return;
+
+    m_programmed_lo = lo;
+    m_programmed_hi = hi;
+
+    qint64 now = boottime();
+
+    if (lo <= now) {
+        /* Already due - dispatch from mainloop. Running -> Running
+         * transition does not emit running(), so when rescheduling
+         * at the end of dispatching the keepalive is kept and the
+         * due timers are dispatched directly instead */
+        if (m_activity->isRunning())
+            QMetaObject::invokeMethod(this, "activityRunning",
+                                      Qt::QueuedConnection);
+        else
+            QMetaObject::invokeMethod(m_activity, "run",
+                                      Qt::QueuedConnection);
+        return;
+    }
+
+    /* IPHB uses one second resolution: round the start of the range
+     * up, the end of it down, and make sure it is not empty */
+    int min_delay = (int)((lo - now + 999) / 1000);
+    int max_delay = (int)((hi - now) / 1000);
+    if (max_delay <= min_delay)
+        max_delay = min_delay + 1;
+
+    m_activity->wait(min_delay, max_delay);
+}
+
+void KeepaliveTimerScheduler::activityRunning()
+{
+    TRACE
+    m_dispatching = true;
+
+    qint64 now = boottime();
+
+    QList<KeepaliveTimerPrivate *> due;
+    Q_FOREACH (KeepaliveTimerPrivate *timer, m_timers) {
+        if (timer->m_deadline <= now + KEEPALIVE_TIMER_TOLERANCE)
+            due.append(timer);
+    }
+
+    Q_FOREACH (KeepaliveTimerPrivate *timer, due) {
+        /* Slots of earlier timers can stop / delete later ones */
+        if (!m_timers.contains(timer) ||
+            timer->m_deadline > now + KEEPALIVE_TIMER_TOLERANCE)
+            continue;
+
+        if (timer->m_single_shot) {
+            m_timers.removeOne(timer);
+            timer->m_active = false;
+        }
+        else {
+            timer->m_deadline = now + timer->m_interval;
+        }
+
+        Q_EMIT timer->pub->timeout();
+    }
+
+    m_dispatching = false;
+
+    /* Running -> Waiting/Stopped, releases the cpu keepalive */
+    m_programmed_lo = m_programmed_hi = -1;
+    reschedule();
+}
+
+/* ========================================================================= *
+ * class KeepaliveSingleShot
+ * ========================================================================= */
+
+KeepaliveSingleShot::KeepaliveSingleShot(BackgroundActivity::Frequency slot,
+                                         const QObject *receiver,
+                                         const char *member)
+    : QObject(0)
+    , m_activity(new BackgroundActivity(this))
+{
+    TRACE
+    QObject::connect(this, SIGNAL(timeout()), receiver, member);
+
+    /* Cancel the wakeup if receiver gets deleted before it */
+    QObject::connect(receiver, SIGNAL(destroyed()),
+                     this, SLOT(deleteLater()));
+
+    QObject::connect(m_activity, SIGNAL(running()),
+                     this, SLOT(activityRunning()));
+
+    m_activity->wait(slot);
+}
+
+KeepaliveSingleShot::~KeepaliveSingleShot()
+{
+    TRACE
+}
+
+void KeepaliveSingleShot::activityRunning()
+{
+    TRACE
+    /* Keepalive is held until the activity is stopped */
+    Q_EMIT timeout();
+    m_activity->stop();
+    deleteLater();
+}
+
+/* ========================================================================= *
+ * class KeepaliveTimer
+ * ========================================================================= */
+
+KeepaliveTimer::KeepaliveTimer(QObject *parent)
+    : QObject(parent)
+{
+    TRACE
+    priv = new KeepaliveTimerPrivate(this);
+}
+
+KeepaliveTimer::~KeepaliveTimer()
+{
+    TRACE
+    stop();
+    delete priv;
+}
+
+int KeepaliveTimer::interval() const
+{
+    return priv->m_interval;
+}
+
+void KeepaliveTimer::setInterval(int msec)
+{
+    priv->m_interval = qMax(msec, 0);
+    if (priv->m_active)
+        start();
+}
+
+int KeepaliveTimer::slack() const
+{
+    return priv->m_slack;
+}
+
+void KeepaliveTimer::setSlack(int msec)
+{
+    priv->m_slack = qMax(msec, 0);
+    if (priv->m_active)
+        start();
+}
+
+bool KeepaliveTimer::isSingleShot() const
+{
+    return priv->m_single_shot;
+}
+
+void KeepaliveTimer::setSingleShot(bool singleShot)
+{
+    priv->m_single_shot = singleShot;
+}
+
+bool KeepaliveTimer::isActive() const
+{
+    return priv->m_active;
+}
+
+int KeepaliveTimer::remainingTime() const
+{
+    if (!priv->m_active)
+        return -1;
+    qint64 left = priv->m_deadline - KeepaliveTimerScheduler::boottime();
+    return (int)qMax(left, Q_INT64_C(0));
+}
+
+void KeepaliveTimer::start()
+{
+    TRACE
+    KeepaliveTimerScheduler::instance()->attach(priv);
+}
+
+void KeepaliveTimer::start(int msec)
+{
+    priv->m_interval = qMax(msec, 0);
+    start();
+}
+
+void KeepaliveTimer::stop()
+{
+    TRACE
+    if (priv->m_active)
+        KeepaliveTimerScheduler::instance()->detach(priv);
+}
+
+void KeepaliveTimer::singleShot(int msec, int slackMsec,
+                                const QObject *receiver, const char *member)
+{
+    TRACE
+    if (!receiver || !member)
+        return;
+
+    KeepaliveTimer *timer = new KeepaliveTimer();
+    timer->setSingleShot(true);
+    timer->setInterval(msec);
+    timer->setSlack(slackMsec);
+
+    QObject::connect(timer, SIGNAL(timeout()), receiver, member);
+    QObject::connect(timer, SIGNAL(timeout()), timer, SLOT(deleteLater()));
+
+    /* Cancel the wakeup if receiver gets deleted before it */
+    QObject::connect(receiver, SIGNAL(destroyed()),
+                     timer, SLOT(deleteLater()));
+
+    timer->start();
+}
+
+void KeepaliveTimer::singleShot(BackgroundActivity::Frequency slot,
+                                const QObject *receiver, const char *member)
+{
+    TRACE
+    if (!receiver || !member)
+        return;
+
+    if (slot == BackgroundActivity::Range) {
+        qWarning("KeepaliveTimer::singleShot: invalid wakeup slot");
+        return;
+    }
+
+    new KeepaliveSingleShot(slot, receiver, member);
+}
@@ -1,9 +1,6 @@
 /****************************************************************************************
 **
-** Copyright (C) 2014 - 2018 Jolla Ltd.
-**
-** Author: Simo Piiroinen <simo.piiroinen@jollamobile.com>
-** Author: Martin Jones <martin.jones@jollamobile.com>
+** Copyright (C) 2026 Jolla Ltd.
 **
 ** All rights reserved.
 **
@@ -27,59 +24,53 @@
 **
 ****************************************************************************************/
 
-#ifndef HEARTBEAT_H_
-# define HEARTBEAT_H_
+#ifndef KEEPALIVETIMER_H_
+# define KEEPALIVETIMER_H_
 
-# include <QObject>
-# include <QSocketNotifier>
-# include <QTimer>
+# include "backgroundactivity.h"
 
-extern "C" {
-# include <iphbd/libiphb.h>
-}
+class KeepaliveTimerPrivate;
 
-class Heartbeat : public QObject
+class KeepaliveTimer: public QObject
 {
     Q_OBJECT
+    Q_PROPERTY(int interval READ interval WRITE setInterval)
+    Q_PROPERTY(int slack READ slack WRITE setSlack)
+    Q_PROPERTY(bool singleShot READ isSingleShot WRITE setSingleShot)
+    Q_PROPERTY(bool active READ isActive)
 
 public:
-    explicit Heartbeat(QObject *parent = 0);
-    virtual ~Heartbeat();
-
-    void setInterval(int global_slot);
-    void setInterval(int mindelay, int maxdelay);
+    explicit KeepaliveTimer(QObject *parent = 0);
+    virtual ~KeepaliveTimer();
 
-    void start();
-    void start(int global_slot);
-    void start(int mindelay, int maxdelay);
+    int interval() const;
+    void setInterval(int msec);
 
-    void stop();
+    int slack() const;
+    void setSlack(int msec);
 
-    void disconnect();
-
-Q_SIGNALS:
-    void timeout();
+    bool isSingleShot() const;
+    void setSingleShot(bool singleShot);
 
-private Q_SLOTS:
-    void retryConnect();
-    void wakeup(int fd);
-    void wait();
+    bool isActive() const;
+    int remainingTime() const;
 
-private:
-    int              m_min_delay;
-    int              m_max_delay;
+    static void singleShot(int msec, int slackMsec,
+                           const QObject *receiver, const char *member);
+    static void singleShot(BackgroundActivity::Frequency slot,
+                           const QObject *receiver, const char *member);
 
-    bool             m_started;
-    bool             m_waiting;
+public Q_SLOTS:
+    void start();
+    void start(int msec);
+    void stop();
 
-    iphb_t           m_iphb_handle;
-    QSocketNotifier *m_wakeup_notifier;
-    QTimer          *m_connect_timer;
+Q_SIGNALS:
+    void timeout();
 
 private:
-    Q_DISABLE_COPY(Heartbeat)
-    bool tryConnect();
-    void connect();
-
+    Q_DISABLE_COPY(KeepaliveTimer)
+    KeepaliveTimerPrivate *priv;
 };
-#endif /* HEARTBEAT_H_ */
+
+#endif // KEEPALIVETIMER_H_
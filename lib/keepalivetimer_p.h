@@ -0,0 +1,100 @@
+/****************************************************************************************
+**
+** Copyright (C) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of nemo-keepalive package.
+**
+** You may use this file under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+****************************************************************************************/
+
+#ifndef KEEPALIVETIMER_P_H_
+# define KEEPALIVETIMER_P_H_
+
+# include "keepalivetimer.h"
+
+# include <QList>
+
+class KeepaliveTimerPrivate
+{
+    friend class KeepaliveTimer;
+    friend class KeepaliveTimerScheduler;
+
+private:
+    explicit KeepaliveTimerPrivate(KeepaliveTimer *parent);
+
+    KeepaliveTimer *pub;
+
+    int    m_interval;     // [ms]
+    int    m_slack;        // [ms]
+    bool   m_single_shot;
+    bool   m_active;
+    qint64 m_deadline;     // [ms, CLOCK_BOOTTIME]
+};
+
+class KeepaliveTimerScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    KeepaliveTimerScheduler();
+    virtual ~KeepaliveTimerScheduler();
+
+    static KeepaliveTimerScheduler *instance();
+    static qint64 boottime();
+
+    void attach(KeepaliveTimerPrivate *timer);
+    void detach(KeepaliveTimerPrivate *timer);
+
+private Q_SLOTS:
+    void activityRunning();
+
+private:
+    Q_DISABLE_COPY(KeepaliveTimerScheduler)
+    void reschedule();
+
+    BackgroundActivity            *m_activity;
+    QList<KeepaliveTimerPrivate *> m_timers;
+    bool                           m_dispatching;
+    qint64                         m_programmed_lo; // [ms, CLOCK_BOOTTIME]
+    qint64                         m_programmed_hi; // [ms, CLOCK_BOOTTIME]
+};
+
+class KeepaliveSingleShot : public QObject
+{
+    Q_OBJECT
+
+public:
+    KeepaliveSingleShot(BackgroundActivity::Frequency slot,
+                        const QObject *receiver, const char *member);
+    virtual ~KeepaliveSingleShot();
+
+Q_SIGNALS:
+    void timeout();
+
+private Q_SLOTS:
+    void activityRunning();
+
+private:
+    Q_DISABLE_COPY(KeepaliveSingleShot)
+
+    BackgroundActivity *m_activity;
+};
+
+#endif /* KEEPALIVETIMER_P_H_ */
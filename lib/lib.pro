@@ -7,9 +7,25 @@ TARGETPATH = $$[QT_INSTALL_LIBS]
 
 QT        += dbus
 QT        -= gui
-CONFIG    += qt debug link_pkgconfig
+CONFIG    += qt debug link_pkgconfig c++11
 CONFIG    += create_pc create_prl no_install_prl
-PKGCONFIG += libiphb
+PKGCONFIG += glib-2.0 dbus-1
+
+# BackgroundActivity is implemented on top of libkeepalive-glib
+INCLUDEPATH += $$PWD/../lib-glib $$PWD/..
+LIBS        += -L$$PWD/../lib-glib -lkeepalive-glib
+
+# Make sure libkeepalive-glib gets built also via plain qmake + make;
+# rpm build makes it separately beforehand with versioning info
+keepaliveglib.target   = $$PWD/../lib-glib/libkeepalive-glib.so
+keepaliveglib.commands = $(MAKE) -C $$PWD/../lib-glib
+QMAKE_EXTRA_TARGETS   += keepaliveglib
+PRE_TARGETDEPS        += $$keepaliveglib.target
+
+# libdbus main loop integration; sources from submodule are not warning clean
+# and dbus_gmain_xxx() functions must not be exported from this library
+QMAKE_CFLAGS += -Wno-unused-parameter -Wno-cast-function-type -Wno-missing-field-initializers
+QMAKE_CFLAGS += -fvisibility=hidden
 
 #DEFINES += DEBUG_TRACE
 
@@ -20,18 +36,31 @@ SOURCES += \
     displayblanking_p.cpp \
     backgroundactivity.cpp \
     backgroundactivity_p.cpp \
+    keepalivetimer.cpp \
+    cpukeepalive.cpp \
+    keepaliverunner.cpp \
+    backgroundworkqueue.cpp \
     mceiface.cpp \
-    heartbeat.cpp
+    mceproxy.cpp \
+    ../dbus-gmain/dbus-gmain.c
 
 PUBLIC_HEADERS += \
     displayblanking.h \
-    backgroundactivity.h
+    backgroundactivity.h \
+    keepalivetimer.h \
+    cpukeepalive.h \
+    keepaliverunner.h \
+    backgroundworkqueue.h \
+    keepaliveawaitables.h
 
 PRIVATE_HEADERS += \
     displayblanking_p.h \
     mceiface.h \
-    heartbeat.h \
+    mceproxy.h \
     backgroundactivity_p.h \
+    keepalivetimer_p.h \
+    cpukeepalive_p.h \
+    backgroundworkqueue_p.h \
     common.h
 
 HEADERS += $$PUBLIC_HEADERS $$PRIVATE_HEADERS
@@ -49,6 +78,6 @@ QMAKE_PKGCONFIG_DESCRIPTION = Nemomobile CPU/display keepalive development files
 QMAKE_PKGCONFIG_LIBDIR      = $$target.path
 QMAKE_PKGCONFIG_INCDIR      = $$develheaders.path
 QMAKE_PKGCONFIG_DESTDIR     = pkgconfig
-QMAKE_PKGCONFIG_REQUIRES    = Qt$${QT_MAJOR_VERSION}Core Qt$${QT_MAJOR_VERSION}DBus
+QMAKE_PKGCONFIG_REQUIRES    = Qt$${QT_MAJOR_VERSION}Core Qt$${QT_MAJOR_VERSION}DBus keepalive-glib
 
 INSTALLS += target develheaders pkgconfig
@@ -0,0 +1,140 @@
+/****************************************************************************************
+**
+** Copyright (C) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of nemo-keepalive package.
+**
+** You may use this file under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+****************************************************************************************/
+
+#include "mceproxy.h"
+#include "common.h"
+
+#include <QCoreApplication>
+#include <QDBusServiceWatcher>
+
+#include <mce/dbus-names.h>
+
+/* ========================================================================= *
+ * class MceProxy
+ * ========================================================================= */
+
+Q_GLOBAL_STATIC(MceProxy, mceProxyInstance)
+
+MceProxy *MceProxy::instance()
+{
+    return mceProxyInstance();
+}
+
+MceProxy::MceProxy()
+    : QObject(0)
+    , m_mce_running(-1)
+    , m_mce_req_iface(0)
+    , m_mce_signal_iface(0)
+{
+    TRACE
+    QDBusConnection bus(QDBusConnection::systemBus());
+
+    m_mce_req_iface = new ComNokiaMceRequestInterface(MCE_SERVICE,
+                                                      MCE_REQUEST_PATH,
+                                                      bus, this);
+
+    m_mce_signal_iface = new ComNokiaMceSignalInterface(MCE_SERVICE,
+                                                        MCE_SIGNAL_PATH,
+                                                        bus, this);
+
+    QDBusServiceWatcher *watcher =
+        new QDBusServiceWatcher(MCE_SERVICE, bus,
+                                QDBusServiceWatcher::WatchForOwnerChange,
+                                this);
+    connect(watcher, SIGNAL(serviceRegistered(const QString &)),
+            this, SLOT(mceRegistered()));
+    connect(watcher, SIGNAL(serviceUnregistered(const QString &)),
+            this, SLOT(mceUnregistered()));
+
+    QDBusMessage req =
+        QDBusMessage::createMethodCall(QStringLiteral("org.freedesktop.DBus"),
+                                       QStringLiteral("/org/freedesktop/DBus"),
+                                       QStringLiteral("org.freedesktop.DBus"),
+                                       QStringLiteral("NameHasOwner"));
+    req << QStringLiteral(MCE_SERVICE);
+    QDBusPendingCallWatcher *pc =
+        new QDBusPendingCallWatcher(bus.asyncCall(req), this);
+    connect(pc, SIGNAL(finished(QDBusPendingCallWatcher *)),
+            this, SLOT(nameHasOwnerComplete(QDBusPendingCallWatcher *)));
+
+    /* Signals from D-Bus and state change notifications are
+     * dispatched from the thread that runs the main event loop */
+    QCoreApplication *app = QCoreApplication::instance();
+    if (app && thread() != app->thread())
+        moveToThread(app->thread());
+}
+
+MceProxy::~MceProxy()
+{
+    TRACE
+}
+
+ComNokiaMceRequestInterface *MceProxy::requestIface() const
+{
+    return m_mce_req_iface;
+}
+
+ComNokiaMceSignalInterface *MceProxy::signalIface() const
+{
+    return m_mce_signal_iface;
+}
+
+bool MceProxy::mceRunning() const
+{
+    /* Until told otherwise, assume that mce is available */
+    return m_mce_running.loadAcquire() != 0;
+}
+
+void MceProxy::updateMceRunning(bool running)
+{
+    bool prev = mceRunning();
+    m_mce_running.storeRelease(running ? 1 : 0);
+
+    if (prev != running) {
+        Q_EMIT mceRunningChanged(running);
+    }
+}
+
+void MceProxy::mceRegistered()
+{
+    updateMceRunning(true);
+}
+
+void MceProxy::mceUnregistered()
+{
+    updateMceRunning(false);
+}
+
+void MceProxy::nameHasOwnerComplete(QDBusPendingCallWatcher *call)
+{
+    QDBusPendingReply<bool> reply = *call;
+
+    /* Owner change seen before the reply arrived takes precedence */
+    if (!reply.isError() && m_mce_running.loadAcquire() == -1)
+        updateMceRunning(reply.value());
+
+    call->deleteLater();
+}
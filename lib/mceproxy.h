@@ -0,0 +1,75 @@
+/****************************************************************************************
+**
+** Copyright (C) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of nemo-keepalive package.
+**
+** You may use this file under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+****************************************************************************************/
+
+#ifndef MCEPROXY_H_
+# define MCEPROXY_H_
+
+# include "mceiface.h"
+
+# include <QAtomicInt>
+
+class QDBusPendingCallWatcher;
+
+/* Process wide MCE D-Bus proxy objects
+ *
+ * The proxies are created once, on first use, and live in the thread
+ * that runs the main event loop. Method calls can be made from any
+ * thread. Signal connections made from other threads end up queued.
+ */
+class MceProxy : public QObject
+{
+    Q_OBJECT
+
+public:
+    MceProxy();
+    virtual ~MceProxy();
+
+    static MceProxy *instance();
+
+    ComNokiaMceRequestInterface *requestIface() const;
+    ComNokiaMceSignalInterface *signalIface() const;
+
+    bool mceRunning() const;
+
+Q_SIGNALS:
+    void mceRunningChanged(bool running);
+
+private Q_SLOTS:
+    void mceRegistered();
+    void mceUnregistered();
+    void nameHasOwnerComplete(QDBusPendingCallWatcher *call);
+
+private:
+    Q_DISABLE_COPY(MceProxy)
+    void updateMceRunning(bool running);
+
+    /* -1 = not known yet, 0 = not running, 1 = running */
+    QAtomicInt                   m_mce_running;
+    ComNokiaMceRequestInterface *m_mce_req_iface;
+    ComNokiaMceSignalInterface  *m_mce_signal_iface;
+};
+
+#endif /* MCEPROXY_H_ */
@@ -29,7 +29,9 @@
 ****************************************************************************************/
 
 #include "declarativebackgroundactivity.h"
+#include "cpukeepalive.h"
 #include <QDebug>
+#include <QPointer>
 
 /*!
     \qmltype KeepAlive
@@ -51,10 +53,16 @@
 */
 
 DeclarativeKeepAlive::DeclarativeKeepAlive(QObject *parent)
-    : QObject(parent), mEnabled(false), mBackgroundActivity(0)
+    : QObject(parent), mEnabled(false)
 {
 }
 
+DeclarativeKeepAlive::~DeclarativeKeepAlive()
+{
+    if (mEnabled)
+        CpuKeepalive::release();
+}
+
 bool DeclarativeKeepAlive::enabled() const
 {
     return mEnabled;
@@ -63,13 +71,12 @@ bool DeclarativeKeepAlive::enabled() const
 void DeclarativeKeepAlive::setEnabled(bool enabled)
 {
     if (enabled != mEnabled) {
-        if (!mBackgroundActivity)
-            mBackgroundActivity = new BackgroundActivity(this);
+        // All KeepAlive elements share one process wide keepalive
         mEnabled = enabled;
         if (mEnabled)
-            mBackgroundActivity->run();
+            CpuKeepalive::acquire();
         else
-            mBackgroundActivity->stop();
+            CpuKeepalive::release();
         Q_EMIT enabledChanged();
     }
 }
@@ -203,14 +210,36 @@ void DeclarativeKeepAlive::setEnabled(bool enabled)
 
     If enabled property is true, reschedules wake up timer and
     ends suspend prevention.
+
+    When the job belongs to a BackgroundJobGroup, suspend prevention
+    ends after all triggered jobs in the group have called finished().
 */
 
 DeclarativeBackgroundJob::DeclarativeBackgroundJob(QObject *parent)
-    : QObject(parent), mBackgroundActivity(0), mFrequency(OneHour), mPreviousState(BackgroundActivity::Stopped)
+    : QObject(parent), mGroup(0), mGroupRunning(false), mBackgroundActivity(0), mFrequency(OneHour)
+    , mPreviousState(BackgroundActivity::Stopped)
     , mMinimum(0), mMaximum(0), mTriggeredOnEnable(false), mEnabled(false), mComplete(false)
 {
-    mBackgroundActivity = new BackgroundActivity(this);
-    connect(mBackgroundActivity, SIGNAL(stateChanged()), this, SLOT(stateChanged()));
+}
+
+DeclarativeBackgroundJob::~DeclarativeBackgroundJob()
+{
+    if (mGroup) {
+        DeclarativeBackgroundJobGroup *group = mGroup;
+        mGroup = 0;
+        mGroupRunning = false;
+        group->removeJob(this);
+    }
+}
+
+BackgroundActivity *DeclarativeBackgroundJob::activity()
+{
+    /* Jobs that belong to a group never need an activity of their own */
+    if (!mBackgroundActivity) {
+        mBackgroundActivity = new BackgroundActivity(this);
+        connect(mBackgroundActivity, SIGNAL(stateChanged()), this, SLOT(stateChanged()));
+    }
+    return mBackgroundActivity;
 }
 
 void DeclarativeBackgroundJob::setTriggeredOnEnable(bool triggeredOnEnable)
@@ -243,7 +272,9 @@ void DeclarativeBackgroundJob::setEnabled(bool enabled)
 
 bool DeclarativeBackgroundJob::running() const
 {
-    return mBackgroundActivity->isRunning();
+    if (mGroup)
+        return mGroupRunning;
+    return mBackgroundActivity && mBackgroundActivity->isRunning();
 }
 
 DeclarativeBackgroundJob::Frequency DeclarativeBackgroundJob::frequency() const
@@ -290,7 +321,9 @@ void DeclarativeBackgroundJob::setMaximumWait(int maximum)
 
 QString DeclarativeBackgroundJob::id() const
 {
-    return mBackgroundActivity->id();
+    if (mGroup)
+        return mGroup->id();
+    return const_cast<DeclarativeBackgroundJob *>(this)->activity()->id();
 }
 
 void DeclarativeBackgroundJob::begin()
@@ -298,8 +331,13 @@ void DeclarativeBackgroundJob::begin()
     if (!mComplete || !mEnabled)
         return;
 
+    if (mGroup) {
+        mGroup->begin();
+        return;
+    }
+
     mTimer.stop();
-    mBackgroundActivity->setState(BackgroundActivity::Running);
+    activity()->setState(BackgroundActivity::Running);
 }
 
 void DeclarativeBackgroundJob::finished()
@@ -307,8 +345,16 @@ void DeclarativeBackgroundJob::finished()
     if (!mComplete || !mEnabled)
         return;
 
+    if (mGroup) {
+        if (mGroupRunning) {
+            groupStopped();
+            mGroup->jobFinished(this);
+        }
+        return;
+    }
+
     mTimer.stop();
-    mBackgroundActivity->setState(BackgroundActivity::Waiting);
+    activity()->setState(BackgroundActivity::Waiting);
 }
 
 bool DeclarativeBackgroundJob::event(QEvent *event)
@@ -329,28 +375,73 @@ void DeclarativeBackgroundJob::update()
     if (!mComplete)
         return;
 
-    if (!mEnabled) {
-        mBackgroundActivity->stop();
+    if (mGroup) {
+        // Scheduling is done by the group, disabling a triggered
+        // job just counts as finishing it.
+        if (!mEnabled && mGroupRunning) {
+            groupStopped();
+            mGroup->jobFinished(this);
+        }
+    } else if (!mEnabled) {
+        if (mBackgroundActivity)
+            mBackgroundActivity->stop();
     } else {
+        BackgroundActivity *activity = this->activity();
+
         if (mFrequency == Range)
-            mBackgroundActivity->setWakeupRange(mMinimum, mMaximum);
+            activity->setWakeupRange(mMinimum, mMaximum);
         else
-            mBackgroundActivity->setWakeupFrequency(static_cast<BackgroundActivity::Frequency>(mFrequency));
+            activity->setWakeupFrequency(static_cast<BackgroundActivity::Frequency>(mFrequency));
 
-        if (mBackgroundActivity->state() == BackgroundActivity::Running) {
+        if (activity->state() == BackgroundActivity::Running) {
             // Once Running state is entered, it should be left only when
             // finished() method is called / enabled property is set to false.
         } else if (mTriggeredOnEnable) {
-            mBackgroundActivity->run();
+            activity->run();
         } else {
-            mBackgroundActivity->wait();
+            activity->wait();
         }
     }
 }
 
 void DeclarativeBackgroundJob::scheduleUpdate()
 {
-    mTimer.start(0, this);
+    if (mGroup)
+        mGroup->scheduleUpdate();
+    else
+        mTimer.start(0, this);
+}
+
+void DeclarativeBackgroundJob::setGroup(DeclarativeBackgroundJobGroup *group)
+{
+    if (mGroup == group)
+        return;
+
+    groupStopped();
+    mGroup = group;
+    mTimer.stop();
+
+    if (mGroup) {
+        if (mBackgroundActivity)
+            mBackgroundActivity->stop();
+    } else {
+        scheduleUpdate();
+    }
+}
+
+void DeclarativeBackgroundJob::groupTriggered()
+{
+    mGroupRunning = true;
+    Q_EMIT triggered();
+    Q_EMIT runningChanged();
+}
+
+void DeclarativeBackgroundJob::groupStopped()
+{
+    if (mGroupRunning) {
+        mGroupRunning = false;
+        Q_EMIT runningChanged();
+    }
 }
 
 void DeclarativeBackgroundJob::classBegin()
@@ -371,6 +462,379 @@ void DeclarativeBackgroundJob::stateChanged()
 }
 
 void DeclarativeBackgroundJob::componentComplete()
+{
+    mComplete = true;
+    if (mGroup)
+        mGroup->scheduleUpdate();
+    else
+        update();
+}
+
+//==============================
+
+/*!
+    \qmltype BackgroundJobGroup
+    \inqmlmodule Nemo.KeepAlive
+    \brief Runs a set of background jobs from a single wakeup
+
+    BackgroundJob elements declared inside a BackgroundJobGroup do not
+    schedule wakeups of their own. The group uses one background
+    activity and the frequency, minimumWait and maximumWait of the
+    group. Any scheduling properties set on the jobs are ignored.
+
+    When the wakeup occurs, the triggered() signal is emitted for every
+    enabled job in the group. Suspend is prevented until all of those
+    jobs have called finished() or have been disabled.
+
+    Property changes made to the group or its jobs are applied together
+    on the next pass of the event loop.
+*/
+
+/*!
+    \qmlproperty bool BackgroundJobGroup::triggeredOnEnable
+
+    Setting triggeredOnEnable to true causes the group to be
+    triggered immediately after enabling.
+
+    triggeredOnEnable defaults to false.
+*/
+
+/*!
+    \qmlproperty bool BackgroundJobGroup::enabled
+
+    Wakeups are scheduled while the group is enabled and
+    at least one job in it is enabled.
+
+    enabled defaults to true.
+*/
+
+/*!
+    \qmlproperty bool BackgroundJobGroup::running
+
+    Returns true while the group has been triggered and some of the
+    triggered jobs have not yet finished.
+*/
+
+/*!
+    \qmlproperty enumeration BackgroundJobGroup::frequency
+
+    Sets the wakeup frequency used by the group. Uses the
+    same values as BackgroundJob::frequency.
+
+    frequency defaults to BackgroundJob.OneHour.
+*/
+
+/*!
+    \qmlproperty int BackgroundJobGroup::minimumWait
+
+    Sets the minimum wait delay in seconds, used when frequency
+    is BackgroundJob.Range.
+*/
+
+/*!
+    \qmlproperty int BackgroundJobGroup::maximumWait
+
+    Sets the maximum wait delay in seconds, used when frequency
+    is BackgroundJob.Range.
+*/
+
+/*!
+    \qmlproperty list<BackgroundJob> BackgroundJobGroup::jobs
+
+    The jobs in the group. This is the default property.
+*/
+
+/*!
+    \qmlsignal BackgroundJobGroup::triggered()
+
+    This signal is emitted when a wakeup occurs, before the triggered()
+    signals of the individual jobs.
+*/
+
+/*!
+    \qmlmethod BackgroundJobGroup::begin()
+
+    If the group is enabled, triggers all enabled jobs immediately.
+*/
+
+DeclarativeBackgroundJobGroup::DeclarativeBackgroundJobGroup(QObject *parent)
+    : QObject(parent), mBackgroundActivity(0), mFrequency(DeclarativeBackgroundJob::OneHour)
+    , mPreviousState(BackgroundActivity::Stopped)
+    , mMinimum(0), mMaximum(0), mTriggeredOnEnable(false), mEnabled(true), mComplete(false)
+{
+}
+
+DeclarativeBackgroundJobGroup::~DeclarativeBackgroundJobGroup()
+{
+    // Jobs declared in the group are its children and get deleted
+    // after this - make sure they do not call back to the group.
+    Q_FOREACH (DeclarativeBackgroundJob *job, mJobs) {
+        job->mGroup = 0;
+        job->mGroupRunning = false;
+    }
+    mJobs.clear();
+    mPending.clear();
+}
+
+BackgroundActivity *DeclarativeBackgroundJobGroup::activity()
+{
+    if (!mBackgroundActivity) {
+        mBackgroundActivity = new BackgroundActivity(this);
+        connect(mBackgroundActivity, SIGNAL(stateChanged()), this, SLOT(stateChanged()));
+    }
+    return mBackgroundActivity;
+}
+
+void DeclarativeBackgroundJobGroup::setTriggeredOnEnable(bool triggeredOnEnable)
+{
+    if (triggeredOnEnable != mTriggeredOnEnable) {
+        mTriggeredOnEnable = triggeredOnEnable;
+        Q_EMIT triggeredOnEnableChanged();
+        scheduleUpdate();
+    }
+}
+
+bool DeclarativeBackgroundJobGroup::triggeredOnEnable() const
+{
+    return mTriggeredOnEnable;
+}
+
+bool DeclarativeBackgroundJobGroup::enabled() const
+{
+    return mEnabled;
+}
+
+void DeclarativeBackgroundJobGroup::setEnabled(bool enabled)
+{
+    if (enabled != mEnabled) {
+        mEnabled = enabled;
+        Q_EMIT enabledChanged();
+        scheduleUpdate();
+    }
+}
+
+bool DeclarativeBackgroundJobGroup::running() const
+{
+    return mBackgroundActivity && mBackgroundActivity->isRunning();
+}
+
+DeclarativeBackgroundJob::Frequency DeclarativeBackgroundJobGroup::frequency() const
+{
+    return mFrequency;
+}
+
+void DeclarativeBackgroundJobGroup::setFrequency(DeclarativeBackgroundJob::Frequency frequency)
+{
+    if (frequency != mFrequency) {
+        mFrequency = frequency;
+        Q_EMIT frequencyChanged();
+        scheduleUpdate();
+    }
+}
+
+int DeclarativeBackgroundJobGroup::minimumWait() const
+{
+    return mMinimum;
+}
+
+void DeclarativeBackgroundJobGroup::setMinimumWait(int minimum)
+{
+    if (minimum != mMinimum) {
+        mMinimum = minimum;
+        Q_EMIT minimumWaitChanged();
+        scheduleUpdate();
+    }
+}
+
+int DeclarativeBackgroundJobGroup::maximumWait() const
+{
+    return mMaximum;
+}
+
+void DeclarativeBackgroundJobGroup::setMaximumWait(int maximum)
+{
+    if (maximum != mMaximum) {
+        mMaximum = maximum;
+        Q_EMIT maximumWaitChanged();
+        scheduleUpdate();
+    }
+}
+
+QQmlListProperty<DeclarativeBackgroundJob> DeclarativeBackgroundJobGroup::jobs()
+{
+    return QQmlListProperty<DeclarativeBackgroundJob>(this, 0, jobsAppend, jobsCount, jobsAt, jobsClear);
+}
+
+void DeclarativeBackgroundJobGroup::jobsAppend(QQmlListProperty<DeclarativeBackgroundJob> *list,
+                                               DeclarativeBackgroundJob *job)
+{
+    if (job)
+        static_cast<DeclarativeBackgroundJobGroup *>(list->object)->addJob(job);
+}
+
+int DeclarativeBackgroundJobGroup::jobsCount(QQmlListProperty<DeclarativeBackgroundJob> *list)
+{
+    return static_cast<DeclarativeBackgroundJobGroup *>(list->object)->mJobs.count();
+}
+
+DeclarativeBackgroundJob *DeclarativeBackgroundJobGroup::jobsAt(QQmlListProperty<DeclarativeBackgroundJob> *list,
+                                                                int index)
+{
+    return static_cast<DeclarativeBackgroundJobGroup *>(list->object)->mJobs.value(index);
+}
+
+void DeclarativeBackgroundJobGroup::jobsClear(QQmlListProperty<DeclarativeBackgroundJob> *list)
+{
+    DeclarativeBackgroundJobGroup *group = static_cast<DeclarativeBackgroundJobGroup *>(list->object);
+    while (!group->mJobs.isEmpty())
+        group->removeJob(group->mJobs.last());
+}
+
+void DeclarativeBackgroundJobGroup::addJob(DeclarativeBackgroundJob *job)
+{
+    if (job->mGroup == this)
+        return;
+
+    if (job->mGroup)
+        job->mGroup->removeJob(job);
+
+    mJobs.append(job);
+    job->setGroup(this);
+    scheduleUpdate();
+}
+
+void DeclarativeBackgroundJobGroup::removeJob(DeclarativeBackgroundJob *job)
+{
+    if (!mJobs.removeOne(job))
+        return;
+
+    if (job->mGroup == this)
+        job->setGroup(0);
+    jobFinished(job);
+    scheduleUpdate();
+}
+
+void DeclarativeBackgroundJobGroup::jobFinished(DeclarativeBackgroundJob *job)
+{
+    // Keepalive is released when the last triggered job finishes
+    if (mPending.remove(job) && mPending.isEmpty() && running())
+        mBackgroundActivity->wait();
+}
+
+bool DeclarativeBackgroundJobGroup::haveEnabledJobs() const
+{
+    Q_FOREACH (DeclarativeBackgroundJob *job, mJobs) {
+        if (job->mComplete && job->mEnabled)
+            return true;
+    }
+    return false;
+}
+
+QString DeclarativeBackgroundJobGroup::id() const
+{
+    return const_cast<DeclarativeBackgroundJobGroup *>(this)->activity()->id();
+}
+
+void DeclarativeBackgroundJobGroup::begin()
+{
+    if (!mComplete || !mEnabled || !haveEnabledJobs())
+        return;
+
+    mTimer.stop();
+    activity()->setState(BackgroundActivity::Running);
+}
+
+bool DeclarativeBackgroundJobGroup::event(QEvent *event)
+{
+    if (event->type() == QEvent::Timer) {
+        QTimerEvent *te = static_cast<QTimerEvent *>(event);
+        if (te->timerId() == mTimer.timerId()) {
+            mTimer.stop();
+            update();
+        }
+    }
+
+    return QObject::event(event);
+}
+
+void DeclarativeBackgroundJobGroup::update()
+{
+    if (!mComplete)
+        return;
+
+    // Property changes of all jobs are handled in one pass
+    Q_FOREACH (DeclarativeBackgroundJob *job, mJobs)
+        job->update();
+
+    if (!mEnabled || !haveEnabledJobs()) {
+        if (mBackgroundActivity)
+            mBackgroundActivity->stop();
+    } else {
+        BackgroundActivity *activity = this->activity();
+
+        if (mFrequency == DeclarativeBackgroundJob::Range)
+            activity->setWakeupRange(mMinimum, mMaximum);
+        else
+            activity->setWakeupFrequency(static_cast<BackgroundActivity::Frequency>(mFrequency));
+
+        if (activity->state() == BackgroundActivity::Running) {
+            // Left when all triggered jobs have finished
+        } else if (mTriggeredOnEnable) {
+            activity->run();
+        } else {
+            activity->wait();
+        }
+    }
+}
+
+void DeclarativeBackgroundJobGroup::scheduleUpdate()
+{
+    mTimer.start(0, this);
+}
+
+void DeclarativeBackgroundJobGroup::classBegin()
+{
+}
+
+void DeclarativeBackgroundJobGroup::stateChanged()
+{
+    // Job handlers can finish synchronously and cause nested
+    // state changes - update the previous state before fan out.
+    BackgroundActivity::State previousState = mPreviousState;
+    mPreviousState = mBackgroundActivity->state();
+
+    if (mBackgroundActivity->isRunning()) {
+        QList<QPointer<DeclarativeBackgroundJob> > triggeredJobs;
+        mPending.clear();
+        Q_FOREACH (DeclarativeBackgroundJob *job, mJobs) {
+            if (job->mComplete && job->mEnabled) {
+                mPending.insert(job);
+                triggeredJobs.append(job);
+            }
+        }
+
+        Q_EMIT triggered();
+        Q_EMIT runningChanged();
+
+        if (mPending.isEmpty()) {
+            mBackgroundActivity->wait();
+        } else {
+            Q_FOREACH (const QPointer<DeclarativeBackgroundJob> &job, triggeredJobs) {
+                if (job && mPending.contains(job.data()))
+                    job->groupTriggered();
+            }
+        }
+    }
+
+    if (previousState == BackgroundActivity::Running && !mBackgroundActivity->isRunning()) {
+        mPending.clear();
+        Q_FOREACH (DeclarativeBackgroundJob *job, mJobs)
+            job->groupStopped();
+        Q_EMIT runningChanged();
+    }
+}
+
+void DeclarativeBackgroundJobGroup::componentComplete()
 {
     mComplete = true;
     update();
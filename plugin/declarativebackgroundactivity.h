@@ -34,6 +34,8 @@
 
 # include <QObject>
 # include <QBasicTimer>
+# include <QList>
+# include <QSet>
 # include <qqml.h>
 # include "backgroundactivity.h"
 
@@ -44,6 +46,7 @@ class DeclarativeKeepAlive : public QObject
 
 public:
     DeclarativeKeepAlive(QObject *parent = 0);
+    ~DeclarativeKeepAlive();
 
     bool enabled() const;
     void setEnabled(bool enabled);
@@ -53,11 +56,11 @@ Q_SIGNALS:
 
 private:
     bool mEnabled;
-    BackgroundActivity *mBackgroundActivity;
 };
 
 QML_DECLARE_TYPE(DeclarativeKeepAlive)
 
+class DeclarativeBackgroundJobGroup;
 
 class DeclarativeBackgroundJob : public QObject, public QQmlParserStatus
 {
@@ -74,6 +77,7 @@ class DeclarativeBackgroundJob : public QObject, public QQmlParserStatus
 
 public:
     DeclarativeBackgroundJob(QObject *parent = 0);
+    ~DeclarativeBackgroundJob();
 
     enum Frequency {
         Range             = BackgroundActivity::Range,
@@ -138,8 +142,16 @@ private Q_SLOTS:
     void update();
 
 private:
+    friend class DeclarativeBackgroundJobGroup;
+
+    BackgroundActivity *activity();
     void scheduleUpdate();
+    void setGroup(DeclarativeBackgroundJobGroup *group);
+    void groupTriggered();
+    void groupStopped();
 
+    DeclarativeBackgroundJobGroup *mGroup;
+    bool mGroupRunning;
     BackgroundActivity *mBackgroundActivity;
     QBasicTimer mTimer;
     Frequency mFrequency;
@@ -154,4 +166,98 @@ private:
 QML_DECLARE_TYPE(DeclarativeBackgroundJob)
 
 
+class DeclarativeBackgroundJobGroup : public QObject, public QQmlParserStatus
+{
+    Q_OBJECT
+    Q_PROPERTY(bool triggeredOnEnable READ triggeredOnEnable WRITE setTriggeredOnEnable NOTIFY triggeredOnEnableChanged)
+    Q_PROPERTY(bool enabled READ enabled WRITE setEnabled NOTIFY enabledChanged)
+    Q_PROPERTY(bool running READ running NOTIFY runningChanged)
+    Q_PROPERTY(DeclarativeBackgroundJob::Frequency frequency READ frequency WRITE setFrequency NOTIFY frequencyChanged)
+    Q_PROPERTY(int minimumWait READ minimumWait WRITE setMinimumWait NOTIFY minimumWaitChanged)
+    Q_PROPERTY(int maximumWait READ maximumWait WRITE setMaximumWait NOTIFY maximumWaitChanged)
+    Q_PROPERTY(QQmlListProperty<DeclarativeBackgroundJob> jobs READ jobs)
+    Q_CLASSINFO("DefaultProperty", "jobs")
+
+    Q_INTERFACES(QQmlParserStatus)
+
+public:
+    DeclarativeBackgroundJobGroup(QObject *parent = 0);
+    ~DeclarativeBackgroundJobGroup();
+
+    void setTriggeredOnEnable(bool triggeredOnEnable);
+    bool triggeredOnEnable() const;
+
+    bool enabled() const;
+    void setEnabled(bool enabled);
+
+    bool running() const;
+
+    DeclarativeBackgroundJob::Frequency frequency() const;
+    void setFrequency(DeclarativeBackgroundJob::Frequency frequency);
+
+    int minimumWait() const;
+    void setMinimumWait(int minimum);
+
+    int maximumWait() const;
+    void setMaximumWait(int maximum);
+
+    QQmlListProperty<DeclarativeBackgroundJob> jobs();
+
+    QString id() const;
+
+    void classBegin();
+    void componentComplete();
+
+Q_SIGNALS:
+    void triggeredOnEnableChanged();
+    void enabledChanged();
+    void runningChanged();
+    void frequencyChanged();
+    void minimumWaitChanged();
+    void maximumWaitChanged();
+
+Q_SIGNALS:
+    void triggered();
+
+public Q_SLOTS:
+    void begin();
+
+protected:
+    bool event(QEvent *event);
+
+private Q_SLOTS:
+    void stateChanged();
+    void update();
+
+private:
+    friend class DeclarativeBackgroundJob;
+
+    BackgroundActivity *activity();
+    void scheduleUpdate();
+    void addJob(DeclarativeBackgroundJob *job);
+    void removeJob(DeclarativeBackgroundJob *job);
+    void jobFinished(DeclarativeBackgroundJob *job);
+    bool haveEnabledJobs() const;
+
+    static void jobsAppend(QQmlListProperty<DeclarativeBackgroundJob> *list, DeclarativeBackgroundJob *job);
+    static int jobsCount(QQmlListProperty<DeclarativeBackgroundJob> *list);
+    static DeclarativeBackgroundJob *jobsAt(QQmlListProperty<DeclarativeBackgroundJob> *list, int index);
+    static void jobsClear(QQmlListProperty<DeclarativeBackgroundJob> *list);
+
+    QList<DeclarativeBackgroundJob *> mJobs;
+    QSet<DeclarativeBackgroundJob *> mPending;
+    BackgroundActivity *mBackgroundActivity;
+    QBasicTimer mTimer;
+    DeclarativeBackgroundJob::Frequency mFrequency;
+    BackgroundActivity::State mPreviousState;
+    int mMinimum;
+    int mMaximum;
+    bool mTriggeredOnEnable;
+    bool mEnabled;
+    bool mComplete;
+};
+
+QML_DECLARE_TYPE(DeclarativeBackgroundJobGroup)
+
+
 #endif /* DECLARATIVEBACKGROUNDACTIVITY_H_ */
@@ -70,6 +70,7 @@ public:
         qmlRegisterType<DisplayBlanking>(uri,          1, 2, "DisplayBlanking");
         qmlRegisterType<DeclarativeKeepAlive>(uri,     1, 2, "KeepAlive");
         qmlRegisterType<DeclarativeBackgroundJob>(uri, 1, 2, "BackgroundJob");
+        qmlRegisterType<DeclarativeBackgroundJobGroup>(uri, 1, 2, "BackgroundJobGroup");
     }
 };
 
@@ -10,6 +10,7 @@ QT          += qml
 CONFIG      += plugin
 INCLUDEPATH += ../lib
 LIBS        += -L../lib -lkeepalive
+QMAKE_LFLAGS += -Wl,-rpath-link,$$PWD/../lib-glib
 
 import.files = qmldir *.qml plugins.qmltypes
 import.path  = $$TARGETPATH
@@ -28,6 +28,7 @@ CPU and display keepalive and scheduling library
 %package devel
 Summary:    Development headers for libkeepalive
 Requires:   %{name} = %{version}-%{release}
+Requires:   %{name}-glib-devel = %{version}-%{release}
 
 %description devel
 Development package for CPU and display keepalive and scheduling library
@@ -42,6 +43,7 @@ Examples of CPU and display keepalive and scheduling library
 %package tests
 Summary:    Tests for libkeepalive
 Requires:   %{name} = %{version}-%{release}
+Requires:   dbus
 
 %description tests
 %{summary}.
@@ -84,9 +86,9 @@ BuildArch:  noarch
 
 %build
 export VERSION=`echo %{version} | sed 's/+.*//'`
+%make_build -C lib-glib VERS=${VERSION} _LIBDIR=%{_libdir}
 %qmake5 VERSION=${VERSION}
 %make_build
-%make_build -C lib-glib VERS=${VERSION} _LIBDIR=%{_libdir}
 %make_build -C tools VERS=${VERSION} _LIBDIR=%{_libdir}
 
 %install
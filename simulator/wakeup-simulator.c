@@ -0,0 +1,554 @@
+/****************************************************************************************
+**
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of nemo-keepalive package.
+**
+** You may use this file under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+****************************************************************************************/
+
+/* Offline wakeup alignment simulator
+ *
+ * Evaluates how a mix of background activity wakeup slots and
+ * ranges translates to device wakeups. Wakeup delays are set up via
+ * the same wakeup_delay_t code libkeepalive-glib uses, and wakeups
+ * are modeled after IPHB:
+ *
+ * - global slot waits end at the next multiple of the slot length,
+ *   so all activities using the same slot wake up together
+ *
+ * - ranged waits end at the latest at wait start + range_hi
+ *
+ * - when the device wakes up, every waiting activity whose range
+ *   minimum has already passed is woken up too
+ *
+ * The device stays awake until all woken up activities have
+ * finished running, plus optional per-wakeup resume overhead.
+ */
+
+#include "wakeupdelay.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <glib.h>
+
+#define failure(FMT, ARGS...) do {\
+    fprintf(stderr, "%s: "FMT"\n", __FUNCTION__, ## ARGS);\
+    exit(EXIT_FAILURE);\
+} while(0)
+
+/* ========================================================================= *
+ * Types
+ * ========================================================================= */
+
+/** Activity type described in workload file */
+typedef struct
+{
+    /** Name from workload file */
+    gchar          *sp_name;
+
+    /** Wakeup slot / range */
+    wakeup_delay_t  sp_delay;
+
+    /** Time spent in running state after each wakeup [s] */
+    double          sp_run;
+
+    /** Number of activity instances */
+    int             sp_count;
+
+    /** Number of wakeups over all instances */
+    guint           sp_runs;
+
+    /** Wakeup delay = time from wait start to wakeup [s] */
+    double          sp_delay_sum;
+    double          sp_delay_max;
+
+    /** Lateness = wakeup delay - requested minimum delay [s] */
+    double          sp_late_sum;
+    double          sp_late_min;
+    double          sp_late_max;
+} sim_profile_t;
+
+/** Simulated background activity instance */
+typedef struct
+{
+    /** Activity type */
+    sim_profile_t  *sa_profile;
+
+    /** Flag for: running, or not started yet */
+    bool            sa_running;
+
+    /** When running ends */
+    double          sa_run_end;
+
+    /** When waiting started */
+    double          sa_wait_start;
+
+    /** Earliest time IPHB can wake up the activity */
+    double          sa_earliest;
+
+    /** Latest time IPHB must wake up the activity */
+    double          sa_latest;
+} sim_activity_t;
+
+/** Simulation results */
+typedef struct
+{
+    /** Simulated time [s] */
+    double          sr_duration;
+
+    /** Number of device wakeups */
+    guint           sr_wakeups;
+
+    /** Total time device was awake [s] */
+    double          sr_awake;
+} sim_result_t;
+
+/* ========================================================================= *
+ * Prototypes
+ * ========================================================================= */
+
+/* ------------------------------------------------------------------------- *
+ * WORKLOAD
+ * ------------------------------------------------------------------------- */
+
+static int        sim_parse_int     (const char *text, const char *what, int line);
+static double     sim_parse_double  (const char *text, const char *what, int line);
+static GPtrArray *sim_workload_load (const char *path);
+static void       sim_profile_free  (gpointer aptr);
+
+/* ------------------------------------------------------------------------- *
+ * SIMULATION
+ * ------------------------------------------------------------------------- */
+
+static void       sim_activity_wait (sim_activity_t *self, double now);
+static void       sim_activity_run  (sim_activity_t *self, double now);
+static void       sim_run           (GPtrArray *profiles, sim_result_t *result);
+
+/* ------------------------------------------------------------------------- *
+ * REPORTING
+ * ------------------------------------------------------------------------- */
+
+static void       sim_report_text   (GPtrArray *profiles, const sim_result_t *result);
+static void       sim_report_json   (GPtrArray *profiles, const sim_result_t *result);
+
+/* ------------------------------------------------------------------------- *
+ * MAIN
+ * ------------------------------------------------------------------------- */
+
+int main(int argc, char **argv);
+
+/* ========================================================================= *
+ * Options
+ * ========================================================================= */
+
+/** Simulated time [s] */
+static gint     sim_duration = 24 * 60 * 60;
+
+/** Time added to each device wakeup for resume / suspend [s] */
+static gdouble  sim_overhead = 0;
+
+/** Activity start times are spread over this long period [s] */
+static gint     sim_spread   = 60 * 60;
+
+/** Seed for start time randomization */
+static gint     sim_seed     = 1;
+
+/** Output JSON lines instead of a table */
+static gboolean sim_json     = FALSE;
+
+/* ========================================================================= *
+ * WORKLOAD
+ * ========================================================================= */
+
+static int
+sim_parse_int(const char *text, const char *what, int line)
+{
+    char *end = 0;
+    long  val;
+
+    if( !text )
+        failure("line %d: %s missing", line, what);
+
+    errno = 0;
+    val = strtol(text, &end, 0);
+    if( errno || end == text || *end || val < 0 || val > G_MAXINT )
+        failure("line %d: invalid %s: %s", line, what, text);
+
+    return (int)val;
+}
+
+static double
+sim_parse_double(const char *text, const char *what, int line)
+{
+    char   *end = 0;
+    double  val;
+
+    if( !text )
+        failure("line %d: %s missing", line, what);
+
+    val = strtod(text, &end);
+    if( end == text || *end || val < 0 )
+        failure("line %d: invalid %s: %s", line, what, text);
+
+    return val;
+}
+
+/** Load workload description
+ *
+ * One activity type per line, empty lines and lines starting
+ * with '#' are ignored:
+ *
+ *   NAME slot  SECONDS      RUN [COUNT]
+ *   NAME range LO      HI   RUN [COUNT]
+ *
+ * @param path  file to read, or "-" for stdin
+ *
+ * @return array of sim_profile_t pointers
+ */
+static GPtrArray *
+sim_workload_load(const char *path)
+{
+    GPtrArray *profiles = g_ptr_array_new_with_free_func(sim_profile_free);
+    FILE      *file     = stdin;
+    char      *data     = 0;
+    size_t     size     = 0;
+    int        line     = 0;
+
+    if( strcmp(path, "-") && !(file = fopen(path, "r")) )
+        failure("%s: %m", path);
+
+    while( getline(&data, &size, file) != -1 ) {
+        char *save = 0;
+        char *name = 0;
+        char *mode = 0;
+
+        ++line;
+
+        if( !(name = strtok_r(data, " \t\r\n", &save)) || *name == '#' )
+            continue;
+
+        if( !(mode = strtok_r(0, " \t\r\n", &save)) )
+            failure("line %d: wakeup mode missing", line);
+
+        sim_profile_t *profile = g_malloc0(sizeof *profile);
+        profile->sp_name  = g_strdup(name);
+        profile->sp_delay = wakeup_delay_default;
+        profile->sp_count = 1;
+        g_ptr_array_add(profiles, profile);
+
+        if( !strcmp(mode, "slot") ) {
+            int slot = sim_parse_int(strtok_r(0, " \t\r\n", &save), "slot", line);
+            wakeup_delay_set_slot(&profile->sp_delay, slot);
+        }
+        else if( !strcmp(mode, "range") ) {
+            int lo = sim_parse_int(strtok_r(0, " \t\r\n", &save), "range minimum", line);
+            int hi = sim_parse_int(strtok_r(0, " \t\r\n", &save), "range maximum", line);
+            wakeup_delay_set_range(&profile->sp_delay, lo, hi);
+        }
+        else {
+            failure("line %d: unknown wakeup mode: %s", line, mode);
+        }
+
+        profile->sp_run = sim_parse_double(strtok_r(0, " \t\r\n", &save),
+                                           "run time", line);
+
+        const char *count = strtok_r(0, " \t\r\n", &save);
+        if( count )
+            profile->sp_count = sim_parse_int(count, "count", line);
+    }
+
+    free(data);
+
+    if( file != stdin )
+        fclose(file);
+
+    return profiles;
+}
+
+static void
+sim_profile_free(gpointer aptr)
+{
+    sim_profile_t *profile = aptr;
+
+    g_free(profile->sp_name);
+    g_free(profile);
+}
+
+/* ========================================================================= *
+ * SIMULATION
+ * ========================================================================= */
+
+/** Enter waiting state
+ *
+ * Mimics what IPHB does with the delay range that background
+ * activity passes to heartbeat_set_delay(): equal minimum and
+ * maximum denote a global wakeup slot.
+ *
+ * @param self  activity instance
+ * @param now   simulation time
+ */
+static void
+sim_activity_wait(sim_activity_t *self, double now)
+{
+    const wakeup_delay_t *delay = &self->sa_profile->sp_delay;
+
+    self->sa_running    = false;
+    self->sa_wait_start = now;
+
+    if( delay->wd_range_lo == delay->wd_range_hi ) {
+        double slot = delay->wd_range_lo;
+        self->sa_earliest = self->sa_latest = (floor(now / slot) + 1) * slot;
+    }
+    else {
+        self->sa_earliest = now + delay->wd_range_lo;
+        self->sa_latest   = now + delay->wd_range_hi;
+    }
+}
+
+/** Wake up and enter running state
+ *
+ * @param self  activity instance
+ * @param now   simulation time
+ */
+static void
+sim_activity_run(sim_activity_t *self, double now)
+{
+    sim_profile_t *profile = self->sa_profile;
+
+    double delay = now - self->sa_wait_start;
+    double late  = delay - profile->sp_delay.wd_range_lo;
+
+    if( profile->sp_runs == 0 ) {
+        profile->sp_delay_max = delay;
+        profile->sp_late_min  = late;
+        profile->sp_late_max  = late;
+    }
+    else {
+        profile->sp_delay_max = MAX(profile->sp_delay_max, delay);
+        profile->sp_late_min  = MIN(profile->sp_late_min, late);
+        profile->sp_late_max  = MAX(profile->sp_late_max, late);
+    }
+
+    profile->sp_runs      += 1;
+    profile->sp_delay_sum += delay;
+    profile->sp_late_sum  += late;
+
+    self->sa_running = true;
+    self->sa_run_end = now + profile->sp_run;
+}
+
+static void
+sim_run(GPtrArray *profiles, sim_result_t *result)
+{
+    GRand          *rand      = g_rand_new_with_seed(sim_seed);
+    sim_activity_t *activity  = 0;
+    guint           count     = 0;
+    double          awake_beg = 0;
+    double          awake_end = -1;
+
+    for( guint i = 0; i < profiles->len; ++i )
+        count += ((sim_profile_t *)g_ptr_array_index(profiles, i))->sp_count;
+
+    activity = g_malloc0(MAX(count, 1) * sizeof *activity);
+
+    /* Instances not started yet are treated as running
+     * until their randomized start time */
+    for( guint i = 0, k = 0; i < profiles->len; ++i ) {
+        sim_profile_t *profile = g_ptr_array_index(profiles, i);
+        for( int j = 0; j < profile->sp_count; ++j, ++k ) {
+            activity[k].sa_profile = profile;
+            activity[k].sa_running = true;
+            activity[k].sa_run_end = g_rand_double_range(rand, 0, sim_spread);
+        }
+    }
+
+    memset(result, 0, sizeof *result);
+    result->sr_duration = sim_duration;
+
+    for( ;; ) {
+        double now = INFINITY;
+
+        for( guint k = 0; k < count; ++k ) {
+            double t = activity[k].sa_running ? activity[k].sa_run_end
+                                              : activity[k].sa_latest;
+            now = MIN(now, t);
+        }
+
+        if( now > sim_duration )
+            break;
+
+        bool due = false;
+
+        for( guint k = 0; k < count; ++k ) {
+            if( activity[k].sa_running && activity[k].sa_run_end <= now )
+                sim_activity_wait(&activity[k], now);
+            if( !activity[k].sa_running && activity[k].sa_latest <= now )
+                due = true;
+        }
+
+        if( !due )
+            continue;
+
+        /* Device wakeup, unless already awake */
+        if( now > awake_end ) {
+            if( awake_end >= 0 )
+                result->sr_awake += awake_end - awake_beg;
+            result->sr_wakeups += 1;
+            awake_beg = now;
+            awake_end = now + sim_overhead;
+        }
+
+        for( guint k = 0; k < count; ++k ) {
+            if( activity[k].sa_running || activity[k].sa_earliest > now )
+                continue;
+            sim_activity_run(&activity[k], now);
+            awake_end = MAX(awake_end, activity[k].sa_run_end);
+        }
+    }
+
+    if( awake_end >= 0 )
+        result->sr_awake += MIN(awake_end, sim_duration) - awake_beg;
+
+    g_free(activity);
+    g_rand_free(rand);
+}
+
+/* ========================================================================= *
+ * REPORTING
+ * ========================================================================= */
+
+static void
+sim_report_text(GPtrArray *profiles, const sim_result_t *result)
+{
+    double days = result->sr_duration / (24.0 * 60 * 60);
+
+    printf("simulated time:  %.0f s\n", result->sr_duration);
+    printf("device wakeups:  %u (%.1f / day)\n", result->sr_wakeups,
+           result->sr_wakeups / days);
+    printf("awake time:      %.0f s (%.2f %%)\n", result->sr_awake,
+           100.0 * result->sr_awake / result->sr_duration);
+    printf("\n");
+    printf("%-16s %5s %11s %7s %9s %9s %9s %9s %9s\n",
+           "activity", "count", "wakeup", "runs", "delay", "delay",
+           "late", "late", "late");
+    printf("%-16s %5s %11s %7s %9s %9s %9s %9s %9s\n",
+           "", "", "", "", "mean", "max", "mean", "min", "max");
+
+    for( guint i = 0; i < profiles->len; ++i ) {
+        const sim_profile_t *profile = g_ptr_array_index(profiles, i);
+        const wakeup_delay_t *delay = &profile->sp_delay;
+        double runs = MAX(profile->sp_runs, 1);
+        char   wakeup[32];
+
+        if( delay->wd_slot != BACKGROUND_ACTIVITY_FREQUENCY_RANGE )
+            snprintf(wakeup, sizeof wakeup, "%d", delay->wd_slot);
+        else
+            snprintf(wakeup, sizeof wakeup, "%d-%d",
+                     delay->wd_range_lo, delay->wd_range_hi);
+
+        printf("%-16s %5d %11s %7u %9.1f %9.1f %9.1f %9.1f %9.1f\n",
+               profile->sp_name, profile->sp_count, wakeup, profile->sp_runs,
+               profile->sp_delay_sum / runs, profile->sp_delay_max,
+               profile->sp_late_sum / runs, profile->sp_late_min,
+               profile->sp_late_max);
+    }
+}
+
+static void
+sim_report_json(GPtrArray *profiles, const sim_result_t *result)
+{
+    double days = result->sr_duration / (24.0 * 60 * 60);
+
+    printf("{\"duration\":%.0f,\"wakeups\":%u,\"wakeups_per_day\":%.1f,"
+           "\"awake_s\":%.1f,\"awake_percent\":%.3f}\n",
+           result->sr_duration, result->sr_wakeups,
+           result->sr_wakeups / days, result->sr_awake,
+           100.0 * result->sr_awake / result->sr_duration);
+
+    for( guint i = 0; i < profiles->len; ++i ) {
+        const sim_profile_t *profile = g_ptr_array_index(profiles, i);
+        double runs = MAX(profile->sp_runs, 1);
+
+        printf("{\"activity\":\"%s\",\"count\":%d,\"slot\":%d,"
+               "\"range_lo\":%d,\"range_hi\":%d,\"runs\":%u,"
+               "\"delay_mean\":%.1f,\"delay_max\":%.1f,"
+               "\"late_mean\":%.1f,\"late_min\":%.1f,\"late_max\":%.1f}\n",
+               profile->sp_name, profile->sp_count,
+               profile->sp_delay.wd_slot, profile->sp_delay.wd_range_lo,
+               profile->sp_delay.wd_range_hi, profile->sp_runs,
+               profile->sp_delay_sum / runs, profile->sp_delay_max,
+               profile->sp_late_sum / runs, profile->sp_late_min,
+               profile->sp_late_max);
+    }
+}
+
+/* ========================================================================= *
+ * MAIN
+ * ========================================================================= */
+
+int
+main(int argc, char **argv)
+{
+    GError *err = 0;
+
+    GOptionEntry entries[] = {
+        { "duration", 'd', 0, G_OPTION_ARG_INT, &sim_duration,
+          "Simulated time (default: 86400)", "SECONDS" },
+        { "overhead", 'o', 0, G_OPTION_ARG_DOUBLE, &sim_overhead,
+          "Resume / suspend overhead per device wakeup (default: 0)", "SECONDS" },
+        { "spread", 's', 0, G_OPTION_ARG_INT, &sim_spread,
+          "Spread activity start times over period (default: 3600)", "SECONDS" },
+        { "seed", 'S', 0, G_OPTION_ARG_INT, &sim_seed,
+          "Seed for start time randomization (default: 1)", "NUMBER" },
+        { "json", 'j', 0, G_OPTION_ARG_NONE, &sim_json,
+          "Output JSON lines", 0 },
+        { NULL }
+    };
+
+    GOptionContext *ctx = g_option_context_new("WORKLOAD - simulate background activity wakeups");
+    g_option_context_add_main_entries(ctx, entries, 0);
+    if( !g_option_context_parse(ctx, &argc, &argv, &err) )
+        failure("option parsing failed: %s", err->message);
+    g_option_context_free(ctx);
+
+    if( argc != 2 )
+        failure("workload file not specified, see --help");
+
+    if( sim_duration < 1 || sim_spread < 0 || sim_overhead < 0 )
+        failure("invalid simulation parameters");
+
+    GPtrArray    *profiles = sim_workload_load(argv[1]);
+    sim_result_t  result;
+
+    sim_run(profiles, &result);
+
+    if( sim_json )
+        sim_report_json(profiles, &result);
+    else
+        sim_report_text(profiles, &result);
+
+    g_ptr_array_free(profiles, TRUE);
+
+    return EXIT_SUCCESS;
+}
@@ -6,6 +6,7 @@ QT += testlib
 TEMPLATE = app
 CONFIG -= app_bundle
 LIBS += -L../../lib -lkeepalive
+QMAKE_LFLAGS += -Wl,-rpath-link,$$PWD/../lib-glib
 
 DEFINES += USE_VOLAND_TEST_INTERFACE
 
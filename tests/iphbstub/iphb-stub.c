@@ -0,0 +1,248 @@
+/****************************************************************************************
+**
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of nemo-keepalive package.
+**
+** You may use this file under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+****************************************************************************************/
+
+#include "iphb-stub.h"
+
+#include <iphbd/libiphb.h>
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+
+/* ========================================================================= *
+ * Types
+ * ========================================================================= */
+
+typedef struct iphb_stub_handle_t iphb_stub_handle_t;
+
+struct iphb_stub_handle_t
+{
+    /** Socket pair: [0] given to library, [1] used for wakeups */
+    int                 ish_fd[2];
+
+    /** Flag for: waiting for wakeup */
+    bool                ish_waiting;
+
+    /** Next handle in list of open handles */
+    iphb_stub_handle_t *ish_next;
+};
+
+/* ========================================================================= *
+ * Prototypes
+ * ========================================================================= */
+
+/* ------------------------------------------------------------------------- *
+ * STUB_STATE
+ * ------------------------------------------------------------------------- */
+
+static void iphb_stub_lock          (void);
+static void iphb_stub_unlock        (void);
+static void iphb_stub_wakeup_locked (iphb_stub_handle_t *self);
+
+/* ------------------------------------------------------------------------- *
+ * STUB_API
+ * ------------------------------------------------------------------------- */
+
+void iphb_stub_set_immediate(bool immediate);
+void iphb_stub_wakeup_all   (void);
+void iphb_stub_get_stats    (iphb_stub_stats_t *stats);
+void iphb_stub_reset_stats  (void);
+
+/* ------------------------------------------------------------------------- *
+ * LIBIPHB_API
+ * ------------------------------------------------------------------------- */
+
+iphb_t iphb_open  (int *dummy);
+int    iphb_get_fd(iphb_t iphbh);
+int    iphb_wait2 (iphb_t iphbh, unsigned mintime, unsigned maxtime, int must_wait, int resume);
+iphb_t iphb_close (iphb_t iphbh);
+
+/* ========================================================================= *
+ * STUB_STATE
+ * ========================================================================= */
+
+static pthread_mutex_t     iphb_stub_mutex     = PTHREAD_MUTEX_INITIALIZER;
+static iphb_stub_handle_t *iphb_stub_handles   = 0;
+static bool                iphb_stub_immediate = true;
+static iphb_stub_stats_t   iphb_stub_stats;
+
+static void
+iphb_stub_lock(void)
+{
+    if( pthread_mutex_lock(&iphb_stub_mutex) != 0 )
+        abort();
+}
+
+static void
+iphb_stub_unlock(void)
+{
+    if( pthread_mutex_unlock(&iphb_stub_mutex) != 0 )
+        abort();
+}
+
+static void
+iphb_stub_wakeup_locked(iphb_stub_handle_t *self)
+{
+    /* libiphb sends a status struct, the library just drains it */
+    static const char msg[16] = { 0 };
+
+    if( !self->ish_waiting )
+        goto cleanup;
+
+    self->ish_waiting = false;
+    if( send(self->ish_fd[1], msg, sizeof msg, MSG_DONTWAIT) != -1 )
+        iphb_stub_stats.iss_wakeups += 1;
+
+cleanup:
+    return;
+}
+
+/* ========================================================================= *
+ * STUB_API
+ * ========================================================================= */
+
+void
+iphb_stub_set_immediate(bool immediate)
+{
+    iphb_stub_lock();
+    iphb_stub_immediate = immediate;
+    iphb_stub_unlock();
+}
+
+void
+iphb_stub_wakeup_all(void)
+{
+    iphb_stub_lock();
+    for( iphb_stub_handle_t *iter = iphb_stub_handles; iter; iter = iter->ish_next )
+        iphb_stub_wakeup_locked(iter);
+    iphb_stub_unlock();
+}
+
+void
+iphb_stub_get_stats(iphb_stub_stats_t *stats)
+{
+    iphb_stub_lock();
+    *stats = iphb_stub_stats;
+    iphb_stub_unlock();
+}
+
+void
+iphb_stub_reset_stats(void)
+{
+    iphb_stub_lock();
+    iphb_stub_stats = (iphb_stub_stats_t) { 0, 0, 0, 0, 0, 0 };
+    iphb_stub_unlock();
+}
+
+/* ========================================================================= *
+ * LIBIPHB_API
+ * ========================================================================= */
+
+iphb_t
+iphb_open(int *dummy)
+{
+    iphb_stub_handle_t *self = calloc(1, sizeof *self);
+
+    if( dummy )
+        *dummy = 0;
+
+    if( !self )
+        goto cleanup;
+
+    if( socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, self->ish_fd) == -1 ) {
+        free(self), self = 0;
+        goto cleanup;
+    }
+
+    iphb_stub_lock();
+    self->ish_next = iphb_stub_handles;
+    iphb_stub_handles = self;
+    iphb_stub_stats.iss_opens += 1;
+    iphb_stub_unlock();
+
+cleanup:
+    return self;
+}
+
+int
+iphb_get_fd(iphb_t iphbh)
+{
+    iphb_stub_handle_t *self = iphbh;
+    return self ? self->ish_fd[0] : -1;
+}
+
+int
+iphb_wait2(iphb_t iphbh, unsigned mintime, unsigned maxtime,
+           int must_wait, int resume)
+{
+    iphb_stub_handle_t *self = iphbh;
+
+    (void)must_wait, (void)resume;
+
+    if( !self )
+        return -1;
+
+    iphb_stub_lock();
+    iphb_stub_stats.iss_waits += 1;
+    /* Zero maxtime cancels pending wakeup */
+    self->ish_waiting = (maxtime > 0);
+    if( self->ish_waiting ) {
+        iphb_stub_stats.iss_last_mintime = mintime;
+        iphb_stub_stats.iss_last_maxtime = maxtime;
+    }
+    if( iphb_stub_immediate )
+        iphb_stub_wakeup_locked(self);
+    iphb_stub_unlock();
+
+    return 0;
+}
+
+iphb_t
+iphb_close(iphb_t iphbh)
+{
+    iphb_stub_handle_t *self = iphbh;
+
+    if( !self )
+        goto cleanup;
+
+    iphb_stub_lock();
+    for( iphb_stub_handle_t **pos = &iphb_stub_handles; *pos; pos = &(*pos)->ish_next ) {
+        if( *pos == self ) {
+            *pos = self->ish_next;
+            break;
+        }
+    }
+    iphb_stub_stats.iss_closes += 1;
+    iphb_stub_unlock();
+
+    close(self->ish_fd[0]);
+    close(self->ish_fd[1]);
+    free(self);
+
+cleanup:
+    return 0;
+}
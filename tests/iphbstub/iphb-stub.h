@@ -0,0 +1,79 @@
+/****************************************************************************************
+**
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of nemo-keepalive package.
+**
+** You may use this file under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+****************************************************************************************/
+
+#ifndef KEEPALIVE_TESTS_IPHB_STUB_H_
+# define KEEPALIVE_TESTS_IPHB_STUB_H_
+
+# include <stdbool.h>
+
+# ifdef __cplusplus
+extern "C" {
+# elif 0
+} /* fool JED indentation ... */
+# endif
+
+/* In-process stand-in for libiphb
+ *
+ * Linking iphb-stub.o into an executable interposes the libiphb
+ * functions used by libkeepalive-glib, so that no DSME / IPHB
+ * daemon is needed.
+ *
+ * In immediate mode (the default) every iphb_wait2() call is
+ * followed by a wakeup right away. Otherwise wakeups are delivered
+ * only via iphb_stub_wakeup_all().
+ */
+
+typedef struct
+{
+    /** Number of iphb_open() calls */
+    unsigned iss_opens;
+
+    /** Number of iphb_close() calls */
+    unsigned iss_closes;
+
+    /** Number of iphb_wait2() calls */
+    unsigned iss_waits;
+
+    /** Number of wakeups delivered */
+    unsigned iss_wakeups;
+
+    /** Minimum wait of the latest non-cancel iphb_wait2() call [s] */
+    unsigned iss_last_mintime;
+
+    /** Maximum wait of the latest non-cancel iphb_wait2() call [s] */
+    unsigned iss_last_maxtime;
+} iphb_stub_stats_t;
+
+void iphb_stub_set_immediate(bool immediate);
+void iphb_stub_wakeup_all   (void);
+void iphb_stub_get_stats    (iphb_stub_stats_t *stats);
+void iphb_stub_reset_stats  (void);
+
+# ifdef __cplusplus
+};
+# endif
+
+#endif /* KEEPALIVE_TESTS_IPHB_STUB_H_ */
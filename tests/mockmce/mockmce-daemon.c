@@ -0,0 +1,245 @@
+/****************************************************************************************
+**
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of nemo-keepalive package.
+**
+** You may use this file under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+****************************************************************************************/
+
+/* Standalone mock MCE service
+ *
+ * Serves mockmce on the bus given via DBUS_SYSTEM_BUS_ADDRESS.
+ *
+ * Signals:
+ *   SIGHUP   simulate MCE restart
+ *   SIGUSR1  cycle display status: on -> dimmed -> off -> on
+ *   SIGUSR2  toggle blanking pause allowed state
+ *   SIGINT / SIGTERM  write timelines and summary, then exit
+ */
+
+#include "mockmce.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <glib.h>
+#include <glib-unix.h>
+#include <dbus/dbus.h>
+#include "../../dbus-gmain/dbus-gmain.h"
+
+#include <mce/mode-names.h>
+
+#define failure(FMT, ARGS...) do {\
+    fprintf(stderr, "%s: "FMT"\n", __FUNCTION__, ## ARGS);\
+    exit(EXIT_FAILURE);\
+} while(0)
+
+/* ========================================================================= *
+ * Prototypes
+ * ========================================================================= */
+
+static gboolean daemon_quit_cb          (gpointer aptr);
+static gboolean daemon_restart_cb       (gpointer aptr);
+static gboolean daemon_cycle_display_cb (gpointer aptr);
+static gboolean daemon_toggle_allowed_cb(gpointer aptr);
+static void     daemon_write_summary    (FILE *out);
+
+int main(int argc, char **argv);
+
+/* ========================================================================= *
+ * State
+ * ========================================================================= */
+
+static mockmce_t *daemon_mce      = 0;
+static GMainLoop *daemon_mainloop = 0;
+
+static gint      daemon_period        = 0;
+static gint      daemon_grace_ms      = -1;
+static gint      daemon_restart_ms    = 1000;
+static gboolean  daemon_no_pause      = FALSE;
+static gchar    *daemon_display       = 0;
+static gchar    *daemon_timeline_file = 0;
+static gchar    *daemon_summary_file  = 0;
+static gchar    *daemon_label         = 0;
+
+static bool      daemon_pause_allowed = true;
+
+/* ========================================================================= *
+ * SIGNALS
+ * ========================================================================= */
+
+static gboolean
+daemon_quit_cb(gpointer aptr)
+{
+    (void)aptr;
+    g_main_loop_quit(daemon_mainloop);
+    return G_SOURCE_CONTINUE;
+}
+
+static gboolean
+daemon_restart_cb(gpointer aptr)
+{
+    (void)aptr;
+    fprintf(stderr, "mockmce: restart\n");
+    mockmce_restart(daemon_mce, daemon_restart_ms);
+    return G_SOURCE_CONTINUE;
+}
+
+static gboolean
+daemon_cycle_display_cb(gpointer aptr)
+{
+    (void)aptr;
+
+    static const char * const cycle[] = {
+        MCE_DISPLAY_ON_STRING,
+        MCE_DISPLAY_DIM_STRING,
+        MCE_DISPLAY_OFF_STRING,
+    };
+    static size_t index = 0;
+
+    index = (index + 1) % G_N_ELEMENTS(cycle);
+    fprintf(stderr, "mockmce: display %s\n", cycle[index]);
+    mockmce_set_display_status(daemon_mce, cycle[index]);
+    return G_SOURCE_CONTINUE;
+}
+
+static gboolean
+daemon_toggle_allowed_cb(gpointer aptr)
+{
+    (void)aptr;
+
+    daemon_pause_allowed = !daemon_pause_allowed;
+    fprintf(stderr, "mockmce: blanking pause %s\n",
+            daemon_pause_allowed ? "allowed" : "denied");
+    mockmce_set_blanking_pause_allowed(daemon_mce, daemon_pause_allowed);
+    return G_SOURCE_CONTINUE;
+}
+
+/* ========================================================================= *
+ * REPORTING
+ * ========================================================================= */
+
+static void
+daemon_write_summary(FILE *out)
+{
+    gint64 gap_ms = 0;
+    guint  gaps   = mockmce_get_cpu_keepalive_gaps(daemon_mce, 0, &gap_ms);
+
+    fprintf(out, "{\"label\":\"%s\",\"mce_calls\":%u,"
+            "\"cpu_keepalive_ms\":%lld,\"cpu_keepalive_gaps\":%u,"
+            "\"cpu_keepalive_gap_ms\":%lld}\n",
+            daemon_label ?: "",
+            mockmce_get_call_count(daemon_mce, 0),
+            (long long)mockmce_get_cpu_keepalive_time(daemon_mce, 0),
+            gaps, (long long)gap_ms);
+}
+
+/* ========================================================================= *
+ * MAIN
+ * ========================================================================= */
+
+int
+main(int argc, char **argv)
+{
+    DBusError       err  = DBUS_ERROR_INIT;
+    DBusConnection *con  = 0;
+    GError         *gerr = 0;
+    FILE           *out  = 0;
+
+    GOptionEntry entries[] = {
+        { "period", 'p', 0, G_OPTION_ARG_INT, &daemon_period,
+          "CPU keepalive period to report (default: 60)", "SECONDS" },
+        { "grace", 'g', 0, G_OPTION_ARG_INT, &daemon_grace_ms,
+          "Slack allowed for renew requests (default: 5000)", "MS" },
+        { "restart-delay", 'r', 0, G_OPTION_ARG_INT, &daemon_restart_ms,
+          "Time to stay off the bus on SIGHUP (default: 1000)", "MS" },
+        { "no-blanking-pause", 'n', 0, G_OPTION_ARG_NONE, &daemon_no_pause,
+          "Start with blanking pause not allowed", 0 },
+        { "display", 'd', 0, G_OPTION_ARG_STRING, &daemon_display,
+          "Initial display status (default: on)", "STATUS" },
+        { "timeline", 't', 0, G_OPTION_ARG_STRING, &daemon_timeline_file,
+          "Write client timelines to file on exit", "FILE" },
+        { "summary", 's', 0, G_OPTION_ARG_STRING, &daemon_summary_file,
+          "Append summary to file on exit instead of stdout", "FILE" },
+        { "label", 'l', 0, G_OPTION_ARG_STRING, &daemon_label,
+          "Label to include in the summary", "TEXT" },
+        { NULL }
+    };
+
+    GOptionContext *ctx = g_option_context_new("- mock MCE D-Bus service");
+    g_option_context_add_main_entries(ctx, entries, 0);
+    if( !g_option_context_parse(ctx, &argc, &argv, &gerr) )
+        failure("option parsing failed: %s", gerr->message);
+    g_option_context_free(ctx);
+
+    if( !(con = dbus_bus_get(DBUS_BUS_SYSTEM, &err)) )
+        failure("%s: %s", err.name, err.message);
+    dbus_gmain_set_up_connection(con, 0);
+
+    daemon_mce = mockmce_new(con);
+    if( daemon_period > 0 )
+        mockmce_set_cpu_keepalive_period(daemon_mce, daemon_period);
+    if( daemon_grace_ms >= 0 )
+        mockmce_set_cpu_keepalive_grace(daemon_mce, daemon_grace_ms);
+    if( daemon_display )
+        mockmce_set_display_status(daemon_mce, daemon_display);
+    daemon_pause_allowed = !daemon_no_pause;
+    mockmce_set_blanking_pause_allowed(daemon_mce, daemon_pause_allowed);
+
+    if( !mockmce_start(daemon_mce) )
+        exit(EXIT_FAILURE);
+
+    daemon_mainloop = g_main_loop_new(0, FALSE);
+    g_unix_signal_add(SIGINT,  daemon_quit_cb, 0);
+    g_unix_signal_add(SIGTERM, daemon_quit_cb, 0);
+    g_unix_signal_add(SIGHUP,  daemon_restart_cb, 0);
+    g_unix_signal_add(SIGUSR1, daemon_cycle_display_cb, 0);
+    g_unix_signal_add(SIGUSR2, daemon_toggle_allowed_cb, 0);
+
+    g_main_loop_run(daemon_mainloop);
+
+    if( daemon_timeline_file ) {
+        if( !(out = fopen(daemon_timeline_file, "w")) )
+            failure("%s: %m", daemon_timeline_file);
+        mockmce_write_timelines(daemon_mce, out);
+        fclose(out);
+    }
+
+    if( !daemon_summary_file )
+        daemon_write_summary(stdout);
+    else if( (out = fopen(daemon_summary_file, "a")) )
+        daemon_write_summary(out), fclose(out);
+    else
+        failure("%s: %m", daemon_summary_file);
+
+    mockmce_delete(daemon_mce), daemon_mce = 0;
+    g_main_loop_unref(daemon_mainloop), daemon_mainloop = 0;
+    dbus_connection_unref(con);
+    dbus_error_free(&err);
+
+    g_free(daemon_display);
+    g_free(daemon_timeline_file);
+    g_free(daemon_summary_file);
+    g_free(daemon_label);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,1067 @@
+/****************************************************************************************
+**
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of nemo-keepalive package.
+**
+** You may use this file under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+****************************************************************************************/
+
+#include "mockmce.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <mce/dbus-names.h>
+#include <mce/mode-names.h>
+
+/* ========================================================================= *
+ * Constants
+ * ========================================================================= */
+
+/** Default cpu keepalive period, same as in real MCE [s] */
+#define MOCKMCE_CPU_KEEPALIVE_PERIOD_S  60
+
+/** Default slack allowed for renew requests [ms] */
+#define MOCKMCE_CPU_KEEPALIVE_GRACE_MS  5000
+
+/** Blanking pause duration, same as in real MCE [ms] */
+#define MOCKMCE_BLANKING_PAUSE_MS       60000
+
+/** Session id used for blanking pause events */
+#define MOCKMCE_BLANKING_PAUSE_ID       ""
+
+#define DBUS_NAME_OWNER_CHANGED_SIG     "NameOwnerChanged"
+
+#define DBUS_NAME_OWNER_CHANGED_MATCH \
+     "type='signal'"\
+    ",sender='"DBUS_SERVICE_DBUS"'"\
+    ",interface='"DBUS_INTERFACE_DBUS"'"\
+    ",member='"DBUS_NAME_OWNER_CHANGED_SIG"'"
+
+/* ========================================================================= *
+ * Types
+ * ========================================================================= */
+
+typedef struct mockmce_client_t  mockmce_client_t;
+typedef struct mockmce_session_t mockmce_session_t;
+
+/** CPU keepalive session */
+struct mockmce_session_t
+{
+    /** Client that owns the session */
+    mockmce_client_t *mms_client;
+
+    /** Session id given by client */
+    gchar            *mms_id;
+
+    /** Timer for expiring session */
+    guint             mms_timer_id;
+};
+
+/** Bookkeeping for one D-Bus client */
+struct mockmce_client_t
+{
+    /** Mock MCE object the client belongs to */
+    mockmce_t        *mmc_mce;
+
+    /** Unique bus name of the client */
+    gchar            *mmc_name;
+
+    /** CPU keepalive sessions: id -> mockmce_session_t */
+    GHashTable       *mmc_sessions;
+
+    /** Timer for expiring blanking pause, nonzero while active */
+    guint             mmc_blanking_pause_id;
+
+    /** Timeline of session events */
+    mockmce_event_t  *mmc_events;
+    guint             mmc_event_count;
+    guint             mmc_event_alloc;
+};
+
+struct mockmce_t
+{
+    /** System bus connection */
+    DBusConnection   *mm_connection;
+
+    /** Flag for: MCE service name is owned */
+    bool              mm_running;
+
+    /** Timer for re-acquiring name after simulated restart */
+    guint             mm_restart_id;
+
+    /** Monotonic time stamp of object creation [us] */
+    gint64            mm_created_us;
+
+    /** CPU keepalive period reported to clients [s] */
+    int               mm_period_s;
+
+    /** Slack allowed for cpu keepalive renew requests [ms] */
+    guint             mm_grace_ms;
+
+    /** Blanking pause allowed state */
+    bool              mm_blanking_pause_allowed;
+
+    /** Display status string */
+    gchar            *mm_display_status;
+
+    /** Known clients: unique name -> mockmce_client_t */
+    GHashTable       *mm_clients;
+
+    /** Method call counts: member -> count */
+    GHashTable       *mm_calls;
+
+    /** Total number of method calls */
+    guint             mm_call_total;
+};
+
+/* ========================================================================= *
+ * Prototypes
+ * ========================================================================= */
+
+/* ------------------------------------------------------------------------- *
+ * UTILITY
+ * ------------------------------------------------------------------------- */
+
+static gint64 mockmce_now_ms(const mockmce_t *self);
+
+/* ------------------------------------------------------------------------- *
+ * SESSION
+ * ------------------------------------------------------------------------- */
+
+static mockmce_session_t *mockmce_session_new       (mockmce_client_t *client, const char *id);
+static void               mockmce_session_delete    (mockmce_session_t *self);
+static void               mockmce_session_delete_cb (gpointer aptr);
+static gboolean           mockmce_session_expire_cb (gpointer aptr);
+static void               mockmce_session_renew     (mockmce_session_t *self);
+
+/* ------------------------------------------------------------------------- *
+ * CLIENT
+ * ------------------------------------------------------------------------- */
+
+static mockmce_client_t *mockmce_client_new             (mockmce_t *mce, const char *name);
+static void              mockmce_client_delete          (mockmce_client_t *self);
+static void              mockmce_client_delete_cb       (gpointer aptr);
+static void              mockmce_client_add_event       (mockmce_client_t *self, mockmce_event_type_t type, const char *id);
+static void              mockmce_client_clear_events    (mockmce_client_t *self);
+static void              mockmce_client_cpu_start       (mockmce_client_t *self, const char *id);
+static void              mockmce_client_cpu_stop        (mockmce_client_t *self, const char *id);
+static void              mockmce_client_drop_sessions   (mockmce_client_t *self, mockmce_event_type_t type);
+static gboolean          mockmce_client_pause_expire_cb (gpointer aptr);
+static void              mockmce_client_pause_start     (mockmce_client_t *self);
+static void              mockmce_client_pause_stop      (mockmce_client_t *self, mockmce_event_type_t type);
+static guint             mockmce_client_gaps            (const mockmce_client_t *self, gint64 now, gint64 *total_ms);
+static gint64            mockmce_client_cpu_time        (const mockmce_client_t *self, gint64 now);
+static void              mockmce_client_write           (const mockmce_client_t *self, FILE *out);
+
+/* ------------------------------------------------------------------------- *
+ * DBUS
+ * ------------------------------------------------------------------------- */
+
+static mockmce_client_t  *mockmce_lookup_client    (const mockmce_t *self, const char *name);
+static mockmce_client_t  *mockmce_add_client       (mockmce_t *self, const char *name);
+static void               mockmce_count_call       (mockmce_t *self, const char *member);
+static void               mockmce_send_signal      (mockmce_t *self, const char *member, int type, const void *value);
+static DBusMessage       *mockmce_handle_method    (mockmce_t *self, DBusMessage *req);
+static void               mockmce_handle_name_owner(mockmce_t *self, DBusMessage *sig);
+static DBusHandlerResult  mockmce_filter_cb        (DBusConnection *con, DBusMessage *msg, void *aptr);
+static gboolean           mockmce_restart_cb       (gpointer aptr);
+
+/* ========================================================================= *
+ * UTILITY
+ * ========================================================================= */
+
+static gint64
+mockmce_now_ms(const mockmce_t *self)
+{
+    return (g_get_monotonic_time() - self->mm_created_us) / 1000;
+}
+
+/* ========================================================================= *
+ * SESSION
+ * ========================================================================= */
+
+static mockmce_session_t *
+mockmce_session_new(mockmce_client_t *client, const char *id)
+{
+    mockmce_session_t *self = g_malloc0(sizeof *self);
+
+    self->mms_client   = client;
+    self->mms_id       = g_strdup(id);
+    self->mms_timer_id = 0;
+
+    return self;
+}
+
+static void
+mockmce_session_delete(mockmce_session_t *self)
+{
+    if( !self )
+        goto cleanup;
+
+    if( self->mms_timer_id )
+        g_source_remove(self->mms_timer_id), self->mms_timer_id = 0;
+
+    g_free(self->mms_id);
+    g_free(self);
+
+cleanup:
+    return;
+}
+
+static void
+mockmce_session_delete_cb(gpointer aptr)
+{
+    mockmce_session_delete(aptr);
+}
+
+static gboolean
+mockmce_session_expire_cb(gpointer aptr)
+{
+    mockmce_session_t *self   = aptr;
+    mockmce_client_t  *client = self->mms_client;
+
+    self->mms_timer_id = 0;
+
+    mockmce_client_add_event(client, MOCKMCE_EVENT_CPU_KEEPALIVE_EXPIRE,
+                             self->mms_id);
+    g_hash_table_remove(client->mmc_sessions, self->mms_id);
+
+    return G_SOURCE_REMOVE;
+}
+
+static void
+mockmce_session_renew(mockmce_session_t *self)
+{
+    const mockmce_t *mce = self->mms_client->mmc_mce;
+
+    if( self->mms_timer_id )
+        g_source_remove(self->mms_timer_id);
+
+    self->mms_timer_id = g_timeout_add(mce->mm_period_s * 1000 + mce->mm_grace_ms,
+                                       mockmce_session_expire_cb, self);
+}
+
+/* ========================================================================= *
+ * CLIENT
+ * ========================================================================= */
+
+static mockmce_client_t *
+mockmce_client_new(mockmce_t *mce, const char *name)
+{
+    mockmce_client_t *self = g_malloc0(sizeof *self);
+
+    self->mmc_mce      = mce;
+    self->mmc_name     = g_strdup(name);
+    self->mmc_sessions = g_hash_table_new_full(g_str_hash, g_str_equal, 0,
+                                               mockmce_session_delete_cb);
+    self->mmc_blanking_pause_id = 0;
+
+    self->mmc_events      = 0;
+    self->mmc_event_count = 0;
+    self->mmc_event_alloc = 0;
+
+    return self;
+}
+
+static void
+mockmce_client_delete(mockmce_client_t *self)
+{
+    if( !self )
+        goto cleanup;
+
+    if( self->mmc_blanking_pause_id )
+        g_source_remove(self->mmc_blanking_pause_id);
+
+    g_hash_table_destroy(self->mmc_sessions);
+    mockmce_client_clear_events(self);
+    g_free(self->mmc_events);
+    g_free(self->mmc_name);
+    g_free(self);
+
+cleanup:
+    return;
+}
+
+static void
+mockmce_client_delete_cb(gpointer aptr)
+{
+    mockmce_client_delete(aptr);
+}
+
+static void
+mockmce_client_add_event(mockmce_client_t *self, mockmce_event_type_t type,
+                         const char *id)
+{
+    if( self->mmc_event_count == self->mmc_event_alloc ) {
+        self->mmc_event_alloc = self->mmc_event_alloc ? self->mmc_event_alloc * 2 : 32;
+        self->mmc_events = g_realloc(self->mmc_events,
+                                     self->mmc_event_alloc * sizeof *self->mmc_events);
+    }
+
+    mockmce_event_t *event = &self->mmc_events[self->mmc_event_count++];
+    event->mme_time_ms = mockmce_now_ms(self->mmc_mce);
+    event->mme_type    = type;
+    event->mme_id      = g_strdup(id ?: "");
+}
+
+static void
+mockmce_client_clear_events(mockmce_client_t *self)
+{
+    for( guint i = 0; i < self->mmc_event_count; ++i )
+        g_free((gchar *)self->mmc_events[i].mme_id);
+    self->mmc_event_count = 0;
+}
+
+static void
+mockmce_client_cpu_start(mockmce_client_t *self, const char *id)
+{
+    mockmce_session_t *session = g_hash_table_lookup(self->mmc_sessions, id);
+
+    if( session ) {
+        mockmce_client_add_event(self, MOCKMCE_EVENT_CPU_KEEPALIVE_RENEW, id);
+    }
+    else {
+        session = mockmce_session_new(self, id);
+        g_hash_table_insert(self->mmc_sessions, session->mms_id, session);
+        mockmce_client_add_event(self, MOCKMCE_EVENT_CPU_KEEPALIVE_START, id);
+    }
+
+    mockmce_session_renew(session);
+}
+
+static void
+mockmce_client_cpu_stop(mockmce_client_t *self, const char *id)
+{
+    /* Stop is recorded also for already expired sessions,
+     * it marks the end of a keepalive gap */
+    mockmce_client_add_event(self, MOCKMCE_EVENT_CPU_KEEPALIVE_STOP, id);
+    g_hash_table_remove(self->mmc_sessions, id);
+}
+
+static void
+mockmce_client_drop_sessions(mockmce_client_t *self, mockmce_event_type_t type)
+{
+    GHashTableIter iter;
+    gpointer       key;
+
+    g_hash_table_iter_init(&iter, self->mmc_sessions);
+    while( g_hash_table_iter_next(&iter, &key, 0) )
+        mockmce_client_add_event(self, type, key);
+    g_hash_table_remove_all(self->mmc_sessions);
+
+    if( self->mmc_blanking_pause_id ) {
+        g_source_remove(self->mmc_blanking_pause_id),
+            self->mmc_blanking_pause_id = 0;
+        mockmce_client_add_event(self, type, MOCKMCE_BLANKING_PAUSE_ID);
+    }
+}
+
+static gboolean
+mockmce_client_pause_expire_cb(gpointer aptr)
+{
+    mockmce_client_t *self = aptr;
+
+    self->mmc_blanking_pause_id = 0;
+    mockmce_client_add_event(self, MOCKMCE_EVENT_BLANKING_PAUSE_EXPIRE,
+                             MOCKMCE_BLANKING_PAUSE_ID);
+
+    return G_SOURCE_REMOVE;
+}
+
+static void
+mockmce_client_pause_start(mockmce_client_t *self)
+{
+    mockmce_event_type_t type = MOCKMCE_EVENT_BLANKING_PAUSE_START;
+
+    if( !self->mmc_mce->mm_blanking_pause_allowed ) {
+        mockmce_client_add_event(self, MOCKMCE_EVENT_BLANKING_PAUSE_DENIED,
+                                 MOCKMCE_BLANKING_PAUSE_ID);
+        goto cleanup;
+    }
+
+    if( self->mmc_blanking_pause_id ) {
+        g_source_remove(self->mmc_blanking_pause_id);
+        type = MOCKMCE_EVENT_BLANKING_PAUSE_RENEW;
+    }
+
+    self->mmc_blanking_pause_id = g_timeout_add(MOCKMCE_BLANKING_PAUSE_MS,
+                                                mockmce_client_pause_expire_cb,
+                                                self);
+    mockmce_client_add_event(self, type, MOCKMCE_BLANKING_PAUSE_ID);
+
+cleanup:
+    return;
+}
+
+static void
+mockmce_client_pause_stop(mockmce_client_t *self, mockmce_event_type_t type)
+{
+    if( !self->mmc_blanking_pause_id )
+        goto cleanup;
+
+    g_source_remove(self->mmc_blanking_pause_id),
+        self->mmc_blanking_pause_id = 0;
+    mockmce_client_add_event(self, type, MOCKMCE_BLANKING_PAUSE_ID);
+
+cleanup:
+    return;
+}
+
+static guint
+mockmce_client_gaps(const mockmce_client_t *self, gint64 now, gint64 *total_ms)
+{
+    guint gaps = 0;
+
+    for( guint i = 0; i < self->mmc_event_count; ++i ) {
+        const mockmce_event_t *expired = &self->mmc_events[i];
+
+        if( expired->mme_type != MOCKMCE_EVENT_CPU_KEEPALIVE_EXPIRE )
+            continue;
+
+        /* Gap lasts until client starts or stops the same session */
+        gint64 end = now;
+        for( guint j = i + 1; j < self->mmc_event_count; ++j ) {
+            const mockmce_event_t *event = &self->mmc_events[j];
+            bool ends = false;
+
+            switch( event->mme_type ) {
+            case MOCKMCE_EVENT_CPU_KEEPALIVE_START:
+            case MOCKMCE_EVENT_CPU_KEEPALIVE_STOP:
+                ends = !strcmp(event->mme_id, expired->mme_id);
+                break;
+            case MOCKMCE_EVENT_CLIENT_EXIT:
+                ends = true;
+                break;
+            default:
+                break;
+            }
+
+            if( ends ) {
+                end = event->mme_time_ms;
+                break;
+            }
+        }
+
+        gaps += 1;
+        if( total_ms )
+            *total_ms += end - expired->mme_time_ms;
+    }
+
+    return gaps;
+}
+
+static gint64
+mockmce_client_cpu_time(const mockmce_client_t *self, gint64 now)
+{
+    GHashTable *active = g_hash_table_new(g_str_hash, g_str_equal);
+    gint64      total  = 0;
+    gint64      since  = 0;
+
+    for( guint i = 0; i < self->mmc_event_count; ++i ) {
+        const mockmce_event_t *event = &self->mmc_events[i];
+        bool was_active = g_hash_table_size(active) > 0;
+
+        switch( event->mme_type ) {
+        case MOCKMCE_EVENT_CPU_KEEPALIVE_START:
+        case MOCKMCE_EVENT_CPU_KEEPALIVE_RENEW:
+            g_hash_table_insert(active, (gpointer)event->mme_id, 0);
+            break;
+        case MOCKMCE_EVENT_CPU_KEEPALIVE_STOP:
+        case MOCKMCE_EVENT_CPU_KEEPALIVE_EXPIRE:
+        case MOCKMCE_EVENT_SESSION_LOST:
+        case MOCKMCE_EVENT_CLIENT_EXIT:
+            if( event->mme_type == MOCKMCE_EVENT_CLIENT_EXIT )
+                g_hash_table_remove_all(active);
+            else
+                g_hash_table_remove(active, event->mme_id);
+            break;
+        default:
+            break;
+        }
+
+        bool is_active = g_hash_table_size(active) > 0;
+        if( !was_active && is_active )
+            since = event->mme_time_ms;
+        else if( was_active && !is_active )
+            total += event->mme_time_ms - since;
+    }
+
+    if( g_hash_table_size(active) > 0 )
+        total += now - since;
+
+    g_hash_table_destroy(active);
+    return total;
+}
+
+static void
+mockmce_client_write(const mockmce_client_t *self, FILE *out)
+{
+    fprintf(out, "{\"client\":\"%s\",\"events\":[", self->mmc_name);
+    for( guint i = 0; i < self->mmc_event_count; ++i ) {
+        const mockmce_event_t *event = &self->mmc_events[i];
+        fprintf(out, "%s{\"t\":%lld,\"type\":\"%s\",\"id\":\"%s\"}",
+                i ? "," : "", (long long)event->mme_time_ms,
+                mockmce_event_type_repr(event->mme_type), event->mme_id);
+    }
+    fprintf(out, "]}\n");
+}
+
+/* ========================================================================= *
+ * DBUS
+ * ========================================================================= */
+
+static mockmce_client_t *
+mockmce_lookup_client(const mockmce_t *self, const char *name)
+{
+    return name ? g_hash_table_lookup(self->mm_clients, name) : 0;
+}
+
+static mockmce_client_t *
+mockmce_add_client(mockmce_t *self, const char *name)
+{
+    mockmce_client_t *client = mockmce_lookup_client(self, name);
+
+    if( !client ) {
+        client = mockmce_client_new(self, name);
+        g_hash_table_insert(self->mm_clients, client->mmc_name, client);
+    }
+
+    return client;
+}
+
+static void
+mockmce_count_call(mockmce_t *self, const char *member)
+{
+    guint count = GPOINTER_TO_UINT(g_hash_table_lookup(self->mm_calls, member));
+
+    g_hash_table_insert(self->mm_calls, g_strdup(member),
+                        GUINT_TO_POINTER(count + 1));
+    self->mm_call_total += 1;
+}
+
+static void
+mockmce_send_signal(mockmce_t *self, const char *member, int type,
+                    const void *value)
+{
+    DBusMessage *sig = 0;
+
+    if( !self->mm_running )
+        goto cleanup;
+
+    if( !(sig = dbus_message_new_signal(MCE_SIGNAL_PATH, MCE_SIGNAL_IF, member)) )
+        goto cleanup;
+
+    dbus_message_append_args(sig, type, value, DBUS_TYPE_INVALID);
+    dbus_connection_send(self->mm_connection, sig, 0);
+
+cleanup:
+    if( sig )
+        dbus_message_unref(sig);
+}
+
+static DBusMessage *
+mockmce_handle_method(mockmce_t *self, DBusMessage *req)
+{
+    DBusMessage      *rsp    = 0;
+    const char       *member = dbus_message_get_member(req);
+    const char       *id     = 0;
+    mockmce_client_t *client = mockmce_add_client(self,
+                                                  dbus_message_get_sender(req));
+
+    mockmce_count_call(self, member);
+
+    if( !strcmp(member, MCE_CPU_KEEPALIVE_PERIOD_REQ) ) {
+        dbus_int32_t period = self->mm_period_s;
+        rsp = dbus_message_new_method_return(req);
+        dbus_message_append_args(rsp,
+                                 DBUS_TYPE_INT32, &period,
+                                 DBUS_TYPE_INVALID);
+    }
+    else if( !strcmp(member, MCE_CPU_KEEPALIVE_START_REQ) ||
+             !strcmp(member, MCE_CPU_KEEPALIVE_STOP_REQ) ) {
+        /* Older clients do not pass session id */
+        if( !dbus_message_get_args(req, 0,
+                                   DBUS_TYPE_STRING, &id,
+                                   DBUS_TYPE_INVALID) )
+            id = "";
+
+        if( !strcmp(member, MCE_CPU_KEEPALIVE_START_REQ) )
+            mockmce_client_cpu_start(client, id);
+        else
+            mockmce_client_cpu_stop(client, id);
+        rsp = dbus_message_new_method_return(req);
+    }
+    else if( !strcmp(member, MCE_PREVENT_BLANK_REQ) ) {
+        mockmce_client_pause_start(client);
+        rsp = dbus_message_new_method_return(req);
+    }
+    else if( !strcmp(member, MCE_CANCEL_PREVENT_BLANK_REQ) ) {
+        mockmce_client_pause_stop(client, MOCKMCE_EVENT_BLANKING_PAUSE_CANCEL);
+        rsp = dbus_message_new_method_return(req);
+    }
+    else if( !strcmp(member, MCE_PREVENT_BLANK_ALLOWED_GET) ) {
+        dbus_bool_t allowed = self->mm_blanking_pause_allowed;
+        rsp = dbus_message_new_method_return(req);
+        dbus_message_append_args(rsp,
+                                 DBUS_TYPE_BOOLEAN, &allowed,
+                                 DBUS_TYPE_INVALID);
+    }
+    else if( !strcmp(member, MCE_DISPLAY_ON_REQ) ) {
+        mockmce_set_display_status(self, MCE_DISPLAY_ON_STRING);
+        rsp = dbus_message_new_method_return(req);
+    }
+    else if( !strcmp(member, MCE_DISPLAY_STATUS_GET) ) {
+        const char *status = self->mm_display_status;
+        rsp = dbus_message_new_method_return(req);
+        dbus_message_append_args(rsp,
+                                 DBUS_TYPE_STRING, &status,
+                                 DBUS_TYPE_INVALID);
+    }
+    else {
+        rsp = dbus_message_new_error(req, DBUS_ERROR_UNKNOWN_METHOD, member);
+    }
+
+    return rsp;
+}
+
+static void
+mockmce_handle_name_owner(mockmce_t *self, DBusMessage *sig)
+{
+    const char       *name   = 0;
+    const char       *prev   = 0;
+    const char       *curr   = 0;
+    mockmce_client_t *client = 0;
+
+    if( !dbus_message_get_args(sig, 0,
+                               DBUS_TYPE_STRING, &name,
+                               DBUS_TYPE_STRING, &prev,
+                               DBUS_TYPE_STRING, &curr,
+                               DBUS_TYPE_INVALID) )
+        goto cleanup;
+
+    if( *curr || !(client = mockmce_lookup_client(self, name)) )
+        goto cleanup;
+
+    g_hash_table_remove_all(client->mmc_sessions);
+    if( client->mmc_blanking_pause_id )
+        g_source_remove(client->mmc_blanking_pause_id),
+            client->mmc_blanking_pause_id = 0;
+    mockmce_client_add_event(client, MOCKMCE_EVENT_CLIENT_EXIT, "");
+
+cleanup:
+    return;
+}
+
+static DBusHandlerResult
+mockmce_filter_cb(DBusConnection *con, DBusMessage *msg, void *aptr)
+{
+    (void)con;
+
+    mockmce_t         *self = aptr;
+    DBusHandlerResult  res  = DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+    DBusMessage       *rsp  = 0;
+
+    if( dbus_message_is_signal(msg, DBUS_INTERFACE_DBUS,
+                               DBUS_NAME_OWNER_CHANGED_SIG) ) {
+        mockmce_handle_name_owner(self, msg);
+        goto cleanup;
+    }
+
+    if( !self->mm_running )
+        goto cleanup;
+
+    if( dbus_message_get_type(msg) != DBUS_MESSAGE_TYPE_METHOD_CALL )
+        goto cleanup;
+
+    if( g_strcmp0(dbus_message_get_interface(msg), MCE_REQUEST_IF) ||
+        g_strcmp0(dbus_message_get_path(msg), MCE_REQUEST_PATH) )
+        goto cleanup;
+
+    res = DBUS_HANDLER_RESULT_HANDLED;
+
+    if( !(rsp = mockmce_handle_method(self, msg)) )
+        goto cleanup;
+
+    if( !dbus_message_get_no_reply(msg) )
+        dbus_connection_send(self->mm_connection, rsp, 0);
+
+cleanup:
+    if( rsp )
+        dbus_message_unref(rsp);
+
+    return res;
+}
+
+static gboolean
+mockmce_restart_cb(gpointer aptr)
+{
+    mockmce_t *self = aptr;
+
+    self->mm_restart_id = 0;
+    mockmce_start(self);
+
+    return G_SOURCE_REMOVE;
+}
+
+/* ========================================================================= *
+ * EXTERNAL_API
+ * ========================================================================= */
+
+mockmce_t *
+mockmce_new(DBusConnection *connection)
+{
+    mockmce_t *self = g_malloc0(sizeof *self);
+
+    self->mm_connection     = dbus_connection_ref(connection);
+    self->mm_running        = false;
+    self->mm_restart_id     = 0;
+    self->mm_created_us     = g_get_monotonic_time();
+    self->mm_period_s       = MOCKMCE_CPU_KEEPALIVE_PERIOD_S;
+    self->mm_grace_ms       = MOCKMCE_CPU_KEEPALIVE_GRACE_MS;
+    self->mm_display_status = g_strdup(MCE_DISPLAY_ON_STRING);
+    self->mm_call_total     = 0;
+
+    self->mm_blanking_pause_allowed = true;
+
+    self->mm_clients = g_hash_table_new_full(g_str_hash, g_str_equal, 0,
+                                             mockmce_client_delete_cb);
+    self->mm_calls   = g_hash_table_new_full(g_str_hash, g_str_equal,
+                                             g_free, 0);
+
+    dbus_connection_add_filter(self->mm_connection, mockmce_filter_cb, self, 0);
+    dbus_bus_add_match(self->mm_connection, DBUS_NAME_OWNER_CHANGED_MATCH, 0);
+
+    return self;
+}
+
+void
+mockmce_delete(mockmce_t *self)
+{
+    if( !self )
+        goto cleanup;
+
+    mockmce_stop(self);
+
+    dbus_bus_remove_match(self->mm_connection, DBUS_NAME_OWNER_CHANGED_MATCH, 0);
+    dbus_connection_remove_filter(self->mm_connection, mockmce_filter_cb, self);
+
+    g_hash_table_destroy(self->mm_calls);
+    g_hash_table_destroy(self->mm_clients);
+    g_free(self->mm_display_status);
+    dbus_connection_unref(self->mm_connection);
+    g_free(self);
+
+cleanup:
+    return;
+}
+
+bool
+mockmce_start(mockmce_t *self)
+{
+    DBusError err = DBUS_ERROR_INIT;
+
+    if( self->mm_restart_id )
+        g_source_remove(self->mm_restart_id), self->mm_restart_id = 0;
+
+    if( self->mm_running )
+        goto cleanup;
+
+    int rc = dbus_bus_request_name(self->mm_connection, MCE_SERVICE,
+                                   DBUS_NAME_FLAG_DO_NOT_QUEUE, &err);
+    if( rc != DBUS_REQUEST_NAME_REPLY_PRIMARY_OWNER ) {
+        fprintf(stderr, "mockmce: could not acquire %s: %s\n", MCE_SERVICE,
+                dbus_error_is_set(&err) ? err.message : "already owned");
+        goto cleanup;
+    }
+
+    self->mm_running = true;
+
+cleanup:
+    dbus_error_free(&err);
+    return self->mm_running;
+}
+
+void
+mockmce_stop(mockmce_t *self)
+{
+    GHashTableIter iter;
+    gpointer       val;
+
+    if( self->mm_restart_id )
+        g_source_remove(self->mm_restart_id), self->mm_restart_id = 0;
+
+    if( !self->mm_running )
+        goto cleanup;
+
+    g_hash_table_iter_init(&iter, self->mm_clients);
+    while( g_hash_table_iter_next(&iter, 0, &val) )
+        mockmce_client_drop_sessions(val, MOCKMCE_EVENT_SESSION_LOST);
+
+    dbus_bus_release_name(self->mm_connection, MCE_SERVICE, 0);
+    self->mm_running = false;
+
+cleanup:
+    return;
+}
+
+void
+mockmce_restart(mockmce_t *self, guint delay_ms)
+{
+    mockmce_stop(self);
+    self->mm_restart_id = g_timeout_add(delay_ms, mockmce_restart_cb, self);
+}
+
+bool
+mockmce_is_running(const mockmce_t *self)
+{
+    return self->mm_running;
+}
+
+void
+mockmce_set_cpu_keepalive_period(mockmce_t *self, int seconds)
+{
+    self->mm_period_s = seconds > 0 ? seconds : MOCKMCE_CPU_KEEPALIVE_PERIOD_S;
+}
+
+void
+mockmce_set_cpu_keepalive_grace(mockmce_t *self, guint grace_ms)
+{
+    self->mm_grace_ms = grace_ms;
+}
+
+void
+mockmce_set_blanking_pause_allowed(mockmce_t *self, bool allowed)
+{
+    GHashTableIter iter;
+    gpointer       val;
+
+    if( self->mm_blanking_pause_allowed == allowed )
+        goto cleanup;
+
+    self->mm_blanking_pause_allowed = allowed;
+
+    if( !allowed ) {
+        g_hash_table_iter_init(&iter, self->mm_clients);
+        while( g_hash_table_iter_next(&iter, 0, &val) )
+            mockmce_client_pause_stop(val, MOCKMCE_EVENT_BLANKING_PAUSE_CANCEL);
+    }
+
+    dbus_bool_t value = allowed;
+    mockmce_send_signal(self, MCE_PREVENT_BLANK_ALLOWED_SIG,
+                        DBUS_TYPE_BOOLEAN, &value);
+
+cleanup:
+    return;
+}
+
+void
+mockmce_set_display_status(mockmce_t *self, const char *status)
+{
+    if( !g_strcmp0(self->mm_display_status, status) )
+        goto cleanup;
+
+    g_free(self->mm_display_status);
+    self->mm_display_status = g_strdup(status);
+
+    mockmce_send_signal(self, MCE_DISPLAY_SIG, DBUS_TYPE_STRING,
+                        &self->mm_display_status);
+
+cleanup:
+    return;
+}
+
+guint
+mockmce_get_call_count(const mockmce_t *self, const char *member)
+{
+    if( !member )
+        return self->mm_call_total;
+    return GPOINTER_TO_UINT(g_hash_table_lookup(self->mm_calls, member));
+}
+
+gchar **
+mockmce_get_clients(const mockmce_t *self)
+{
+    GHashTableIter iter;
+    gpointer       key;
+    gchar        **names = g_malloc0((g_hash_table_size(self->mm_clients) + 1)
+                                     * sizeof *names);
+    guint          count = 0;
+
+    g_hash_table_iter_init(&iter, self->mm_clients);
+    while( g_hash_table_iter_next(&iter, &key, 0) )
+        names[count++] = g_strdup(key);
+
+    return names;
+}
+
+bool
+mockmce_get_cpu_keepalive_active(const mockmce_t *self, const char *client)
+{
+    GHashTableIter    iter;
+    gpointer          val;
+    mockmce_client_t *entry;
+
+    if( client ) {
+        entry = mockmce_lookup_client(self, client);
+        return entry && g_hash_table_size(entry->mmc_sessions) > 0;
+    }
+
+    g_hash_table_iter_init(&iter, self->mm_clients);
+    while( g_hash_table_iter_next(&iter, 0, &val) ) {
+        entry = val;
+        if( g_hash_table_size(entry->mmc_sessions) > 0 )
+            return true;
+    }
+    return false;
+}
+
+bool
+mockmce_get_blanking_pause_active(const mockmce_t *self, const char *client)
+{
+    GHashTableIter    iter;
+    gpointer          val;
+    mockmce_client_t *entry;
+
+    if( client ) {
+        entry = mockmce_lookup_client(self, client);
+        return entry && entry->mmc_blanking_pause_id;
+    }
+
+    g_hash_table_iter_init(&iter, self->mm_clients);
+    while( g_hash_table_iter_next(&iter, 0, &val) ) {
+        entry = val;
+        if( entry->mmc_blanking_pause_id )
+            return true;
+    }
+    return false;
+}
+
+guint
+mockmce_get_cpu_keepalive_gaps(const mockmce_t *self, const char *client,
+                               gint64 *total_ms)
+{
+    GHashTableIter    iter;
+    gpointer          val;
+    mockmce_client_t *entry;
+    gint64            now  = mockmce_now_ms(self);
+    guint             gaps = 0;
+
+    if( total_ms )
+        *total_ms = 0;
+
+    if( client ) {
+        if( (entry = mockmce_lookup_client(self, client)) )
+            gaps = mockmce_client_gaps(entry, now, total_ms);
+        return gaps;
+    }
+
+    g_hash_table_iter_init(&iter, self->mm_clients);
+    while( g_hash_table_iter_next(&iter, 0, &val) )
+        gaps += mockmce_client_gaps(val, now, total_ms);
+    return gaps;
+}
+
+gint64
+mockmce_get_cpu_keepalive_time(const mockmce_t *self, const char *client)
+{
+    GHashTableIter    iter;
+    gpointer          val;
+    mockmce_client_t *entry;
+    gint64            now   = mockmce_now_ms(self);
+    gint64            total = 0;
+
+    if( client ) {
+        if( (entry = mockmce_lookup_client(self, client)) )
+            total = mockmce_client_cpu_time(entry, now);
+        return total;
+    }
+
+    g_hash_table_iter_init(&iter, self->mm_clients);
+    while( g_hash_table_iter_next(&iter, 0, &val) )
+        total += mockmce_client_cpu_time(val, now);
+    return total;
+}
+
+guint
+mockmce_get_event_count(const mockmce_t *self, const char *client)
+{
+    mockmce_client_t *entry = mockmce_lookup_client(self, client);
+    return entry ? entry->mmc_event_count : 0;
+}
+
+const mockmce_event_t *
+mockmce_get_event(const mockmce_t *self, const char *client, guint index)
+{
+    mockmce_client_t *entry = mockmce_lookup_client(self, client);
+
+    if( !entry || index >= entry->mmc_event_count )
+        return 0;
+    return &entry->mmc_events[index];
+}
+
+void
+mockmce_clear_timelines(mockmce_t *self)
+{
+    GHashTableIter iter;
+    gpointer       val;
+
+    g_hash_table_iter_init(&iter, self->mm_clients);
+    while( g_hash_table_iter_next(&iter, 0, &val) )
+        mockmce_client_clear_events(val);
+
+    g_hash_table_remove_all(self->mm_calls);
+    self->mm_call_total = 0;
+}
+
+void
+mockmce_write_timelines(const mockmce_t *self, FILE *out)
+{
+    GHashTableIter iter;
+    gpointer       val;
+
+    g_hash_table_iter_init(&iter, self->mm_clients);
+    while( g_hash_table_iter_next(&iter, 0, &val) )
+        mockmce_client_write(val, out);
+}
+
+const char *
+mockmce_event_type_repr(mockmce_event_type_t type)
+{
+    const char *repr = "unknown";
+
+    switch( type ) {
+    case MOCKMCE_EVENT_CPU_KEEPALIVE_START:   repr = "cpu_start";      break;
+    case MOCKMCE_EVENT_CPU_KEEPALIVE_RENEW:   repr = "cpu_renew";      break;
+    case MOCKMCE_EVENT_CPU_KEEPALIVE_STOP:    repr = "cpu_stop";       break;
+    case MOCKMCE_EVENT_CPU_KEEPALIVE_EXPIRE:  repr = "cpu_expire";     break;
+    case MOCKMCE_EVENT_BLANKING_PAUSE_START:  repr = "pause_start";    break;
+    case MOCKMCE_EVENT_BLANKING_PAUSE_RENEW:  repr = "pause_renew";    break;
+    case MOCKMCE_EVENT_BLANKING_PAUSE_CANCEL: repr = "pause_cancel";   break;
+    case MOCKMCE_EVENT_BLANKING_PAUSE_EXPIRE: repr = "pause_expire";   break;
+    case MOCKMCE_EVENT_BLANKING_PAUSE_DENIED: repr = "pause_denied";   break;
+    case MOCKMCE_EVENT_SESSION_LOST:          repr = "session_lost";   break;
+    case MOCKMCE_EVENT_CLIENT_EXIT:           repr = "client_exit";    break;
+    default: break;
+    }
+
+    return repr;
+}
@@ -0,0 +1,308 @@
+/****************************************************************************************
+**
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of nemo-keepalive package.
+**
+** You may use this file under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file license.lgpl included in the packaging
+** of this file.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+****************************************************************************************/
+
+/** @file mockmce.h
+ *
+ * @brief Mock com.nokia.mce D-Bus service for tests and benchmarks.
+ *
+ * Implements the MCE methods and signals used by keepalive
+ * libraries, enforces cpu keepalive and blanking pause timeouts
+ * and records per-client timelines of session events.
+ */
+
+#ifndef KEEPALIVE_TESTS_MOCKMCE_H_
+# define KEEPALIVE_TESTS_MOCKMCE_H_
+
+# include <stdio.h>
+# include <stdbool.h>
+
+# include <glib.h>
+# include <dbus/dbus.h>
+
+# ifdef __cplusplus
+extern "C" {
+# elif 0
+} /* fool JED indentation ... */
+# endif
+
+/** Opaque mock MCE object
+ *
+ * Allocate via mockmce_new() and release via mockmce_delete().
+ */
+typedef struct mockmce_t mockmce_t;
+
+/** Session event types recorded in client timelines
+ */
+typedef enum
+{
+    /** CPU keepalive session started */
+    MOCKMCE_EVENT_CPU_KEEPALIVE_START,
+
+    /** CPU keepalive session renewed before timeout */
+    MOCKMCE_EVENT_CPU_KEEPALIVE_RENEW,
+
+    /** CPU keepalive session stopped by client */
+    MOCKMCE_EVENT_CPU_KEEPALIVE_STOP,
+
+    /** CPU keepalive session timed out - a keepalive gap */
+    MOCKMCE_EVENT_CPU_KEEPALIVE_EXPIRE,
+
+    /** Blanking pause started */
+    MOCKMCE_EVENT_BLANKING_PAUSE_START,
+
+    /** Blanking pause renewed before timeout */
+    MOCKMCE_EVENT_BLANKING_PAUSE_RENEW,
+
+    /** Blanking pause cancelled by client */
+    MOCKMCE_EVENT_BLANKING_PAUSE_CANCEL,
+
+    /** Blanking pause timed out */
+    MOCKMCE_EVENT_BLANKING_PAUSE_EXPIRE,
+
+    /** Blanking pause requested while not allowed */
+    MOCKMCE_EVENT_BLANKING_PAUSE_DENIED,
+
+    /** Session dropped due to simulated MCE restart */
+    MOCKMCE_EVENT_SESSION_LOST,
+
+    /** Client dropped from system bus */
+    MOCKMCE_EVENT_CLIENT_EXIT,
+} mockmce_event_type_t;
+
+/** Timeline event
+ */
+typedef struct
+{
+    /** Milliseconds since mockmce_new() */
+    gint64                mme_time_ms;
+
+    /** Type of event */
+    mockmce_event_type_t  mme_type;
+
+    /** Session id given by client, or empty string */
+    const char           *mme_id;
+} mockmce_event_t;
+
+/* ------------------------------------------------------------------------- *
+ * LIFECYCLE
+ * ------------------------------------------------------------------------- */
+
+/** Create mock MCE object
+ *
+ * The connection must already be attached to glib main loop, for
+ * example via dbus_gmain_set_up_connection(). The service does not
+ * become visible on the bus before mockmce_start() is called.
+ *
+ * @param connection  system bus connection to serve on
+ *
+ * @return mock MCE object
+ */
+mockmce_t *mockmce_new(DBusConnection *connection);
+
+/** Stop service and release mock MCE object
+ *
+ * Passing NULL object is explicitly allowed and does nothing.
+ *
+ * @param self  mock MCE object, or NULL
+ */
+void mockmce_delete(mockmce_t *self);
+
+/** Acquire MCE service name and start handling method calls
+ *
+ * @param self  mock MCE object
+ *
+ * @return true on success, false if the name could not be acquired
+ */
+bool mockmce_start(mockmce_t *self);
+
+/** Drop all sessions and release MCE service name
+ *
+ * @param self  mock MCE object
+ */
+void mockmce_stop(mockmce_t *self);
+
+/** Simulate MCE restart
+ *
+ * Active sessions are dropped and the service name is released
+ * immediately, the name is acquired again after the given delay.
+ *
+ * @param self      mock MCE object
+ * @param delay_ms  time to stay off the bus
+ */
+void mockmce_restart(mockmce_t *self, guint delay_ms);
+
+/** Check whether MCE service name is currently owned
+ *
+ * @param self  mock MCE object
+ */
+bool mockmce_is_running(const mockmce_t *self);
+
+/* ------------------------------------------------------------------------- *
+ * SETTINGS
+ * ------------------------------------------------------------------------- */
+
+/** Set cpu keepalive period reported to clients
+ *
+ * @param self     mock MCE object
+ * @param seconds  period in seconds, default is 60
+ */
+void mockmce_set_cpu_keepalive_period(mockmce_t *self, int seconds);
+
+/** Set slack allowed for cpu keepalive renew requests
+ *
+ * Sessions that are not renewed within period + grace time expire.
+ *
+ * @param self      mock MCE object
+ * @param grace_ms  slack in milliseconds, default is 5000
+ */
+void mockmce_set_cpu_keepalive_grace(mockmce_t *self, guint grace_ms);
+
+/** Set blanking pause allowed state
+ *
+ * Changes are broadcast via display_blanking_pause_allowed_ind
+ * signal. Active blanking pauses are cancelled when the state
+ * changes to not allowed.
+ *
+ * @param self     mock MCE object
+ * @param allowed  true if blanking pause is allowed
+ */
+void mockmce_set_blanking_pause_allowed(mockmce_t *self, bool allowed);
+
+/** Set display status
+ *
+ * Changes are broadcast via display_status_ind signal.
+ *
+ * @param self    mock MCE object
+ * @param status  "on", "dimmed" or "off"
+ */
+void mockmce_set_display_status(mockmce_t *self, const char *status);
+
+/* ------------------------------------------------------------------------- *
+ * INSPECTION
+ * ------------------------------------------------------------------------- */
+
+/** Get number of times a method has been called
+ *
+ * @param self    mock MCE object
+ * @param member  method name, or NULL to get the total
+ */
+guint mockmce_get_call_count(const mockmce_t *self, const char *member);
+
+/** Get unique bus names of clients that have sent requests
+ *
+ * @param self  mock MCE object
+ *
+ * @return NULL terminated array, release with g_strfreev()
+ */
+gchar **mockmce_get_clients(const mockmce_t *self);
+
+/** Check whether client has active cpu keepalive sessions
+ *
+ * @param self    mock MCE object
+ * @param client  unique bus name of client, or NULL for any client
+ */
+bool mockmce_get_cpu_keepalive_active(const mockmce_t *self, const char *client);
+
+/** Check whether client has active blanking pause
+ *
+ * @param self    mock MCE object
+ * @param client  unique bus name of client, or NULL for any client
+ */
+bool mockmce_get_blanking_pause_active(const mockmce_t *self, const char *client);
+
+/** Get number of cpu keepalive gaps
+ *
+ * A gap starts when a session expires due to missing renew request
+ * and ends when the client starts or stops the same session.
+ *
+ * @param self      mock MCE object
+ * @param client    unique bus name of client, or NULL for all clients
+ * @param total_ms  where to store total length of gaps, or NULL
+ *
+ * @return number of gaps
+ */
+guint mockmce_get_cpu_keepalive_gaps(const mockmce_t *self, const char *client,
+                                     gint64 *total_ms);
+
+/** Get total time client has had cpu keepalive sessions active
+ *
+ * Overlapping sessions of one client are counted only once, with
+ * NULL client the per-client times are summed.
+ *
+ * @param self    mock MCE object
+ * @param client  unique bus name of client, or NULL for all clients
+ *
+ * @return time in milliseconds
+ */
+gint64 mockmce_get_cpu_keepalive_time(const mockmce_t *self, const char *client);
+
+/** Get number of events in client timeline
+ *
+ * @param self    mock MCE object
+ * @param client  unique bus name of client
+ */
+guint mockmce_get_event_count(const mockmce_t *self, const char *client);
+
+/** Get event from client timeline
+ *
+ * The returned data is valid until the next event is recorded
+ * or the timeline is cleared.
+ *
+ * @param self    mock MCE object
+ * @param client  unique bus name of client
+ * @param index   event index, 0 is the oldest
+ *
+ * @return event, or NULL if index is out of range
+ */
+const mockmce_event_t *mockmce_get_event(const mockmce_t *self, const char *client,
+                                         guint index);
+
+/** Forget recorded timelines and call counts
+ *
+ * Active sessions are not affected.
+ *
+ * @param self  mock MCE object
+ */
+void mockmce_clear_timelines(mockmce_t *self);
+
+/** Write client timelines as JSON lines
+ *
+ * @param self  mock MCE object
+ * @param out   output stream
+ */
+void mockmce_write_timelines(const mockmce_t *self, FILE *out);
+
+/** Get human readable name of event type
+ *
+ * @param type  event type
+ */
+const char *mockmce_event_type_repr(mockmce_event_type_t type);
+
+# ifdef __cplusplus
+};
+# endif
+
+#endif /* KEEPALIVE_TESTS_MOCKMCE_H_ */
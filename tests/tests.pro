@@ -2,7 +2,7 @@ PACKAGENAME = keepalive
 INSTALLLOCATION = /opt/tests/nemo-keepalive
 
 TEMPLATE = subdirs
-SUBDIRS = tst_backgroundactivity
+SUBDIRS = tst_backgroundactivity tst_keepalive_glib tst_awaitables
 
 tests_xml.target = tests.xml
 tests_xml.depends = $$PWD/tests.xml.in
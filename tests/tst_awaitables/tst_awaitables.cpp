@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the LGPLv2.1
+ *
+ */
+
+#include <QObject>
+#include <QtTest>
+
+#include "keepaliveawaitables.h"
+
+#include "iphb-stub.h"
+
+#include <exception>
+
+/* Tests for C++20 coroutine support
+ *
+ * Wakeups are delivered only when told to via libiphb stub.
+ */
+class tst_Awaitables : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void wakeupResumesOnce();
+};
+
+#ifdef __cpp_impl_coroutine
+
+/* Fire and forget coroutine */
+struct Task
+{
+    struct promise_type
+    {
+        Task get_return_object() { return Task(); }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+static Task awaitWakeup(BackgroundActivity &activity, int &resumes, bool &running)
+{
+    auto awake = co_await Keepalive::nextWakeup(activity, BackgroundActivity::ThirtySeconds);
+    ++resumes;
+    running = activity.isRunning();
+}
+
+#endif
+
+void tst_Awaitables::initTestCase()
+{
+#ifndef __cpp_impl_coroutine
+    QSKIP("compiler does not support coroutines");
+#endif
+    iphb_stub_set_immediate(false);
+}
+
+void tst_Awaitables::wakeupResumesOnce()
+{
+#ifdef __cpp_impl_coroutine
+    int  resumes = 0;
+    bool running = false;
+    BackgroundActivity activity;
+
+    awaitWakeup(activity, resumes, running);
+    QVERIFY(activity.isWaiting());
+
+    // Two running periods before event loop gets to resume
+    activity.run();
+    activity.stop();
+    activity.run();
+    QCOMPARE(resumes, 0);
+
+    QTRY_COMPARE(resumes, 1);
+    QVERIFY(running);
+
+    // Guard going out of scope at the end of coroutine stops activity
+    QVERIFY(activity.isStopped());
+
+    QTest::qWait(100);
+    QCOMPARE(resumes, 1);
+#endif
+}
+
+#include "tst_awaitables.moc"
+QTEST_MAIN(tst_Awaitables)
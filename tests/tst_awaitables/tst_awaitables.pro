@@ -0,0 +1,16 @@
+include(../common.pri)
+TARGET = tst_awaitables
+
+# Coroutine support in keepaliveawaitables.h needs C++20
+CONFIG += c++2a
+
+CONFIG += link_pkgconfig
+PKGCONFIG += libiphb
+
+# Export iphb_xxx() stubs so that they override libiphb
+INCLUDEPATH += $$PWD/../iphbstub
+QMAKE_LFLAGS += -rdynamic
+
+SOURCES += tst_awaitables.cpp
+SOURCES += ../iphbstub/iphb-stub.c
+HEADERS += ../iphbstub/iphb-stub.h
@@ -0,0 +1,743 @@
+/*
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the LGPLv2.1
+ *
+ */
+
+#include <QObject>
+#include <QtTest>
+#include <QAbstractEventDispatcher>
+#include <QDBusConnection>
+#include <QProcess>
+#include <QThread>
+
+#include "cpukeepalive.h"
+#include "displayblanking.h"
+#include "keepalivetimer.h"
+#include "backgroundworkqueue.h"
+
+#include <keepalive-backgroundactivity.h>
+#include <keepalive-cpukeepalive.h>
+#include <keepalive-displaykeepalive.h>
+#include <keepalive-executor.h>
+#include <keepalive-timeout.h>
+#include <keepalive-workqueue.h>
+
+#include "../../dbus-gmain/dbus-gmain.h"
+
+#include "mockmce.h"
+#include "iphb-stub.h"
+
+#include <mce/dbus-names.h>
+
+#include <time.h>
+
+/* Tests for libkeepalive-glib features that need MCE and IPHB
+ *
+ * Runs a private dbus-daemon that is used as system bus, serves
+ * com.nokia.mce from the test process via mock MCE and replaces
+ * libiphb with in-process stub that delivers wakeups only when
+ * told to.
+ */
+class tst_KeepaliveGlib : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void init();
+
+    void hybridTimeoutReleasesKeepalive();
+    void hybridTimeoutIsOptIn();
+    void hybridTimeoutDoesNotChain();
+    void cpuKeepaliveUsesSharedSession();
+    void executorCompletesInOwnerThread();
+    void executorDeadlines();
+    void deadlineRescheduling();
+    void overrunCallbackCanRestart();
+    void timerDueAfterDispatchIsNotStalled();
+    void workQueueDoesNotRunJobsFromEnqueue();
+    void sharedWorkQueueIsSharedWithGlib();
+    void displayKeepaliveFollowsPauseAllowed();
+    void displayKeepaliveSurvivesMceRestart();
+    void displayBlankingSharesPause();
+    void displayBlankingTracksDisplayStatus();
+    void displayBlankingSubscribesLazily();
+    void displayBlankingResyncsAfterMceRestart();
+
+private:
+    guint countEvents(mockmce_event_type_t type,
+                      const QByteArray &client = QByteArray()) const;
+    QByteArray qtClient() const;
+    iphb_stub_stats_t iphbStats() const;
+
+    QProcess       *m_bus = 0;
+    DBusConnection *m_client_bus = 0;
+    DBusConnection *m_mce_bus = 0;
+    mockmce_t      *m_mce = 0;
+    QByteArray      m_client;
+};
+
+/* ========================================================================= *
+ * Helpers
+ * ========================================================================= */
+
+static gboolean countAndRepeat(gpointer aptr)
+{
+    int *count = static_cast<int *>(aptr);
+    ++*count;
+    return TRUE;
+}
+
+static time_t boottime()
+{
+    struct timespec ts = { 0, 0 };
+    clock_gettime(CLOCK_BOOTTIME, &ts);
+    return ts.tv_sec;
+}
+
+guint tst_KeepaliveGlib::countEvents(mockmce_event_type_t type,
+                                     const QByteArray &client) const
+{
+    const char *name = client.isEmpty() ? m_client.constData() : client.constData();
+    guint count = 0;
+    guint total = mockmce_get_event_count(m_mce, name);
+    for (guint i = 0; i < total; ++i) {
+        const mockmce_event_t *event = mockmce_get_event(m_mce, name, i);
+        if (event && event->mme_type == type)
+            ++count;
+    }
+    return count;
+}
+
+/* Qt classes talk to MCE via QtDBus connection of their own */
+QByteArray tst_KeepaliveGlib::qtClient() const
+{
+    return QDBusConnection::systemBus().baseService().toUtf8();
+}
+
+iphb_stub_stats_t tst_KeepaliveGlib::iphbStats() const
+{
+    iphb_stub_stats_t stats;
+    iphb_stub_get_stats(&stats);
+    return stats;
+}
+
+/* ========================================================================= *
+ * Setup
+ * ========================================================================= */
+
+void tst_KeepaliveGlib::initTestCase()
+{
+    // libkeepalive-glib timers and io watches need glib main loop
+    QAbstractEventDispatcher *dispatcher = QAbstractEventDispatcher::instance();
+    if (!dispatcher || !dispatcher->inherits("QEventDispatcherGlib"))
+        QSKIP("event dispatcher is not glib based");
+
+    // Private bus that is used as system bus
+    m_bus = new QProcess(this);
+    m_bus->start("dbus-daemon", QStringList() << "--session" << "--nofork" << "--print-address");
+    QVERIFY(m_bus->waitForStarted());
+    QVERIFY(m_bus->waitForReadyRead(5000));
+    QByteArray address = m_bus->readLine().trimmed();
+    QVERIFY(!address.isEmpty());
+    qputenv("DBUS_SYSTEM_BUS_ADDRESS", address);
+
+    // Connection used by the library code under test
+    DBusError err = DBUS_ERROR_INIT;
+    m_client_bus = dbus_bus_get(DBUS_BUS_SYSTEM, &err);
+    QVERIFY2(m_client_bus, err.message);
+    dbus_gmain_set_up_connection(m_client_bus, 0);
+    m_client = dbus_bus_get_unique_name(m_client_bus);
+
+    // Separate connection for mock MCE, so that it sees the
+    // library as a client of its own
+    m_mce_bus = dbus_bus_get_private(DBUS_BUS_SYSTEM, &err);
+    QVERIFY2(m_mce_bus, err.message);
+    dbus_gmain_set_up_connection(m_mce_bus, 0);
+    m_mce = mockmce_new(m_mce_bus);
+    QVERIFY(mockmce_start(m_mce));
+
+    // Wakeups are delivered only via iphb_stub_wakeup_all()
+    iphb_stub_set_immediate(false);
+}
+
+void tst_KeepaliveGlib::cleanupTestCase()
+{
+    mockmce_delete(m_mce), m_mce = 0;
+
+    if (m_mce_bus) {
+        dbus_connection_close(m_mce_bus);
+        dbus_connection_unref(m_mce_bus), m_mce_bus = 0;
+    }
+
+    if (m_client_bus)
+        dbus_connection_unref(m_client_bus), m_client_bus = 0;
+
+    if (m_bus) {
+        m_bus->terminate();
+        m_bus->waitForFinished();
+    }
+}
+
+void tst_KeepaliveGlib::init()
+{
+    // Let leftovers from previous test settle down first
+    QTRY_VERIFY(mockmce_is_running(m_mce));
+    QTRY_COMPARE(cpukeepalive_shared_holders(), 0u);
+    QTRY_VERIFY(!mockmce_get_cpu_keepalive_active(m_mce, 0));
+    QTRY_VERIFY(!mockmce_get_blanking_pause_active(m_mce, 0));
+
+    mockmce_clear_timelines(m_mce);
+    iphb_stub_reset_stats();
+}
+
+/* ========================================================================= *
+ * Hybrid mode keepalive timeouts
+ * ========================================================================= */
+
+void tst_KeepaliveGlib::hybridTimeoutReleasesKeepalive()
+{
+    int count = 0;
+    guint id = keepalive_timeout_add_hybrid(G_PRIORITY_DEFAULT, 1000,
+                                            countAndRepeat, &count, 0);
+    QVERIFY(id);
+
+    // Suspend is blocked via shared keepalive during the first interval
+    QCOMPARE(cpukeepalive_shared_holders(), 1u);
+    QTRY_VERIFY(mockmce_get_cpu_keepalive_active(m_mce, m_client.constData()));
+    QCOMPARE(iphbStats().iss_waits, 0u);
+
+    // After the first dispatch keepalive is released ...
+    QTRY_COMPARE(count, 1);
+    QCOMPARE(cpukeepalive_shared_holders(), 0u);
+    QTRY_VERIFY(!mockmce_get_cpu_keepalive_active(m_mce, m_client.constData()));
+    QCOMPARE(countEvents(MOCKMCE_EVENT_CPU_KEEPALIVE_STOP), 1u);
+    QCOMPARE(mockmce_get_cpu_keepalive_gaps(m_mce, m_client.constData(), 0), 0u);
+
+    // ... and repeats wait for IPHB wakeup close to requested interval
+    QTRY_VERIFY(iphbStats().iss_waits >= 1u);
+    QCOMPARE(iphbStats().iss_last_mintime, 1u);
+    QCOMPARE(iphbStats().iss_last_maxtime, 2u);
+    QTest::qWait(1500);
+    QCOMPARE(count, 1);
+    QCOMPARE(cpukeepalive_shared_holders(), 0u);
+
+    iphb_stub_wakeup_all();
+    QTRY_COMPARE(count, 2);
+    QCOMPARE(cpukeepalive_shared_holders(), 0u);
+
+    g_source_remove(id);
+}
+
+void tst_KeepaliveGlib::hybridTimeoutIsOptIn()
+{
+    int count = 0;
+    guint id = keepalive_timeout_add(500, countAndRepeat, &count);
+    QVERIFY(id);
+
+    // Plain keepalive timeouts do not block suspend while waiting
+    QCOMPARE(cpukeepalive_shared_holders(), 0u);
+    QTRY_VERIFY(iphbStats().iss_waits >= 1u);
+
+    QTest::qWait(1000);
+    QCOMPARE(count, 0);
+
+    iphb_stub_wakeup_all();
+    QTRY_COMPARE(count, 1);
+
+    g_source_remove(id);
+}
+
+struct ChainData
+{
+    guint    chained_id = 0;
+    unsigned holders_in_callback = 0;
+    int      chained_count = 0;
+};
+
+static gboolean addChainedHybrid(gpointer aptr)
+{
+    ChainData *data = static_cast<ChainData *>(aptr);
+    data->holders_in_callback = cpukeepalive_shared_holders();
+    data->chained_id = keepalive_timeout_add_hybrid(G_PRIORITY_DEFAULT, 30 * 1000,
+                                                    countAndRepeat,
+                                                    &data->chained_count, 0);
+    return FALSE;
+}
+
+void tst_KeepaliveGlib::hybridTimeoutDoesNotChain()
+{
+    ChainData data;
+    QVERIFY(keepalive_timeout_add_hybrid(G_PRIORITY_DEFAULT, 100,
+                                         addChainedHybrid, &data, 0));
+
+    // Own hold of the dispatching timeout does not make the
+    // chained 30 second timeout use hybrid mode
+    QTRY_VERIFY(data.chained_id);
+    QCOMPARE(data.holders_in_callback, 1u);
+    QCOMPARE(cpukeepalive_shared_holders(), 0u);
+    g_source_remove(data.chained_id);
+
+    // But a hold by someone else does
+    cpukeepalive_shared_acquire();
+    guint id = keepalive_timeout_add_hybrid(G_PRIORITY_DEFAULT, 30 * 1000,
+                                            countAndRepeat, &data.chained_count, 0);
+    QVERIFY(id);
+    QCOMPARE(cpukeepalive_shared_holders(), 2u);
+    g_source_remove(id);
+    QCOMPARE(cpukeepalive_shared_holders(), 1u);
+    cpukeepalive_shared_release();
+}
+
+/* ========================================================================= *
+ * Qt CpuKeepalive
+ * ========================================================================= */
+
+void tst_KeepaliveGlib::cpuKeepaliveUsesSharedSession()
+{
+    CpuKeepalive::acquire();
+    QCOMPARE(CpuKeepalive::holders(), 1);
+    QCOMPARE(cpukeepalive_shared_holders(), 1u);
+
+    // Glib side holders use the same session
+    cpukeepalive_shared_acquire();
+    QTRY_VERIFY(mockmce_get_cpu_keepalive_active(m_mce, m_client.constData()));
+
+    CpuKeepalive::release();
+    cpukeepalive_shared_release();
+    QCOMPARE(CpuKeepalive::holders(), 0);
+    QTRY_VERIFY(!mockmce_get_cpu_keepalive_active(m_mce, m_client.constData()));
+
+    QCOMPARE(countEvents(MOCKMCE_EVENT_CPU_KEEPALIVE_START), 1u);
+    QCOMPARE(mockmce_get_cpu_keepalive_gaps(m_mce, m_client.constData(), 0), 0u);
+}
+
+/* ========================================================================= *
+ * Keepalive executor
+ * ========================================================================= */
+
+struct JobData
+{
+    unsigned  sleep_ms = 0;
+    QAtomicInt executed;
+    QThread  *done_thread = 0;
+    int       status = -1;
+    bool      done = false;
+};
+
+static void executeJob(gpointer aptr)
+{
+    JobData *data = static_cast<JobData *>(aptr);
+    QThread::msleep(data->sleep_ms);
+    data->executed.storeRelease(1);
+}
+
+static void jobDone(gpointer aptr, keepalive_executor_status_t status)
+{
+    JobData *data = static_cast<JobData *>(aptr);
+    data->done_thread = QThread::currentThread();
+    data->status = status;
+    data->done = true;
+}
+
+void tst_KeepaliveGlib::executorCompletesInOwnerThread()
+{
+    keepalive_executor_t *executor = keepalive_executor_new(1);
+    QVERIFY(executor);
+
+    JobData job;
+    job.sleep_ms = 100;
+    QVERIFY(keepalive_executor_push(executor, executeJob, jobDone, &job));
+
+    // Job finishes while owner thread is not iterating main loop,
+    // completion must still be made in the owner thread
+    QThread::msleep(500);
+    QCOMPARE(job.executed.loadAcquire(), 1);
+    QCOMPARE(job.done, false);
+
+    QTRY_VERIFY(job.done);
+    QCOMPARE(job.done_thread, QThread::currentThread());
+    QCOMPARE(job.status, int(KEEPALIVE_EXECUTOR_JOB_COMPLETED));
+    QCOMPARE(keepalive_executor_get_pending(executor), 0u);
+
+    keepalive_executor_free(executor);
+}
+
+void tst_KeepaliveGlib::executorDeadlines()
+{
+    keepalive_executor_t *executor = keepalive_executor_new(1);
+    QVERIFY(executor);
+
+    // Single worker: second job can't start before the first finishes
+    JobData slow;
+    slow.sleep_ms = 500;
+    JobData queued;
+    QVERIFY(keepalive_executor_push_full(executor, executeJob, jobDone, &slow, 100));
+    QVERIFY(keepalive_executor_push_full(executor, executeJob, jobDone, &queued, 100));
+
+    QTRY_VERIFY(slow.done && queued.done);
+    QCOMPARE(slow.status, int(KEEPALIVE_EXECUTOR_JOB_OVERRUN));
+    QCOMPARE(slow.executed.loadAcquire(), 1);
+    QCOMPARE(queued.status, int(KEEPALIVE_EXECUTOR_JOB_EXPIRED));
+    QCOMPARE(queued.executed.loadAcquire(), 0);
+
+    keepalive_executor_free(executor);
+}
+
+/* ========================================================================= *
+ * Absolute wakeup deadlines
+ * ========================================================================= */
+
+static void setRunning(background_activity_t *activity, void *aptr)
+{
+    Q_UNUSED(activity);
+    *static_cast<bool *>(aptr) = true;
+}
+
+void tst_KeepaliveGlib::deadlineRescheduling()
+{
+    bool ran = false;
+    background_activity_t *activity = background_activity_new();
+    background_activity_set_user_data(activity, &ran, 0);
+    background_activity_set_running_callback(activity, setRunning);
+
+    keepalive_accounting_t acc;
+
+    // Stopping already stopped activity does not cause IPC
+    background_activity_stop(activity);
+    QVERIFY(background_activity_get_accounting(activity, &acc));
+    QCOMPARE(acc.kac_ipc_messages, 0u);
+
+    // Deadline is converted to relative range when wait is programmed
+    time_t now = boottime();
+    background_activity_wait_until(activity, BACKGROUND_ACTIVITY_CLOCK_BOOTTIME,
+                                   now + 100, now + 130);
+    QTRY_VERIFY(iphbStats().iss_last_maxtime);
+    QVERIFY(iphbStats().iss_last_mintime <= 100u);
+    QVERIFY(iphbStats().iss_last_mintime >= 99u);
+    QVERIFY(iphbStats().iss_last_maxtime <= 130u);
+    QVERIFY(iphbStats().iss_last_maxtime >= 129u);
+
+    // Repeating the same deadline while waiting is not reprogrammed
+    unsigned waits = iphbStats().iss_waits;
+    QVERIFY(background_activity_get_accounting(activity, &acc));
+    unsigned messages = acc.kac_ipc_messages;
+    QVERIFY(messages >= 1u);
+    background_activity_wait_until(activity, BACKGROUND_ACTIVITY_CLOCK_BOOTTIME,
+                                   now + 100, now + 130);
+    QTest::qWait(100);
+    QCOMPARE(iphbStats().iss_waits, waits);
+    QVERIFY(background_activity_get_accounting(activity, &acc));
+    QCOMPARE(acc.kac_ipc_messages, messages);
+
+    // Waiting again later re-evaluates range from the deadline
+    // instead of reusing the original relative range
+    QTest::qWait(2100);
+    background_activity_stop(activity);
+    background_activity_wait(activity);
+    QTRY_VERIFY(iphbStats().iss_last_mintime <= 98u);
+    QVERIFY(iphbStats().iss_last_mintime >= 97u);
+    QVERIFY(background_activity_is_waiting(activity));
+
+    // Wall clock deadlines are converted too
+    time_t wall = time(0);
+    background_activity_wait_until(activity, BACKGROUND_ACTIVITY_CLOCK_REALTIME,
+                                   wall + 200, wall + 260);
+    QTRY_VERIFY(iphbStats().iss_last_maxtime > 250u);
+    QVERIFY(iphbStats().iss_last_mintime <= 200u);
+    QVERIFY(iphbStats().iss_last_mintime >= 199u);
+
+    // Deadlines in the past lead to wakeup as soon as possible
+    now = boottime();
+    background_activity_wait_until(activity, BACKGROUND_ACTIVITY_CLOCK_BOOTTIME,
+                                   now - 10, now - 5);
+    QTRY_VERIFY(iphbStats().iss_last_mintime <= 1u);
+
+    iphb_stub_wakeup_all();
+    QTRY_VERIFY(ran);
+    QVERIFY(background_activity_is_running(activity));
+
+    background_activity_stop(activity);
+    background_activity_set_running_callback(activity, 0);
+    background_activity_unref(activity);
+}
+
+/* ========================================================================= *
+ * Running state budget
+ * ========================================================================= */
+
+static void restartOnce(background_activity_t *activity, void *aptr)
+{
+    int *overruns = static_cast<int *>(aptr);
+    if (++*overruns == 1) {
+        background_activity_stop(activity);
+        background_activity_run(activity);
+    }
+}
+
+void tst_KeepaliveGlib::overrunCallbackCanRestart()
+{
+    int overruns = 0;
+    background_activity_t *activity = background_activity_new();
+    background_activity_set_user_data(activity, &overruns, 0);
+    background_activity_set_overrun_callback(activity, restartOnce);
+    background_activity_set_run_budget(activity, 1, BACKGROUND_ACTIVITY_OVERRUN_STOP);
+
+    background_activity_run(activity);
+    QVERIFY(background_activity_is_running(activity));
+
+    // Running period started from the overrun callback is not
+    // terminated on behalf of the previous one ...
+    QTRY_COMPARE(overruns, 1);
+    QVERIFY(background_activity_is_running(activity));
+
+    // ... but it gets a budget of its own
+    QTRY_COMPARE(overruns, 2);
+    QVERIFY(background_activity_is_stopped(activity));
+    QCOMPARE(background_activity_get_overrun_count(activity), 2u);
+
+    background_activity_set_overrun_callback(activity, 0);
+    background_activity_unref(activity);
+}
+
+/* ========================================================================= *
+ * Qt KeepaliveTimer
+ * ========================================================================= */
+
+void tst_KeepaliveGlib::timerDueAfterDispatchIsNotStalled()
+{
+    int count = 0;
+    KeepaliveTimer timer;
+    timer.setInterval(0);
+    timer.setSlack(0);
+
+    // Timer is already due again when dispatching ends, while the
+    // scheduler activity is still in running state
+    QObject::connect(&timer, &KeepaliveTimer::timeout, [&]() {
+        if (++count == 3)
+            timer.stop();
+    });
+    timer.start();
+
+    QTRY_COMPARE(count, 3);
+    QVERIFY(!timer.isActive());
+
+    // Keepalive is released once there is nothing left to dispatch
+    QTRY_VERIFY(!mockmce_get_cpu_keepalive_active(m_mce, m_client.constData()));
+    QCOMPARE(iphbStats().iss_waits, 0u);
+}
+
+/* ========================================================================= *
+ * Qt BackgroundWorkQueue
+ * ========================================================================= */
+
+static void countWork(background_work_t *work, void *data)
+{
+    ++*static_cast<int *>(data);
+    background_work_done(work);
+}
+
+void tst_KeepaliveGlib::workQueueDoesNotRunJobsFromEnqueue()
+{
+    int count = 0;
+    BackgroundWorkQueue queue(BackgroundActivity::Range);
+    QSignalSpy drained(&queue, SIGNAL(drained()));
+
+    queue.enqueue([&]() { ++count; });
+    QCOMPARE(count, 0);
+    QCOMPARE(queue.pending(), 1);
+
+    QTRY_COMPARE(count, 1);
+    QTRY_COMPARE(drained.count(), 1);
+    QCOMPARE(queue.pending(), 0);
+}
+
+void tst_KeepaliveGlib::sharedWorkQueueIsSharedWithGlib()
+{
+    int qt_count = 0;
+    int glib_count = 0;
+    BackgroundWorkQueue *queue = BackgroundWorkQueue::shared(BackgroundActivity::Range);
+    QSignalSpy drained(queue, SIGNAL(drained()));
+
+    // Parallelism is a property of the shared glib queue
+    queue->setParallelism(2);
+    background_work_queue_t *backend =
+        background_work_queue_shared(BACKGROUND_ACTIVITY_FREQUENCY_RANGE);
+    QCOMPARE(background_work_queue_get_parallelism(backend), 2u);
+    queue->setParallelism(1);
+
+    queue->enqueue([&]() { ++qt_count; });
+    background_work_queue_enqueue(backend, countWork, &glib_count, 0);
+    QCOMPARE(qt_count, 0);
+    QCOMPARE(queue->pending(), 1);
+    QCOMPARE(background_work_queue_get_pending(backend), 2u);
+
+    QTRY_COMPARE(qt_count, 1);
+    QTRY_COMPARE(glib_count, 1);
+    QTRY_COMPARE(drained.count(), 1);
+    QCOMPARE(queue->pending(), 0);
+    QTRY_COMPARE(background_work_queue_get_pending(backend), 0u);
+}
+
+/* ========================================================================= *
+ * Display keepalive
+ * ========================================================================= */
+
+void tst_KeepaliveGlib::displayKeepaliveFollowsPauseAllowed()
+{
+    const char *client = m_client.constData();
+    displaykeepalive_t *keepalive = displaykeepalive_new();
+
+    displaykeepalive_start(keepalive);
+    QTRY_VERIFY(mockmce_get_blanking_pause_active(m_mce, client));
+
+    // Pause is not re-requested while it is not allowed ...
+    mockmce_set_blanking_pause_allowed(m_mce, false);
+    QTRY_VERIFY(!mockmce_get_blanking_pause_active(m_mce, client));
+    QTest::qWait(500);
+    QVERIFY(!mockmce_get_blanking_pause_active(m_mce, client));
+    QCOMPARE(countEvents(MOCKMCE_EVENT_BLANKING_PAUSE_DENIED), 0u);
+
+    // ... but it is resumed when allowed again
+    mockmce_set_blanking_pause_allowed(m_mce, true);
+    QTRY_VERIFY(mockmce_get_blanking_pause_active(m_mce, client));
+    QCOMPARE(countEvents(MOCKMCE_EVENT_BLANKING_PAUSE_START), 2u);
+
+    displaykeepalive_stop(keepalive);
+    QTRY_VERIFY(!mockmce_get_blanking_pause_active(m_mce, client));
+
+    displaykeepalive_unref(keepalive);
+}
+
+void tst_KeepaliveGlib::displayKeepaliveSurvivesMceRestart()
+{
+    const char *client = m_client.constData();
+    displaykeepalive_t *keepalive = displaykeepalive_new();
+
+    displaykeepalive_start(keepalive);
+    QTRY_VERIFY(mockmce_get_blanking_pause_active(m_mce, client));
+
+    // Sessions are lost when mce goes away ...
+    mockmce_restart(m_mce, 500);
+    QVERIFY(!mockmce_get_blanking_pause_active(m_mce, client));
+
+    // ... and re-established when it comes back
+    QTRY_VERIFY(mockmce_is_running(m_mce));
+    QTRY_VERIFY(mockmce_get_blanking_pause_active(m_mce, client));
+
+    displaykeepalive_stop(keepalive);
+    QTRY_VERIFY(!mockmce_get_blanking_pause_active(m_mce, client));
+
+    displaykeepalive_unref(keepalive);
+}
+
+/* ========================================================================= *
+ * Qt DisplayBlanking
+ * ========================================================================= */
+
+void tst_KeepaliveGlib::displayBlankingSharesPause()
+{
+    QByteArray client = qtClient();
+
+    {
+        DisplayBlanking blanking;
+        QSignalSpy changed(&blanking, SIGNAL(preventBlankingChanged()));
+
+        blanking.setPreventBlanking(true);
+        QCOMPARE(changed.count(), 1);
+        QTRY_VERIFY(mockmce_get_blanking_pause_active(m_mce, client.constData()));
+
+        // All instances share one blanking pause session
+        {
+            DisplayBlanking other;
+            other.setPreventBlanking(true);
+            QTest::qWait(500);
+        }
+        QTest::qWait(500);
+        QVERIFY(mockmce_get_blanking_pause_active(m_mce, client.constData()));
+        QCOMPARE(countEvents(MOCKMCE_EVENT_BLANKING_PAUSE_START, client), 1u);
+        QCOMPARE(countEvents(MOCKMCE_EVENT_BLANKING_PAUSE_CANCEL, client), 0u);
+    }
+
+    // Session ends when the last preventing instance is gone
+    QTRY_VERIFY(!mockmce_get_blanking_pause_active(m_mce, client.constData()));
+    QCOMPARE(countEvents(MOCKMCE_EVENT_BLANKING_PAUSE_CANCEL, client), 1u);
+}
+
+void tst_KeepaliveGlib::displayBlankingTracksDisplayStatus()
+{
+    DisplayBlanking blanking;
+    QSignalSpy changed(&blanking, SIGNAL(statusChanged()));
+
+    QTRY_COMPARE(blanking.status(), DisplayBlanking::On);
+
+    mockmce_set_display_status(m_mce, "dimmed");
+    QTRY_COMPARE(blanking.status(), DisplayBlanking::Dimmed);
+
+    mockmce_set_display_status(m_mce, "off");
+    QTRY_COMPARE(blanking.status(), DisplayBlanking::Off);
+
+    mockmce_set_display_status(m_mce, "on");
+    QTRY_COMPARE(blanking.status(), DisplayBlanking::On);
+    QCOMPARE(changed.count(), 4);
+}
+
+void tst_KeepaliveGlib::displayBlankingSubscribesLazily()
+{
+    DisplayBlanking blanking;
+
+    // Nothing is queried from mce until related functionality is used
+    QTest::qWait(500);
+    QCOMPARE(mockmce_get_call_count(m_mce, MCE_DISPLAY_STATUS_GET), 0u);
+    QCOMPARE(mockmce_get_call_count(m_mce, MCE_PREVENT_BLANK_ALLOWED_GET), 0u);
+
+    // Display state: on first connect to statusChanged() ...
+    QSignalSpy changed(&blanking, SIGNAL(statusChanged()));
+    QTRY_COMPARE(mockmce_get_call_count(m_mce, MCE_DISPLAY_STATUS_GET), 1u);
+    QTRY_COMPARE(blanking.status(), DisplayBlanking::On);
+    QCOMPARE(mockmce_get_call_count(m_mce, MCE_PREVENT_BLANK_ALLOWED_GET), 0u);
+
+    // ... blanking pause policy: when blanking is prevented first time
+    blanking.setPreventBlanking(true);
+    QTRY_COMPARE(mockmce_get_call_count(m_mce, MCE_PREVENT_BLANK_ALLOWED_GET), 1u);
+    QTRY_VERIFY(mockmce_get_blanking_pause_active(m_mce, qtClient().constData()));
+
+    // Tracking is done only once
+    blanking.setPreventBlanking(false);
+    blanking.setPreventBlanking(true);
+    QTest::qWait(500);
+    QCOMPARE(mockmce_get_call_count(m_mce, MCE_DISPLAY_STATUS_GET), 1u);
+    QCOMPARE(mockmce_get_call_count(m_mce, MCE_PREVENT_BLANK_ALLOWED_GET), 1u);
+}
+
+void tst_KeepaliveGlib::displayBlankingResyncsAfterMceRestart()
+{
+    QByteArray client = qtClient();
+    DisplayBlanking blanking;
+    QSignalSpy changed(&blanking, SIGNAL(statusChanged()));
+
+    blanking.setPreventBlanking(true);
+    QTRY_COMPARE(blanking.status(), DisplayBlanking::On);
+    QTRY_VERIFY(mockmce_get_blanking_pause_active(m_mce, client.constData()));
+
+    // Display state is unknown while mce is away ...
+    mockmce_restart(m_mce, 500);
+    QVERIFY(!mockmce_get_blanking_pause_active(m_mce, client.constData()));
+    QTRY_COMPARE(blanking.status(), DisplayBlanking::Unknown);
+
+    // ... and both state and blanking pause are re-synced once it is back
+    QTRY_VERIFY(mockmce_is_running(m_mce));
+    QTRY_COMPARE(blanking.status(), DisplayBlanking::On);
+    QTRY_VERIFY(mockmce_get_blanking_pause_active(m_mce, client.constData()));
+    QCOMPARE(mockmce_get_call_count(m_mce, MCE_DISPLAY_STATUS_GET), 2u);
+    QCOMPARE(mockmce_get_call_count(m_mce, MCE_PREVENT_BLANK_ALLOWED_GET), 2u);
+
+    blanking.setPreventBlanking(false);
+    QTRY_VERIFY(!mockmce_get_blanking_pause_active(m_mce, client.constData()));
+}
+
+#include "tst_keepalive_glib.moc"
+QTEST_MAIN(tst_KeepaliveGlib)
@@ -0,0 +1,29 @@
+include(../common.pri)
+TARGET = tst_keepalive_glib
+
+# Qt display blanking is tested against mock MCE too
+QT += dbus
+
+CONFIG += link_pkgconfig
+PKGCONFIG += glib-2.0 dbus-1 libiphb mce
+
+# libkeepalive-glib API is tested directly
+INCLUDEPATH += $$PWD/../../lib-glib $$PWD/../..
+LIBS += -L$$PWD/../../lib-glib -lkeepalive-glib
+
+# Mock MCE service runs within the test process
+INCLUDEPATH += $$PWD/../mockmce
+
+# Export iphb_xxx() stubs so that they override libiphb
+INCLUDEPATH += $$PWD/../iphbstub
+QMAKE_LFLAGS += -rdynamic
+
+# libdbus main loop integration; sources from submodule are not warning clean
+QMAKE_CFLAGS += -Wno-unused-parameter -Wno-cast-function-type -Wno-missing-field-initializers
+
+SOURCES += tst_keepalive_glib.cpp
+SOURCES += ../mockmce/mockmce.c
+SOURCES += ../iphbstub/iphb-stub.c
+SOURCES += ../../dbus-gmain/dbus-gmain.c
+HEADERS += ../mockmce/mockmce.h
+HEADERS += ../iphbstub/iphb-stub.h
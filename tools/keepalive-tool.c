@@ -30,10 +30,22 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
 #include <glib.h>
+#include <glib-unix.h>
 #include <dbus/dbus.h>
 #include "../dbus-gmain/dbus-gmain.h"
 #include "keepalive-cpukeepalive.h"
+#include "keepalive-displaykeepalive.h"
+#include "keepalive-backgroundactivity.h"
+#include "keepalive-timeout.h"
 
 #define failure(FMT, ARGS...) do {\
     fprintf(stderr, "%s: "FMT"\n", __FUNCTION__, ## ARGS);\
@@ -41,8 +53,40 @@
 } while(0)
 
 
+/* Keepalive daemon protocol: client connects to the daemon socket,
+ * sends one request byte and waits for acknowledgement byte. The
+ * keepalive is then held until the client closes the connection. */
+#define KEEPALIVE_DAEMON_SOCKET   "keepalive-tool.socket"
+#define KEEPALIVE_DAEMON_REQ_CPU  'C'
+#define KEEPALIVE_DAEMON_REQ_DISP 'D'
+#define KEEPALIVE_DAEMON_ACK      'A'
+
+/* Maximum time to wait for keepalive daemon acknowledgement */
+#define KEEPALIVE_DAEMON_ACK_MS   500
+
+/* Child process tree cpu usage sampling interval for --idle-release */
+#define IDLE_SAMPLE_MS            1000
+
+/* Default for --idle-wakeup */
+#define IDLE_WAKEUP_DEFAULT       300
+
+/* Maximum time to wait for deferred keepalive session stop for --stats */
+#define STATS_FLUSH_TIMEOUT_MS    2000
+
 struct KeepaliveOptions {
     gint timeout;
+    gboolean cpu;
+    gboolean display;
+    gboolean daemon;
+    gchar *socket_path;
+    gint every;
+    gchar *range;
+    gint range_lo;
+    gint range_hi;
+    gboolean stats;
+    gboolean json;
+    gint idle_release;
+    gint idle_wakeup;
 };
 
 struct Keepalive {
@@ -51,10 +95,206 @@ struct Keepalive {
     GMainLoop *mainloop_handle;
     GPid pid;
     cpukeepalive_t *cpukeepalive;
+    displaykeepalive_t *displaykeepalive;
+    gint daemon_fd;
+    gboolean held;
+    gboolean expired;
     gint result;
     guint timeout_source_id;
+    gint64 started_ms;
+    guint idle_sample_id;
+    guint idle_wakeup_id;
+    guint64 idle_ticks;
+    gint64 idle_since_ms;
+};
+
+struct KeepaliveDaemon {
+    struct KeepaliveOptions *options;
+    DBusConnection *system_bus;
+    GMainLoop *mainloop_handle;
+    cpukeepalive_t *cpukeepalive;
+    gboolean cpukeepalive_held;
+    displaykeepalive_t *displaykeepalive;
+    gboolean displaykeepalive_held;
+    gint listen_fd;
+    guint listen_source_id;
+    guint sigint_source_id;
+    guint sigterm_source_id;
+    GSList *clients;
+};
+
+struct KeepalivePeriodic {
+    struct KeepaliveOptions *options;
+    char **argv;
+    DBusConnection *system_bus;
+    GMainLoop *mainloop_handle;
+    background_activity_t *activity;
+    cpukeepalive_t *cpukeepalive;
+    displaykeepalive_t *displaykeepalive;
+    GPid pid;
+    guint child_watch_id;
+    guint timeout_source_id;
+    guint sigint_source_id;
+    guint sigterm_source_id;
+    guint runs;
+    guint skipped;
+    gint64 started_ms;
+};
+
+struct KeepaliveDaemonClient {
+    struct KeepaliveDaemon *daemon;
+    gint fd;
+    guint source_id;
+    gboolean cpu;
+    gboolean display;
 };
 
+static DBusConnection *system_bus_connect(void)
+{
+    DBusError error = DBUS_ERROR_INIT;
+    DBusConnection *system_bus = dbus_bus_get(DBUS_BUS_SYSTEM, &error);
+    if (!system_bus) {
+        failure("%s: %s", error.name, error.message);
+    }
+    dbus_gmain_set_up_connection(system_bus, 0);
+    dbus_error_free(&error);
+    return system_bus;
+}
+
+static const gchar *socket_path(struct KeepaliveOptions *options)
+{
+    if (!options->socket_path) {
+        options->socket_path = g_build_filename(g_get_user_runtime_dir(),
+                                                KEEPALIVE_DAEMON_SOCKET, NULL);
+    }
+    return options->socket_path;
+}
+
+static gint socket_connect(const gchar *path)
+{
+    struct sockaddr_un sa;
+    memset(&sa, 0, sizeof sa);
+    sa.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof sa.sun_path) {
+        failure("Socket path too long: %s", path);
+    }
+    strcpy(sa.sun_path, path);
+
+    gint fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        return -1;
+    }
+    if (connect(fd, (struct sockaddr *)&sa, sizeof sa) == -1) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static gint64 boottime_ms(void)
+{
+    struct timespec ts = { 0, 0 };
+    clock_gettime(CLOCK_BOOTTIME, &ts);
+    return ts.tv_sec * (gint64)1000 + ts.tv_nsec / 1000000;
+}
+
+static gboolean on_stats_flush_timeout(gpointer user_data)
+{
+    gboolean *timed_out = user_data;
+    *timed_out = TRUE;
+    return G_SOURCE_REMOVE;
+}
+
+static void print_stats(struct KeepaliveOptions *options, cpukeepalive_t *cpukeepalive,
+                        gint64 elapsed_ms, guint runs, guint skipped)
+{
+    keepalive_accounting_t acc;
+    cpukeepalive_stats_t stats;
+
+    if (!cpukeepalive) {
+        /* Display only mode is rejected at option parsing */
+        return;
+    }
+
+    /* Session stop is deferred; wait for it so that it gets accounted */
+    gboolean timed_out = FALSE;
+    guint timeout_id = g_timeout_add(STATS_FLUSH_TIMEOUT_MS,
+                                     on_stats_flush_timeout, &timed_out);
+    while (cpukeepalive_get_accounting(cpukeepalive, &acc) &&
+           acc.kac_running && !timed_out) {
+        g_main_context_iteration(NULL, TRUE);
+    }
+    if (!timed_out) {
+        g_source_remove(timeout_id);
+    }
+
+    if (!cpukeepalive_get_accounting(cpukeepalive, &acc) ||
+        !cpukeepalive_get_stats(cpukeepalive, &stats)) {
+        return;
+    }
+
+    if (options->json) {
+        fprintf(stderr, "{\"elapsed_ms\":%" G_GINT64_FORMAT
+                ",\"held_ms\":%" G_GINT64_FORMAT
+                ",\"longest_hold_ms\":%" G_GINT64_FORMAT
+                ",\"sessions\":%u,\"renewals\":%u,\"ipc_messages\":%u"
+                ",\"start_latency_ms\":%" G_GINT64_FORMAT
+                ",\"start_latency_max_ms\":%" G_GINT64_FORMAT
+                ",\"runs\":%u,\"skipped\":%u}\n",
+                elapsed_ms, (gint64)acc.kac_running_ms, (gint64)acc.kac_longest_run_ms,
+                acc.kac_runs, stats.cks_renewals, acc.kac_ipc_messages,
+                (gint64)stats.cks_start_latency_ms, (gint64)stats.cks_start_latency_max_ms,
+                runs, skipped);
+    } else {
+        fprintf(stderr,
+                "elapsed:          %" G_GINT64_FORMAT " ms\n"
+                "suspend blocked:  %" G_GINT64_FORMAT " ms (longest %" G_GINT64_FORMAT " ms)\n"
+                "sessions:         %u\n"
+                "renewals:         %u\n"
+                "ipc messages:     %u\n"
+                "start latency:    %" G_GINT64_FORMAT " ms (max %" G_GINT64_FORMAT " ms)\n"
+                "runs:             %u (%u skipped)\n",
+                elapsed_ms, (gint64)acc.kac_running_ms, (gint64)acc.kac_longest_run_ms,
+                acc.kac_runs, stats.cks_renewals, acc.kac_ipc_messages,
+                (gint64)stats.cks_start_latency_ms, (gint64)stats.cks_start_latency_max_ms,
+                runs, skipped);
+    }
+}
+
+/* ------------------------------------------------------------------------- *
+ * Daemon client side
+ * ------------------------------------------------------------------------- */
+
+static gint daemon_acquire(struct KeepaliveOptions *options)
+{
+    char request[2];
+    size_t len = 0;
+
+    if (options->cpu) {
+        request[len++] = KEEPALIVE_DAEMON_REQ_CPU;
+    }
+    if (options->display) {
+        request[len++] = KEEPALIVE_DAEMON_REQ_DISP;
+    }
+
+    gint fd = socket_connect(socket_path(options));
+    if (fd == -1) {
+        return -1;
+    }
+
+    /* Do not let stopped / wedged daemon block the client */
+    struct pollfd pfd = { .fd = fd, .events = POLLIN };
+    char ack = 0;
+    if (send(fd, request, len, MSG_NOSIGNAL) != (ssize_t)len ||
+        poll(&pfd, 1, KEEPALIVE_DAEMON_ACK_MS) != 1 ||
+        read(fd, &ack, 1) != 1 || ack != KEEPALIVE_DAEMON_ACK) {
+        /* Stale socket / broken daemon: fall back to local keepalive */
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
 
 static void watch_child(GPid pid, gint status, gpointer user_data)
 {
@@ -63,32 +303,221 @@ static void watch_child(GPid pid, gint status, gpointer user_data)
     g_main_loop_quit(keepalive->mainloop_handle);
 }
 
+static void keepalive_acquire(struct Keepalive *keepalive)
+{
+    struct KeepaliveOptions *options = keepalive->options;
+
+    if (keepalive->held || keepalive->expired) {
+        return;
+    }
+    keepalive->held = TRUE;
+
+    /* Use keepalive daemon if available, otherwise talk to mce directly.
+     * Statistics are available only from local keepalive object. */
+    if (!keepalive->system_bus && !options->stats) {
+        keepalive->daemon_fd = daemon_acquire(options);
+        if (keepalive->daemon_fd != -1) {
+            return;
+        }
+    }
+
+    if (!keepalive->system_bus) {
+        keepalive->system_bus = system_bus_connect();
+        if (options->cpu) {
+            keepalive->cpukeepalive = cpukeepalive_new();
+        }
+        if (options->display) {
+            keepalive->displaykeepalive = displaykeepalive_new();
+        }
+    }
+
+    if (keepalive->cpukeepalive) {
+        cpukeepalive_start(keepalive->cpukeepalive);
+    }
+
+    if (keepalive->displaykeepalive) {
+        displaykeepalive_start(keepalive->displaykeepalive);
+    }
+}
+
+static void keepalive_release(struct Keepalive *keepalive)
+{
+    keepalive->held = FALSE;
+
+    if (keepalive->daemon_fd != -1) {
+        close(keepalive->daemon_fd);
+        keepalive->daemon_fd = -1;
+    }
+
+    if (keepalive->cpukeepalive) {
+        cpukeepalive_stop(keepalive->cpukeepalive);
+    }
+
+    if (keepalive->displaykeepalive) {
+        displaykeepalive_stop(keepalive->displaykeepalive);
+    }
+}
+
 static gboolean on_timeout(gpointer user_data)
 {
     struct Keepalive *keepalive = user_data;
-    cpukeepalive_stop(keepalive->cpukeepalive);
+    keepalive->expired = TRUE;
+    keepalive_release(keepalive);
     keepalive->timeout_source_id = 0;
     return FALSE;
 }
 
-static struct Keepalive *keepalive_new(char **argv, struct KeepaliveOptions *options)
+/* ------------------------------------------------------------------------- *
+ * Idle detection
+ * ------------------------------------------------------------------------- */
+
+struct ProcessStat {
+    GPid pid;
+    GPid ppid;
+    guint64 ticks;
+};
+
+static gboolean process_stat_read(const char *pid, struct ProcessStat *stat)
 {
-    struct Keepalive *keepalive = g_new0(struct Keepalive, 1);
+    gboolean ack = FALSE;
+    char path[64];
+    char buff[512];
+    FILE *file;
 
-    keepalive->mainloop_handle = g_main_loop_new(0, 0);
+    snprintf(path, sizeof path, "/proc/%s/stat", pid);
+    if (!(file = fopen(path, "r"))) {
+        return FALSE;
+    }
 
-    DBusError error = DBUS_ERROR_INIT;
-    keepalive->system_bus = dbus_bus_get(DBUS_BUS_SYSTEM, &error);
-    if (!keepalive->system_bus) {
-        failure("%s: %s", error.name, error.message);
+    /* Command name can contain anything -> parse from the last ')' */
+    char *tail;
+    if (fgets(buff, sizeof buff, file) && (tail = strrchr(buff, ')'))) {
+        unsigned long long utime, stime;
+        long long cutime, cstime;
+        if (sscanf(tail + 1, " %*c %d %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu %lld %lld",
+                   &stat->ppid, &utime, &stime, &cutime, &cstime) == 5) {
+            stat->pid = atoi(pid);
+            stat->ticks = utime + stime + cutime + cstime;
+            ack = TRUE;
+        }
     }
-    dbus_gmain_set_up_connection(keepalive->system_bus, 0);
-    dbus_error_free(&error);
 
-    keepalive->cpukeepalive = cpukeepalive_new();
-    cpukeepalive_start(keepalive->cpukeepalive);
+    fclose(file);
+    return ack;
+}
 
+/* Get cpu time used by process and all its descendants [clock ticks]
+ *
+ * Includes time used by already reaped descendants of any process in
+ * the tree. */
+static guint64 process_tree_ticks(GPid root)
+{
+    struct ProcessStat *stats = NULL;
+    size_t count = 0;
+    size_t alloc = 0;
+    DIR *dir;
+    struct dirent *de;
+
+    if (!(dir = opendir("/proc"))) {
+        return 0;
+    }
+    while ((de = readdir(dir))) {
+        if (de->d_name[0] < '1' || de->d_name[0] > '9') {
+            continue;
+        }
+        if (count == alloc) {
+            alloc = alloc ? alloc * 2 : 256;
+            stats = g_realloc(stats, alloc * sizeof *stats);
+        }
+        if (process_stat_read(de->d_name, &stats[count])) {
+            count += 1;
+        }
+    }
+    closedir(dir);
+
+    /* Collect the tree: move members to the front of the array */
+    size_t members = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (stats[i].pid == root) {
+            struct ProcessStat tmp = stats[members];
+            stats[members++] = stats[i];
+            stats[i] = tmp;
+            break;
+        }
+    }
+    for (size_t scanned = 0; scanned < members; ++scanned) {
+        for (size_t i = members; i < count; ++i) {
+            if (stats[i].ppid == stats[scanned].pid) {
+                struct ProcessStat tmp = stats[members];
+                stats[members++] = stats[i];
+                stats[i] = tmp;
+            }
+        }
+    }
+
+    guint64 ticks = 0;
+    for (size_t i = 0; i < members; ++i) {
+        ticks += stats[i].ticks;
+    }
+    g_free(stats);
+
+    return ticks;
+}
+
+static gboolean on_idle_wakeup(gpointer user_data)
+{
+    struct Keepalive *keepalive = user_data;
+
+    /* Give the child a chance to do scheduled work */
+    keepalive->idle_wakeup_id = 0;
+    keepalive->idle_since_ms = g_get_monotonic_time() / 1000;
+    keepalive_acquire(keepalive);
+
+    return G_SOURCE_REMOVE;
+}
+
+static gboolean on_idle_sample(gpointer user_data)
+{
+    struct Keepalive *keepalive = user_data;
+    struct KeepaliveOptions *options = keepalive->options;
+    guint64 ticks = process_tree_ticks(keepalive->pid);
+    gint64 now = g_get_monotonic_time() / 1000;
+
+    /* Note: This is a normal timer and gets triggered only while
+     *       the device is awake for some reason or another. */
+    if (ticks != keepalive->idle_ticks) {
+        keepalive->idle_ticks = ticks;
+        keepalive->idle_since_ms = now;
+        if (!keepalive->held) {
+            if (keepalive->idle_wakeup_id) {
+                g_source_remove(keepalive->idle_wakeup_id);
+                keepalive->idle_wakeup_id = 0;
+            }
+            keepalive_acquire(keepalive);
+        }
+    } else if (keepalive->held &&
+               now - keepalive->idle_since_ms >= options->idle_release * (gint64)1000) {
+        keepalive_release(keepalive);
+        if (!keepalive->expired) {
+            keepalive->idle_wakeup_id =
+                keepalive_timeout_add_seconds(options->idle_wakeup, on_idle_wakeup, keepalive);
+        }
+    }
+
+    return G_SOURCE_CONTINUE;
+}
+
+static struct Keepalive *keepalive_new(char **argv, struct KeepaliveOptions *options)
+{
+    struct Keepalive *keepalive = g_new0(struct Keepalive, 1);
+
+    keepalive->mainloop_handle = g_main_loop_new(0, 0);
+
+    keepalive->started_ms = boottime_ms();
     keepalive->options = options;
+    keepalive->daemon_fd = -1;
+
+    keepalive_acquire(keepalive);
 
     GError *err = NULL;
     if (!g_spawn_async(NULL, argv, NULL, G_SPAWN_DO_NOT_REAP_CHILD |
@@ -105,13 +534,23 @@ static struct Keepalive *keepalive_new(char **argv, struct KeepaliveOptions *opt
 
     g_child_watch_add(keepalive->pid, watch_child, keepalive);
 
+    if (options->idle_release) {
+        keepalive->idle_ticks = process_tree_ticks(keepalive->pid);
+        keepalive->idle_since_ms = g_get_monotonic_time() / 1000;
+        keepalive->idle_sample_id = g_timeout_add(IDLE_SAMPLE_MS, on_idle_sample, keepalive);
+    }
+
     return keepalive;
 }
 
 static struct Keepalive *keepalive_run(struct Keepalive *keepalive)
 {
     g_main_loop_run(keepalive->mainloop_handle);
-    cpukeepalive_stop(keepalive->cpukeepalive);
+    keepalive_release(keepalive);
+    if (keepalive->options->stats) {
+        print_stats(keepalive->options, keepalive->cpukeepalive,
+                    boottime_ms() - keepalive->started_ms, 1, 0);
+    }
     return keepalive;
 }
 
@@ -121,10 +560,26 @@ static int keepalive_free(struct Keepalive *keepalive)
         g_source_remove(keepalive->timeout_source_id);
     }
 
+    if (keepalive->idle_sample_id) {
+        g_source_remove(keepalive->idle_sample_id);
+    }
+
+    if (keepalive->idle_wakeup_id) {
+        g_source_remove(keepalive->idle_wakeup_id);
+    }
+
+    if (keepalive->daemon_fd != -1) {
+        close(keepalive->daemon_fd);
+    }
+
     if (keepalive->cpukeepalive) {
         cpukeepalive_unref(keepalive->cpukeepalive);
     }
 
+    if (keepalive->displaykeepalive) {
+        displaykeepalive_unref(keepalive->displaykeepalive);
+    }
+
     if (keepalive->system_bus) {
         dbus_connection_unref(keepalive->system_bus);
     }
@@ -138,21 +593,437 @@ static int keepalive_free(struct Keepalive *keepalive)
     return result;
 }
 
+/* ------------------------------------------------------------------------- *
+ * Daemon side
+ * ------------------------------------------------------------------------- */
+
+static void daemon_rethink(struct KeepaliveDaemon *daemon)
+{
+    gboolean want_cpu = FALSE;
+    gboolean want_display = FALSE;
+
+    for (GSList *item = daemon->clients; item; item = item->next) {
+        struct KeepaliveDaemonClient *client = item->data;
+        if (client->cpu) {
+            want_cpu = TRUE;
+        }
+        if (client->display) {
+            want_display = TRUE;
+        }
+    }
+
+    /* D-Bus is touched only on first client in / last client out */
+    if (daemon->cpukeepalive_held != want_cpu) {
+        daemon->cpukeepalive_held = want_cpu;
+        if (want_cpu) {
+            cpukeepalive_start(daemon->cpukeepalive);
+        } else {
+            cpukeepalive_stop(daemon->cpukeepalive);
+        }
+    }
+
+    if (daemon->displaykeepalive_held != want_display) {
+        daemon->displaykeepalive_held = want_display;
+        if (want_display) {
+            displaykeepalive_start(daemon->displaykeepalive);
+        } else {
+            displaykeepalive_stop(daemon->displaykeepalive);
+        }
+    }
+}
+
+static void daemon_client_free(struct KeepaliveDaemonClient *client)
+{
+    struct KeepaliveDaemon *daemon = client->daemon;
+
+    daemon->clients = g_slist_remove(daemon->clients, client);
+
+    if (client->source_id) {
+        g_source_remove(client->source_id);
+    }
+    close(client->fd);
+    g_free(client);
+}
+
+static gboolean on_client_io(gint fd, GIOCondition condition, gpointer user_data)
+{
+    struct KeepaliveDaemonClient *client = user_data;
+    struct KeepaliveDaemon *daemon = client->daemon;
+    char request[8];
+    ssize_t rc = -1;
+
+    if (condition & G_IO_IN) {
+        rc = read(fd, request, sizeof request);
+    }
+
+    if (rc <= 0) {
+        if (rc == -1 && (errno == EINTR || errno == EAGAIN)) {
+            return G_SOURCE_CONTINUE;
+        }
+        /* Client went away -> drop the keepalive it held */
+        client->source_id = 0;
+        daemon_client_free(client);
+        daemon_rethink(daemon);
+        return G_SOURCE_REMOVE;
+    }
+
+    for (ssize_t i = 0; i < rc; ++i) {
+        switch (request[i]) {
+        case KEEPALIVE_DAEMON_REQ_CPU:
+            client->cpu = TRUE;
+            break;
+        case KEEPALIVE_DAEMON_REQ_DISP:
+            client->display = TRUE;
+            break;
+        default:
+            break;
+        }
+    }
+    daemon_rethink(daemon);
+
+    char ack = KEEPALIVE_DAEMON_ACK;
+    if (send(fd, &ack, 1, MSG_NOSIGNAL) != 1) {
+        /* Dealt with when the connection is closed */
+    }
+
+    return G_SOURCE_CONTINUE;
+}
+
+static gboolean on_client_connect(gint fd, GIOCondition condition, gpointer user_data)
+{
+    struct KeepaliveDaemon *daemon = user_data;
+
+    (void)condition;
+
+    gint client_fd = accept4(fd, NULL, NULL, SOCK_CLOEXEC);
+    if (client_fd == -1) {
+        if (errno != EINTR && errno != EAGAIN) {
+            fprintf(stderr, "accept: %s\n", strerror(errno));
+        }
+        return G_SOURCE_CONTINUE;
+    }
+
+    struct KeepaliveDaemonClient *client = g_new0(struct KeepaliveDaemonClient, 1);
+    client->daemon = daemon;
+    client->fd = client_fd;
+    client->source_id = g_unix_fd_add(client_fd, G_IO_IN | G_IO_HUP | G_IO_ERR,
+                                      on_client_io, client);
+    daemon->clients = g_slist_prepend(daemon->clients, client);
+
+    return G_SOURCE_CONTINUE;
+}
+
+static gboolean on_daemon_signal(gpointer user_data)
+{
+    struct KeepaliveDaemon *daemon = user_data;
+    g_main_loop_quit(daemon->mainloop_handle);
+    return G_SOURCE_CONTINUE;
+}
+
+static struct KeepaliveDaemon *daemon_new(struct KeepaliveOptions *options)
+{
+    struct KeepaliveDaemon *daemon = g_new0(struct KeepaliveDaemon, 1);
+    const gchar *path = socket_path(options);
+
+    daemon->options = options;
+    daemon->mainloop_handle = g_main_loop_new(0, 0);
+
+    /* Refuse to take over socket from a running daemon */
+    gint fd = socket_connect(path);
+    if (fd != -1) {
+        close(fd);
+        failure("Daemon already running at %s", path);
+    }
+    unlink(path);
+
+    struct sockaddr_un sa;
+    memset(&sa, 0, sizeof sa);
+    sa.sun_family = AF_UNIX;
+    strcpy(sa.sun_path, path);
+
+    daemon->listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (daemon->listen_fd == -1) {
+        failure("socket: %s", strerror(errno));
+    }
+    if (bind(daemon->listen_fd, (struct sockaddr *)&sa, sizeof sa) == -1 ||
+        listen(daemon->listen_fd, 16) == -1) {
+        failure("%s: %s", path, strerror(errno));
+    }
+
+    daemon->system_bus = system_bus_connect();
+    daemon->cpukeepalive = cpukeepalive_new();
+    daemon->displaykeepalive = displaykeepalive_new();
+
+    daemon->listen_source_id = g_unix_fd_add(daemon->listen_fd, G_IO_IN,
+                                             on_client_connect, daemon);
+    daemon->sigint_source_id = g_unix_signal_add(SIGINT, on_daemon_signal, daemon);
+    daemon->sigterm_source_id = g_unix_signal_add(SIGTERM, on_daemon_signal, daemon);
+
+    return daemon;
+}
+
+static struct KeepaliveDaemon *daemon_run(struct KeepaliveDaemon *daemon)
+{
+    g_main_loop_run(daemon->mainloop_handle);
+    return daemon;
+}
+
+static int daemon_free(struct KeepaliveDaemon *daemon)
+{
+    while (daemon->clients) {
+        daemon_client_free(daemon->clients->data);
+    }
+    daemon_rethink(daemon);
+
+    g_source_remove(daemon->sigterm_source_id);
+    g_source_remove(daemon->sigint_source_id);
+    g_source_remove(daemon->listen_source_id);
+
+    close(daemon->listen_fd);
+    unlink(daemon->options->socket_path);
+
+    cpukeepalive_unref(daemon->cpukeepalive);
+    displaykeepalive_unref(daemon->displaykeepalive);
+    dbus_connection_unref(daemon->system_bus);
+    g_main_loop_unref(daemon->mainloop_handle);
+    g_free(daemon);
+
+    return EXIT_SUCCESS;
+}
+
+
+/* ------------------------------------------------------------------------- *
+ * Periodic runner
+ * ------------------------------------------------------------------------- */
+
+static void periodic_release(struct KeepalivePeriodic *periodic)
+{
+    if (periodic->timeout_source_id) {
+        g_source_remove(periodic->timeout_source_id);
+        periodic->timeout_source_id = 0;
+    }
+    if (periodic->cpukeepalive) {
+        cpukeepalive_stop(periodic->cpukeepalive);
+    }
+    if (periodic->displaykeepalive) {
+        displaykeepalive_stop(periodic->displaykeepalive);
+    }
+}
+
+static void on_periodic_child_exit(GPid pid, gint status, gpointer user_data)
+{
+    struct KeepalivePeriodic *periodic = user_data;
+    GError *err = NULL;
+
+    if (!g_spawn_check_exit_status(status, &err)) {
+        fprintf(stderr, "%s: %s\n", periodic->argv[0], err->message);
+    }
+    g_clear_error(&err);
+
+    g_spawn_close_pid(pid);
+    periodic->pid = 0;
+    periodic->child_watch_id = 0;
+    periodic_release(periodic);
+}
+
+static gboolean on_periodic_timeout(gpointer user_data)
+{
+    struct KeepalivePeriodic *periodic = user_data;
+    periodic->timeout_source_id = 0;
+    periodic_release(periodic);
+    return FALSE;
+}
+
+static void on_periodic_wakeup(background_activity_t *activity, void *user_data)
+{
+    struct KeepalivePeriodic *periodic = user_data;
+
+    if (periodic->pid) {
+        /* Overlapping runs are skipped, the previous one holds
+         * the cpu keepalive until it is finished */
+        fprintf(stderr, "%s: previous run still active, skipping\n",
+                periodic->argv[0]);
+        periodic->skipped += 1;
+    } else {
+        GError *err = NULL;
+        if (periodic->cpukeepalive) {
+            cpukeepalive_start(periodic->cpukeepalive);
+        }
+        if (periodic->displaykeepalive) {
+            displaykeepalive_start(periodic->displaykeepalive);
+        }
+        if (!g_spawn_async(NULL, periodic->argv, NULL, G_SPAWN_DO_NOT_REAP_CHILD |
+                                                       G_SPAWN_SEARCH_PATH |
+                                                       G_SPAWN_CHILD_INHERITS_STDIN,
+                           NULL, NULL, &periodic->pid, &err)) {
+            fprintf(stderr, "Could not exec child: %s\n", err->message);
+            periodic->pid = 0;
+            periodic_release(periodic);
+        } else {
+            periodic->runs += 1;
+            periodic->child_watch_id = g_child_watch_add(periodic->pid,
+                                                         on_periodic_child_exit,
+                                                         periodic);
+            if (periodic->options->timeout) {
+                periodic->timeout_source_id = g_timeout_add(periodic->options->timeout * 1000,
+                                                            on_periodic_timeout, periodic);
+            }
+        }
+        g_clear_error(&err);
+    }
+
+    /* Schedule the next wakeup right away so that the schedule stays
+     * aligned regardless of how long the command takes to finish */
+    background_activity_wait(activity);
+}
+
+static gboolean on_periodic_signal(gpointer user_data)
+{
+    struct KeepalivePeriodic *periodic = user_data;
+    g_main_loop_quit(periodic->mainloop_handle);
+    return G_SOURCE_CONTINUE;
+}
+
+static struct KeepalivePeriodic *periodic_new(char **argv, struct KeepaliveOptions *options)
+{
+    struct KeepalivePeriodic *periodic = g_new0(struct KeepalivePeriodic, 1);
+
+    periodic->options = options;
+    periodic->argv = argv;
+    periodic->started_ms = boottime_ms();
+    periodic->mainloop_handle = g_main_loop_new(0, 0);
+    periodic->system_bus = system_bus_connect();
+    if (options->cpu) {
+        periodic->cpukeepalive = cpukeepalive_new();
+    }
+    if (options->display) {
+        periodic->displaykeepalive = displaykeepalive_new();
+    }
+
+    periodic->activity = background_activity_new();
+    background_activity_set_running_callback(periodic->activity, on_periodic_wakeup);
+    background_activity_set_user_data(periodic->activity, periodic, 0);
+    if (options->every) {
+        background_activity_set_wakeup_slot(periodic->activity, options->every);
+    } else {
+        background_activity_set_wakeup_range(periodic->activity,
+                                             options->range_lo, options->range_hi);
+    }
+    background_activity_wait(periodic->activity);
+
+    periodic->sigint_source_id = g_unix_signal_add(SIGINT, on_periodic_signal, periodic);
+    periodic->sigterm_source_id = g_unix_signal_add(SIGTERM, on_periodic_signal, periodic);
+
+    return periodic;
+}
+
+static struct KeepalivePeriodic *periodic_run(struct KeepalivePeriodic *periodic)
+{
+    g_main_loop_run(periodic->mainloop_handle);
+    background_activity_stop(periodic->activity);
+    periodic_release(periodic);
+    if (periodic->options->stats) {
+        print_stats(periodic->options, periodic->cpukeepalive,
+                    boottime_ms() - periodic->started_ms,
+                    periodic->runs, periodic->skipped);
+    }
+    return periodic;
+}
+
+static int periodic_free(struct KeepalivePeriodic *periodic)
+{
+    g_source_remove(periodic->sigterm_source_id);
+    g_source_remove(periodic->sigint_source_id);
+
+    if (periodic->child_watch_id) {
+        /* Child is left running, but no longer kept alive */
+        g_source_remove(periodic->child_watch_id);
+        g_spawn_close_pid(periodic->pid);
+    }
+
+    background_activity_set_user_data(periodic->activity, 0, 0);
+    background_activity_unref(periodic->activity);
+    if (periodic->cpukeepalive) {
+        cpukeepalive_unref(periodic->cpukeepalive);
+    }
+    if (periodic->displaykeepalive) {
+        displaykeepalive_unref(periodic->displaykeepalive);
+    }
+    dbus_connection_unref(periodic->system_bus);
+    g_main_loop_unref(periodic->mainloop_handle);
+    g_free(periodic);
+
+    return EXIT_SUCCESS;
+}
+
+static void parse_range(struct KeepaliveOptions *options)
+{
+    char *end = NULL;
+
+    options->range_lo = strtol(options->range, &end, 10);
+    options->range_hi = -1;
+    if (*end == ':') {
+        options->range_hi = strtol(end + 1, &end, 10);
+    }
+    if (*end || options->range_lo <= 0 ||
+        (options->range_hi != -1 && options->range_hi < options->range_lo)) {
+        failure("Invalid range: %s", options->range);
+    }
+}
 
 int main(int argc, char **argv)
 {
     struct KeepaliveOptions options = {
         0, // timeout
+        FALSE, // cpu
+        FALSE, // display
+        FALSE, // daemon
+        NULL, // socket_path
+        0, // every
+        NULL, // range
+        0, // range_lo
+        0, // range_hi
+        FALSE, // stats
+        FALSE, // json
+        0, // idle_release
+        IDLE_WAKEUP_DEFAULT, // idle_wakeup
     };
 
     GOptionEntry entries[] = {
         { "timeout", 't', 0, G_OPTION_ARG_INT, &options.timeout,
-            "Maximum time to keep the CPU alive", "SECONDS", },
+            "Maximum time to hold the keepalive", "SECONDS", },
+        { "cpu", 'c', 0, G_OPTION_ARG_NONE, &options.cpu,
+            "Prevent suspend (default unless --display is used)", NULL, },
+        { "display", 'D', 0, G_OPTION_ARG_NONE, &options.display,
+            "Keep the display on, combine with --cpu to prevent suspend too", NULL, },
+        { "daemon", 'd', 0, G_OPTION_ARG_NONE, &options.daemon,
+            "Serve keepalive requests from other keepalive-tool instances", NULL, },
+        { "socket", 's', 0, G_OPTION_ARG_STRING, &options.socket_path,
+            "Daemon socket path (default: $XDG_RUNTIME_DIR/"KEEPALIVE_DAEMON_SOCKET")", "PATH", },
+        { "every", 'e', 0, G_OPTION_ARG_INT, &options.every,
+            "Run command periodically at aligned global wakeup slot", "SECONDS", },
+        { "range", 'r', 0, G_OPTION_ARG_STRING, &options.range,
+            "Run command periodically with wakeup range", "MIN[:MAX]", },
+        { "stats", 'S', 0, G_OPTION_ARG_NONE, &options.stats,
+            "Print cpu keepalive statistics to stderr at exit", NULL, },
+        { "json", 'j', 0, G_OPTION_ARG_NONE, &options.json,
+            "Print statistics as a JSON object (implies --stats)", NULL, },
+        { "idle-release", 'i', 0, G_OPTION_ARG_INT, &options.idle_release,
+            "Release the keepalive while the command has been idle this long", "SECONDS", },
+        { "idle-wakeup", 'w', 0, G_OPTION_ARG_INT, &options.idle_wakeup,
+            "Wake up to re-acquire the keepalive after idle release (default: 300)", "SECONDS", },
         { 0, 0, 0, 0, 0, 0, 0 },
     };
 
     GOptionContext *ctx = g_option_context_new("COMMAND [ARGUMENTS...]");
-    g_option_context_set_summary(ctx, "Enable CPU-keepalive during runtime of child process");
+    g_option_context_set_summary(ctx, "Enable CPU and/or display keepalive during runtime of child process\n"
+                                      "\n"
+                                      "If a keepalive-tool daemon is running, the keepalive is requested\n"
+                                      "from it instead of connecting to the system bus.\n"
+                                      "\n"
+                                      "With --every or --range the command is run repeatedly from device\n"
+                                      "wakeups that are shared with other processes. A run is skipped if\n"
+                                      "the previous one has not finished yet.");
     g_option_context_set_description(ctx, "https://github.com/nemomobile/nemo-keepalive");
     g_option_context_add_main_entries(ctx, entries, NULL);
     GError *error = 0;
@@ -163,11 +1034,50 @@ int main(int argc, char **argv)
         argv++;
         argc--;
     }
+    if (options.daemon) {
+        if (argc > 1) {
+            fprintf(stderr, "Error: No command allowed in daemon mode.\n");
+            exit(1);
+        }
+        g_option_context_free(ctx);
+        return daemon_free(daemon_run(daemon_new(&options)));
+    }
     if (argc == 1) {
         fprintf(stderr, "Error: No command specified. Use -h/--help for help.\n");
         exit(1);
     }
     g_option_context_free(ctx);
 
+    if (options.json) {
+        options.stats = TRUE;
+    }
+    if (!options.display) {
+        options.cpu = TRUE;
+    }
+    if (options.stats && !options.cpu) {
+        fprintf(stderr, "Error: --stats requires --cpu, statistics are about cpu keepalive.\n");
+        exit(1);
+    }
+    if (options.every < 0) {
+        failure("Invalid slot: %d", options.every);
+    }
+    if (options.every && options.range) {
+        fprintf(stderr, "Error: --every and --range are mutually exclusive.\n");
+        exit(1);
+    }
+    if (options.range) {
+        parse_range(&options);
+    }
+    if (options.idle_release < 0 || options.idle_wakeup <= 0) {
+        failure("Invalid idle release parameters");
+    }
+    if (options.idle_release && (options.every || options.range)) {
+        fprintf(stderr, "Error: --idle-release can't be used with --every or --range.\n");
+        exit(1);
+    }
+    if (options.every || options.range) {
+        return periodic_free(periodic_run(periodic_new(argv+1, &options)));
+    }
+
     return keepalive_free(keepalive_run(keepalive_new(argv+1, &options)));
 }